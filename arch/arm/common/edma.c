@@ -20,6 +20,8 @@
 #include <linux/slab.h>
 #include <linux/io.h>
 
+#include <asm/sizes.h>
+
 #include <asm/hardware/edma.h>
 
 /* Offsets matching "struct edmacc_param" */
@@ -1155,6 +1157,276 @@ EXPORT_SYMBOL(edma_read_slot);
 
 /*-----------------------------------------------------------------------*/
 
+/* Parameter RAM operations (iii) -- chains of parameter sets */
+
+/* largest array edma_chain_add_memcpy() uses; BIDX is a signed 16 bits */
+#define EDMA_MEMCPY_ACNT	SZ_16K
+
+/* opt bits owned by the chain rather than by callers' parameter sets */
+#define EDMA_CHAIN_OPT_MASK	(EDMA_TCC(0x3f) | TCINTEN | ITCINTEN | \
+				 TCCHEN | ITCCHEN)
+
+/**
+ * edma_chain_alloc - allocate a chain of parameter RAM sets
+ * @channel: channel from edma_alloc_channel() the chain runs on
+ * @max: most parameter sets the chain will hold (at least one)
+ * @flags: EDMA_CHAIN_CYCLIC to loop back to the first set
+ *
+ * The channel's own slot holds the first set; a contiguous block of
+ * slots is reserved for the rest, so that edma_chain_commit() can write
+ * them with a single burst.  A cyclic chain also keeps the first set in
+ * that block, where the last set links back to it.
+ *
+ * Returns the chain, else NULL.
+ */
+struct edma_chain *edma_chain_alloc(unsigned channel, unsigned max,
+		unsigned flags)
+{
+	unsigned ctlr = EDMA_CTLR(channel);
+	struct edma_chain *chain;
+	unsigned nslots;
+
+	if (!max || EDMA_CHAN_SLOT(channel) >= edma_info[ctlr]->num_channels)
+		return NULL;
+
+	chain = kzalloc(sizeof(*chain), GFP_KERNEL);
+	if (!chain)
+		return NULL;
+	chain->params = kcalloc(max, sizeof(*chain->params), GFP_KERNEL);
+	if (!chain->params)
+		goto err_params;
+
+	chain->channel = channel;
+	chain->flags = flags;
+	chain->max = max;
+	chain->trigger = -1;
+	chain->slot = -1;
+
+	nslots = (flags & EDMA_CHAIN_CYCLIC) ? max : max - 1;
+	if (nslots) {
+		chain->slot = edma_alloc_cont_slots(ctlr, EDMA_CONT_PARAMS_ANY,
+				0, nslots);
+		if (chain->slot < 0)
+			goto err_slots;
+	}
+
+	return chain;
+
+err_slots:
+	kfree(chain->params);
+err_params:
+	kfree(chain);
+	return NULL;
+}
+EXPORT_SYMBOL(edma_chain_alloc);
+
+/**
+ * edma_chain_free - release a chain and its parameter RAM slots
+ * @chain: chain from edma_chain_alloc()
+ *
+ * Callers are responsible for ensuring the channel is stopped first.
+ */
+void edma_chain_free(struct edma_chain *chain)
+{
+	unsigned nslots;
+
+	if (!chain)
+		return;
+
+	nslots = (chain->flags & EDMA_CHAIN_CYCLIC) ? chain->max
+						     : chain->max - 1;
+	if (chain->slot >= 0)
+		edma_free_cont_slots(chain->slot, nslots);
+	kfree(chain->params);
+	kfree(chain);
+}
+EXPORT_SYMBOL(edma_chain_free);
+
+/**
+ * edma_chain_reset - drop all parameter sets from a chain
+ * @chain: chain being rebuilt
+ *
+ * Parameter RAM is left alone until the next edma_chain_commit().
+ */
+void edma_chain_reset(struct edma_chain *chain)
+{
+	chain->count = 0;
+	chain->trigger = -1;
+}
+EXPORT_SYMBOL(edma_chain_reset);
+
+/**
+ * edma_chain_add - append a parameter set to a chain
+ * @chain: chain being built
+ * @param: the transfer; its link and completion fields are ignored
+ * @flags: EDMA_CHAIN_INTR, EDMA_CHAIN_INTR_ITC and/or EDMA_CHAIN_NEXT
+ *
+ * The set completes with the chain's own channel as its transfer
+ * completion code, so its interrupts reach that channel's callback.
+ * EDMA_CHAIN_NEXT chains the set back to that channel, so the set it
+ * links to starts as soon as it completes instead of on the next event;
+ * this is how a memory to memory copy runs through the whole chain
+ * from a single edma_start().
+ *
+ * Returns the index of the set in the chain, else negative errno.
+ */
+int edma_chain_add(struct edma_chain *chain,
+		const struct edmacc_param *param, unsigned flags)
+{
+	struct edmacc_param *p;
+	unsigned int opt;
+
+	if (chain->count >= chain->max)
+		return -ENOSPC;
+
+	p = &chain->params[chain->count];
+	*p = *param;
+
+	opt = param->opt & ~EDMA_CHAIN_OPT_MASK;
+	opt |= EDMA_TCC(EDMA_CHAN_SLOT(chain->channel));
+	if (flags & EDMA_CHAIN_INTR)
+		opt |= TCINTEN;
+	if (flags & EDMA_CHAIN_INTR_ITC)
+		opt |= ITCINTEN;
+	if (flags & EDMA_CHAIN_NEXT)
+		opt |= TCCHEN;
+	p->opt = opt;
+
+	return chain->count++;
+}
+EXPORT_SYMBOL(edma_chain_add);
+
+/**
+ * edma_chain_add_memcpy - append a memory to memory copy to a chain
+ * @chain: chain being built
+ * @dst: physical address to copy to
+ * @src: physical address to copy from
+ * @len: number of bytes to copy
+ * @flags: as for edma_chain_add(), applied to the copy as a whole
+ *
+ * The copy is done as AB-synchronized frames of EDMA_MEMCPY_ACNT byte
+ * arrays, so any length up to 1 GiB needs at most two parameter sets,
+ * the second one for a remainder.  The sets are chained to each other,
+ * so a single trigger runs the whole copy.
+ *
+ * Returns the index of the last set added, else negative errno.
+ */
+int edma_chain_add_memcpy(struct edma_chain *chain, dma_addr_t dst,
+		dma_addr_t src, size_t len, unsigned flags)
+{
+	struct edmacc_param param;
+	size_t frames = len / EDMA_MEMCPY_ACNT;
+	size_t rem = len % EDMA_MEMCPY_ACNT;
+	unsigned need = !!frames + !!rem;
+	int ret = -EINVAL;
+
+	if (!len || frames > 0xffff)
+		return -EINVAL;
+	if (chain->count + need > chain->max)
+		return -ENOSPC;
+
+	memset(&param, 0, sizeof(param));
+	param.opt = SYNCDIM;
+	param.ccnt = 1;
+
+	if (frames) {
+		param.src = src;
+		param.dst = dst;
+		param.a_b_cnt = (frames << 16) | EDMA_MEMCPY_ACNT;
+		param.src_dst_bidx = (EDMA_MEMCPY_ACNT << 16) |
+				EDMA_MEMCPY_ACNT;
+		ret = edma_chain_add(chain, &param,
+				rem ? EDMA_CHAIN_NEXT : flags);
+		src += frames * EDMA_MEMCPY_ACNT;
+		dst += frames * EDMA_MEMCPY_ACNT;
+	}
+
+	if (rem) {
+		param.src = src;
+		param.dst = dst;
+		param.a_b_cnt = (1 << 16) | rem;
+		param.src_dst_bidx = 0;
+		ret = edma_chain_add(chain, &param, flags);
+	}
+
+	return ret;
+}
+EXPORT_SYMBOL(edma_chain_add_memcpy);
+
+/**
+ * edma_chain_trigger - start another channel when a chain completes
+ * @chain: non-cyclic chain being built
+ * @channel: channel to chain to, or negative to stop chaining
+ *
+ * The last set of the chain takes @channel as its transfer completion
+ * code, so any completion interrupt it raises is reported on @channel
+ * rather than on the chain's own channel.
+ */
+void edma_chain_trigger(struct edma_chain *chain, int channel)
+{
+	if (channel >= 0 && EDMA_CTLR(channel) != EDMA_CTLR(chain->channel))
+		return;
+	chain->trigger = channel;
+}
+EXPORT_SYMBOL(edma_chain_trigger);
+
+/**
+ * edma_chain_commit - write a chain into parameter RAM
+ * @chain: chain being started
+ *
+ * Links the sets to one another, then writes the linked slots with one
+ * burst and the channel's slot with another.  The channel should not be
+ * active when this is called; start it with edma_start() afterwards.
+ *
+ * Returns zero on success, else negative errno.
+ */
+int edma_chain_commit(struct edma_chain *chain)
+{
+	unsigned ctlr = EDMA_CTLR(chain->channel);
+	bool cyclic = chain->flags & EDMA_CHAIN_CYCLIC;
+	unsigned n = chain->count;
+	unsigned first = cyclic ? 0 : 1;
+	unsigned base = EDMA_CHAN_SLOT(chain->slot);
+	unsigned i, next;
+
+	if (!n)
+		return -EINVAL;
+
+	/* entry i lives in linked slot (base + i - first) */
+	for (i = 0; i < n; i++) {
+		struct edmacc_param *p = &chain->params[i];
+
+		p->link_bcntrld &= 0xffff0000;
+		next = i + 1;
+		if (next == n && cyclic)
+			next = 0;
+		if (next < n)
+			p->link_bcntrld |= PARM_OFFSET(base + next - first)
+					& 0xffff;
+		else
+			p->link_bcntrld |= 0xffff;
+	}
+
+	if (!cyclic && chain->trigger >= 0) {
+		struct edmacc_param *p = &chain->params[n - 1];
+
+		p->opt &= ~(EDMA_TCC(0x3f) | ITCCHEN);
+		p->opt |= EDMA_TCC(EDMA_CHAN_SLOT(chain->trigger)) | TCCHEN;
+	}
+
+	if (n > first)
+		memcpy_toio(edmacc_regs_base[ctlr] + PARM_OFFSET(base),
+				&chain->params[first], (n - first) * PARM_SIZE);
+	memcpy_toio(edmacc_regs_base[ctlr] +
+			PARM_OFFSET(EDMA_CHAN_SLOT(chain->channel)),
+			&chain->params[0], PARM_SIZE);
+
+	return 0;
+}
+EXPORT_SYMBOL(edma_chain_commit);
+
+/*-----------------------------------------------------------------------*/
+
 /* Various EDMA channel control operations */
 
 /**
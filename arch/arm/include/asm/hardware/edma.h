@@ -200,6 +200,42 @@ void edma_unlink(unsigned from);
 void edma_write_slot(unsigned slot, const struct edmacc_param *params);
 void edma_read_slot(unsigned slot, struct edmacc_param *params);
 
+/*
+ * A chain of parameter RAM sets for one channel, built in memory and
+ * written to PaRAM with burst writes by edma_chain_commit().  Entry 0
+ * goes into the channel's own slot, the others into contiguous slots
+ * linked from it.  A cyclic chain links its last entry back to the
+ * first, as McASP ping-pong buffering does.
+ */
+struct edma_chain {
+	unsigned		channel;
+	int			slot;		/* first linked slot, or -1 */
+	unsigned		flags;
+	unsigned		count;
+	unsigned		max;
+	int			trigger;	/* channel chained to, or -1 */
+	struct edmacc_param	*params;
+};
+
+/* edma_chain_alloc() flags */
+#define EDMA_CHAIN_CYCLIC	BIT(0)
+
+/* edma_chain_add() flags */
+#define EDMA_CHAIN_INTR		BIT(0)	/* interrupt when the set completes */
+#define EDMA_CHAIN_INTR_ITC	BIT(1)	/* ... and after each intermediate TR */
+#define EDMA_CHAIN_NEXT		BIT(2)	/* start the next set without an event */
+
+struct edma_chain *edma_chain_alloc(unsigned channel, unsigned max,
+		unsigned flags);
+void edma_chain_free(struct edma_chain *chain);
+void edma_chain_reset(struct edma_chain *chain);
+int edma_chain_add(struct edma_chain *chain,
+		const struct edmacc_param *param, unsigned flags);
+int edma_chain_add_memcpy(struct edma_chain *chain, dma_addr_t dst,
+		dma_addr_t src, size_t len, unsigned flags);
+void edma_chain_trigger(struct edma_chain *chain, int channel);
+int edma_chain_commit(struct edma_chain *chain);
+
 /* channel control operations */
 int edma_start(unsigned channel);
 void edma_stop(unsigned channel);
@@ -230,4 +266,10 @@ struct edma_soc_info {
 				struct event_to_channel_map *xbar_event_map);
 };
 
+/* platform_data for the EDMA memcpy offload driver */
+struct edma_memcpy_platform_data {
+	unsigned		nr_channels;
+	enum dma_event_q	queue;	/* ideally one whose TC is otherwise idle */
+};
+
 #endif
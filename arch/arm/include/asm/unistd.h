@@ -397,6 +397,7 @@
 #define __NR_fanotify_mark		(__NR_SYSCALL_BASE+368)
 #define __NR_prlimit64			(__NR_SYSCALL_BASE+369)
 #define __NR_clock_adjtime		(__NR_SYSCALL_BASE+370)
+#define __NR_sendmmsg			(__NR_SYSCALL_BASE+371)
 
 
 /*
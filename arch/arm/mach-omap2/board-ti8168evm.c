@@ -175,7 +175,9 @@ static struct snd_platform_data ti8168_evm_snd_data[] = {
 	.asp_chan_q	= EVENTQ_0,
 	.version	= MCASP_VERSION_2,
 	.txnumevt	= 1,
-	.rxnumevt	= 1
+	.rxnumevt	= 1,
+	.sram_size_playback = 8192,
+	.sram_size_capture = 8192,
   },
   {
     .tx_dma_offset	= 0x46400000,
@@ -187,7 +189,9 @@ static struct snd_platform_data ti8168_evm_snd_data[] = {
     .asp_chan_q	= EVENTQ_1,
     .version	= MCASP_VERSION_2,
     .txnumevt	= 1,
-    .rxnumevt	= 1
+    .rxnumevt	= 1,
+    .sram_size_playback = 8192,
+    .sram_size_capture = 8192,
   },
   {
     .tx_dma_offset	= 0x46800000,
@@ -199,7 +203,9 @@ static struct snd_platform_data ti8168_evm_snd_data[] = {
     .asp_chan_q	= EVENTQ_2,
     .version	= MCASP_VERSION_2,
     .txnumevt	= 1,
-    .rxnumevt	= 1
+    .rxnumevt	= 1,
+    .sram_size_playback = 8192,
+    .sram_size_capture = 8192,
   }
 };
 
@@ -514,6 +514,24 @@ static struct clk tptc3_ick = {
 	.recalc		= &followparent_recalc,
 };
 
+static struct clk ocmc_ram0_ick = {
+	.name		= "ocmc_ram0_ick",
+	.parent		= &sysclk4_ck,
+	.ops		= &clkops_ti81xx_dflt_wait,
+	.enable_reg	= TI81XX_CM_ALWON_OCMC_0_CLKCTRL,
+	.enable_bit	= TI81XX_MODULEMODE_SWCTRL,
+	.recalc		= &followparent_recalc,
+};
+
+static struct clk ocmc_ram1_ick = {
+	.name		= "ocmc_ram1_ick",
+	.parent		= &sysclk4_ck,
+	.ops		= &clkops_ti81xx_dflt_wait,
+	.enable_reg	= TI816X_CM_ALWON_OCMC_1_CLKCTRL,
+	.enable_bit	= TI81XX_MODULEMODE_SWCTRL,
+	.recalc		= &followparent_recalc,
+};
+
 static const struct clksel_rate div_4_1_rates[] = {
 	{ .div = 4, .val = 1, .flags = RATE_IN_TI816X },
 	{ .div = 0 },
@@ -1656,6 +1674,8 @@ static struct omap_clk ti816x_clks[] = {
 	CLK(NULL,		"tptc1_ick",		&tptc1_ick,		CK_TI816X),
 	CLK(NULL,		"tptc2_ick",		&tptc2_ick,		CK_TI816X),
 	CLK(NULL,		"tptc3_ick",		&tptc3_ick,		CK_TI816X),
+	CLK(NULL,		"ocmc_ram0_ick",	&ocmc_ram0_ick,		CK_TI816X),
+	CLK(NULL,		"ocmc_ram1_ick",	&ocmc_ram1_ick,		CK_TI816X),
 	CLK(NULL,		"sysclk6_ck",		&sysclk6_ck,		CK_TI816X),
 	CLK(NULL,		"mmu_cfg_ick",		&mmu_cfg_ick,		CK_TI816X),
 	CLK(NULL,		"mailbox_ick",		&mailbox_ick,		CK_TI816X),
@@ -1807,10 +1807,27 @@ static struct platform_device ti814x_edma_device = {
 	.resource	= ti81xx_edma_resources,
 };
 
+#if defined(CONFIG_EDMA_MEMCPY) || defined(CONFIG_EDMA_MEMCPY_MODULE)
+/* event queue 3 feeds TC3, which no peripheral driver uses */
+static struct edma_memcpy_platform_data ti81xx_edma_memcpy_data = {
+	.nr_channels	= 2,
+	.queue		= EVENTQ_3,
+};
+
+static struct platform_device ti81xx_edma_memcpy_device = {
+	.name		= "edma-memcpy",
+	.id		= -1,
+	.dev = {
+		.platform_data = &ti81xx_edma_memcpy_data,
+	},
+};
+#endif
+
 int __init ti81xx_register_edma(void)
 {
 	struct platform_device *pdev;
 	static struct clk *edma_clk;
+	int ret;
 
 	if (cpu_is_ti816x())
 		pdev = &ti816x_edma_device;
@@ -1853,7 +1870,14 @@ int __init ti81xx_register_edma(void)
 	clk_enable(edma_clk);
 
 
-	return platform_device_register(pdev);
+	ret = platform_device_register(pdev);
+	if (ret)
+		return ret;
+
+#if defined(CONFIG_EDMA_MEMCPY) || defined(CONFIG_EDMA_MEMCPY_MODULE)
+	ret = platform_device_register(&ti81xx_edma_memcpy_device);
+#endif
+	return ret;
 }
 
 static void __init ti81xx_video_mux(void)
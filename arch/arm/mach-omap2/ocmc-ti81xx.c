@@ -0,0 +1,137 @@
+/*
+ * TI81XX OCMC RAM allocator
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation version 2.
+ *
+ * This program is distributed "as is" WITHOUT ANY WARRANTY of any
+ * kind, whether express or implied; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Hands out on-chip RAM for DMA buffers which must not see DDR contention,
+ * such as the audio ping/pong buffers.  Only a window at the top of the
+ * bank is managed (OCMC1 on TI816x, OCMC0 on TI814x), so that the rest
+ * stays free for the slave cores; its size is set with "ocmc_sram=",
+ * and "ocmc_sram=0" disables the allocator.
+ *
+ * Like the DaVinci sram_alloc(), this only supports CPU and DMA access,
+ * the CPU mapping is uncached.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/io.h>
+#include <linux/err.h>
+#include <linux/clk.h>
+#include <linux/genalloc.h>
+
+#include <plat/cpu.h>
+#include <plat/sram.h>
+
+#define OCMC_GRANULARITY	512
+
+static struct gen_pool *ocmc_pool;
+static void __iomem *ocmc_virt;
+static dma_addr_t ocmc_dma;
+static unsigned long ocmc_len = 0x10000;
+
+static int __init ocmc_sram_setup(char *str)
+{
+	ocmc_len = memparse(str, &str);
+	return 0;
+}
+early_param("ocmc_sram", ocmc_sram_setup);
+
+void *ti81xx_ocmc_alloc(size_t len, dma_addr_t *dma)
+{
+	unsigned long vaddr;
+
+	if (dma)
+		*dma = 0;
+	if (!ocmc_pool)
+		return NULL;
+
+	vaddr = gen_pool_alloc(ocmc_pool, len);
+	if (!vaddr)
+		return NULL;
+
+	if (dma)
+		*dma = ocmc_dma + (vaddr - (unsigned long)ocmc_virt);
+	return (void *)vaddr;
+}
+EXPORT_SYMBOL(ti81xx_ocmc_alloc);
+
+void ti81xx_ocmc_free(void *addr, size_t len)
+{
+	gen_pool_free(ocmc_pool, (unsigned long)addr, len);
+}
+EXPORT_SYMBOL(ti81xx_ocmc_free);
+
+static int __init ti81xx_ocmc_init(void)
+{
+	unsigned long base, size;
+	const char *clk_name;
+	struct clk *clk;
+	int status;
+
+	if (!cpu_is_ti81xx() || !ocmc_len)
+		return 0;
+
+	if (cpu_is_ti816x()) {
+		base = TI816X_OCMC1_PA;
+		size = TI816X_OCMC_SIZE;
+		clk_name = "ocmc_ram1_ick";
+	} else {
+		base = TI81XX_OCMC0_PA;
+		size = TI814X_OCMC_SIZE;
+		clk_name = "ocmc_ram_ick";
+	}
+	ocmc_len = min(PAGE_ALIGN(ocmc_len), size);
+
+	clk = clk_get(NULL, clk_name);
+	if (IS_ERR(clk)) {
+		pr_err("OCMC: no %s clock\n", clk_name);
+		return PTR_ERR(clk);
+	}
+	clk_enable(clk);
+
+	ocmc_dma = base + size - ocmc_len;
+	/* write-combined, memset() etc. may not be used on device memory */
+	ocmc_virt = ioremap_wc(ocmc_dma, ocmc_len);
+	if (!ocmc_virt) {
+		status = -ENOMEM;
+		goto err_clk;
+	}
+
+	ocmc_pool = gen_pool_create(ilog2(OCMC_GRANULARITY), -1);
+	if (!ocmc_pool) {
+		status = -ENOMEM;
+		goto err_unmap;
+	}
+	status = gen_pool_add(ocmc_pool, (unsigned long)ocmc_virt,
+			      ocmc_len, -1);
+	if (status < 0)
+		goto err_pool;
+
+	pr_info("OCMC: %luK at 0x%08x for DMA buffers\n", ocmc_len >> 10,
+		ocmc_dma);
+	return 0;
+
+err_pool:
+	gen_pool_destroy(ocmc_pool);
+	ocmc_pool = NULL;
+err_unmap:
+	iounmap(ocmc_virt);
+err_clk:
+	clk_disable(clk);
+	clk_put(clk);
+	return status;
+}
+arch_initcall(ti81xx_ocmc_init);
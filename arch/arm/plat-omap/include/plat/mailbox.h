@@ -20,6 +20,29 @@ typedef int __bitwise omap_mbox_type_t;
 #define OMAP_MBOX_TYPE1 ((__force omap_mbox_type_t) 1)
 #define OMAP_MBOX_TYPE2 ((__force omap_mbox_type_t) 2)
 
+/*
+ * How received messages are delivered, see omap_mbox_set_rx_handler().
+ * OMAP_MBOX_RX_WORK calls the notifier chain from the mboxd workqueue.
+ */
+enum omap_mbox_rx_mode {
+	OMAP_MBOX_RX_WORK,
+	OMAP_MBOX_RX_DIRECT,		/* from the hard IRQ, must not sleep */
+	OMAP_MBOX_RX_THREADED,		/* from the SCHED_FIFO IRQ thread */
+	OMAP_MBOX_RX_MODES,
+};
+
+typedef void (*omap_mbox_rx_fn)(struct omap_mbox *mbox, mbox_msg_t msg,
+				void *data);
+
+/* mailbox IRQ to delivery latency, in log2 buckets of microseconds */
+#define OMAP_MBOX_LAT_BUCKETS	16
+
+struct omap_mbox_lat_stats {
+	u32	count;
+	u32	max_us;
+	u32	hist[OMAP_MBOX_LAT_BUCKETS];
+};
+
 struct omap_mbox_ops {
 	omap_mbox_type_t	type;
 	int		(*startup)(struct omap_mbox *mbox);
@@ -59,6 +82,10 @@ struct omap_mbox {
 	void			*priv;
 	int			use_count;
 	struct blocking_notifier_head   notifier;
+	enum omap_mbox_rx_mode	rx_mode;
+	omap_mbox_rx_fn		rx_fn;
+	void			*rx_data;
+	struct omap_mbox_lat_stats rx_lat[OMAP_MBOX_RX_MODES];
 };
 
 int omap_mbox_msg_send(struct omap_mbox *, mbox_msg_t msg);
@@ -66,6 +93,9 @@ void omap_mbox_init_seq(struct omap_mbox *);
 
 struct omap_mbox *omap_mbox_get(const char *, struct notifier_block *nb);
 void omap_mbox_put(struct omap_mbox *mbox, struct notifier_block *nb);
+int omap_mbox_set_rx_handler(struct omap_mbox *mbox,
+			     enum omap_mbox_rx_mode mode,
+			     omap_mbox_rx_fn fn, void *data);
 
 int omap_mbox_register(struct device *parent, struct omap_mbox **);
 int omap_mbox_unregister(void);
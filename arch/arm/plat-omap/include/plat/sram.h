@@ -69,6 +69,17 @@ extern u32 omap3_sram_configure_core_dpll(
 			u32 sdrc_actim_ctrl_b_1, u32 sdrc_mr_1);
 extern unsigned long omap3_sram_configure_core_dpll_sz;
 
+#ifdef CONFIG_ARCH_TI81XX
+extern void *ti81xx_ocmc_alloc(size_t len, dma_addr_t *dma);
+extern void ti81xx_ocmc_free(void *addr, size_t len);
+#else
+static inline void *ti81xx_ocmc_alloc(size_t len, dma_addr_t *dma)
+{
+	return NULL;
+}
+static inline void ti81xx_ocmc_free(void *addr, size_t len) {}
+#endif
+
 #ifdef CONFIG_PM
 extern void omap_push_sram_idle(void);
 #else
@@ -86,4 +97,12 @@ static inline void omap_push_sram_idle(void) {}
 #define OMAP4_SRAM_PA		0x40300000
 #define TI814X_SRAM_PA		0x402F1000
 
+/*
+ * TI81xx: L3 on-chip memory controller (OCMC) RAM, usable as DMA buffers.
+ */
+#define TI81XX_OCMC0_PA		0x40300000
+#define TI816X_OCMC1_PA		0x40400000
+#define TI816X_OCMC_SIZE	0x40000		/* 256K per bank */
+#define TI814X_OCMC_SIZE	0x20000		/* 128K */
+
 #endif
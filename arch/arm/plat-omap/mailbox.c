@@ -29,6 +29,9 @@
 #include <linux/kfifo.h>
 #include <linux/err.h>
 #include <linux/notifier.h>
+#include <linux/ktime.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 #include <plat/mailbox.h>
 
@@ -42,6 +45,12 @@ static unsigned int mbox_kfifo_size = CONFIG_OMAP_MBOX_KFIFO_SIZE;
 module_param(mbox_kfifo_size, uint, S_IRUGO);
 MODULE_PARM_DESC(mbox_kfifo_size, "Size of omap's mailbox kfifo (bytes)");
 
+/* an RX kfifo record: the message and when its interrupt came in */
+struct mbox_rx_msg {
+	mbox_msg_t	msg;
+	ktime_t		stamp;
+};
+
 /* Mailbox FIFO handle functions */
 static inline mbox_msg_t mbox_fifo_read(struct omap_mbox *mbox)
 {
@@ -138,31 +147,49 @@ static void mbox_tx_tasklet(unsigned long tx_data)
 }
 
 /*
- * Message receiver(workqueue)
+ * Message receiver(workqueue, IRQ thread or hard IRQ)
  */
-static void mbox_rx_work(struct work_struct *work)
+static void mbox_rx_deliver(struct omap_mbox *mbox,
+			    enum omap_mbox_rx_mode mode, struct mbox_rx_msg *rx)
 {
-	struct omap_mbox_queue *mq =
-			container_of(work, struct omap_mbox_queue, work);
-	mbox_msg_t msg;
+	struct omap_mbox_lat_stats *lat = &mbox->rx_lat[mode];
+	u32 us;
+
+	us = min_t(s64, ktime_us_delta(ktime_get(), rx->stamp), UINT_MAX);
+	lat->hist[min_t(int, fls(us), OMAP_MBOX_LAT_BUCKETS - 1)]++;
+	lat->count++;
+	if (us > lat->max_us)
+		lat->max_us = us;
+
+	if (mode == OMAP_MBOX_RX_WORK)
+		blocking_notifier_call_chain(&mbox->notifier, sizeof(rx->msg),
+							(void *)rx->msg);
+	else
+		mbox->rx_fn(mbox, rx->msg, mbox->rx_data);
+}
+
+static void mbox_rx_drain(struct omap_mbox_queue *mq,
+			  enum omap_mbox_rx_mode mode)
+{
+	struct mbox_rx_msg rx;
 	int len;
 
-	while (kfifo_len(&mq->fifo) >= sizeof(msg)) {
-		len = kfifo_out(&mq->fifo, (unsigned char *)&msg, sizeof(msg));
-		WARN_ON(len != sizeof(msg));
+	while (kfifo_len(&mq->fifo) >= sizeof(rx)) {
+		len = kfifo_out(&mq->fifo, (unsigned char *)&rx, sizeof(rx));
+		WARN_ON(len != sizeof(rx));
 
-		blocking_notifier_call_chain(&mq->mbox->notifier, len,
-								(void *)msg);
+		mbox_rx_deliver(mq->mbox, mode, &rx);
 		spin_lock_irq(&mq->lock);
 		if (mq->full) {
 			mq->full = false;
 
 			if (!mbox_fifo_empty(mq->mbox)) {
-				msg = mbox_fifo_read(mq->mbox);
+				rx.msg = mbox_fifo_read(mq->mbox);
+				rx.stamp = ktime_get();
 
-				len = kfifo_in(&mq->fifo, (unsigned char *)&msg,
-								sizeof(msg));
-/*				WARN_ON(len != sizeof(msg));*/
+				len = kfifo_in(&mq->fifo, (unsigned char *)&rx,
+								sizeof(rx));
+/*				WARN_ON(len != sizeof(rx));*/
 			}
 
 
@@ -172,6 +199,14 @@ static void mbox_rx_work(struct work_struct *work)
 	}
 }
 
+static void mbox_rx_work(struct work_struct *work)
+{
+	struct omap_mbox_queue *mq =
+			container_of(work, struct omap_mbox_queue, work);
+
+	mbox_rx_drain(mq, OMAP_MBOX_RX_WORK);
+}
+
 /*
  * Mailbox interrupt handler
  */
@@ -182,23 +217,33 @@ static void __mbox_tx_interrupt(struct omap_mbox *mbox)
 	tasklet_schedule(&mbox->txq->tasklet);
 }
 
-static void __mbox_rx_interrupt(struct omap_mbox *mbox)
+/* returns true when the messages are left to the IRQ thread */
+static bool __mbox_rx_interrupt(struct omap_mbox *mbox)
 {
 	struct omap_mbox_queue *mq = mbox->rxq;
-	mbox_msg_t msg;
+	enum omap_mbox_rx_mode mode = mbox->rx_mode;
+	struct mbox_rx_msg rx;
 	int len;
 
+	rx.stamp = ktime_get();
+
 	while (!mbox_fifo_empty(mbox)) {
-		if (unlikely(kfifo_avail(&mq->fifo) < sizeof(msg))) {
-			omap_mbox_disable_irq(mbox, IRQ_RX);
-			mq->full = true;
-			goto nomem;
-		}
+		if (mode == OMAP_MBOX_RX_DIRECT) {
+			rx.msg = mbox_fifo_read(mbox);
+			mbox_rx_deliver(mbox, mode, &rx);
+		} else {
+			if (unlikely(kfifo_avail(&mq->fifo) < sizeof(rx))) {
+				omap_mbox_disable_irq(mbox, IRQ_RX);
+				mq->full = true;
+				goto nomem;
+			}
 
-		msg = mbox_fifo_read(mbox);
+			rx.msg = mbox_fifo_read(mbox);
 
-		len = kfifo_in(&mq->fifo, (unsigned char *)&msg, sizeof(msg));
-		WARN_ON(len != sizeof(msg));
+			len = kfifo_in(&mq->fifo, (unsigned char *)&rx,
+								sizeof(rx));
+			WARN_ON(len != sizeof(rx));
+		}
 
 		if (mbox->ops->type == OMAP_MBOX_TYPE1)
 			break;
@@ -207,27 +252,52 @@ static void __mbox_rx_interrupt(struct omap_mbox *mbox)
 nomem:
 	/* clear IRQ source. */
 	ack_mbox_irq(mbox, IRQ_RX);
-	queue_work(mboxd, &mbox->rxq->work);
+	if (mode == OMAP_MBOX_RX_THREADED)
+		return true;
+	if (mode == OMAP_MBOX_RX_WORK)
+		queue_work(mboxd, &mbox->rxq->work);
+	return false;
 }
 
 static irqreturn_t mbox_interrupt(int irq, void *p)
 {
+	irqreturn_t ret = IRQ_HANDLED;
 	int i;
 
 	for (i = 0; mboxes[i]; i++)  {
 		struct omap_mbox *mbox = mboxes[i];
+
+		/* mailboxes on other lines are left to their own handler */
+		if (mbox->irq != irq)
+			continue;
+
 		if (is_mbox_irq(mbox, IRQ_TX))
 			__mbox_tx_interrupt(mbox);
 
 
-		if (is_mbox_irq(mbox, IRQ_RX))
-			__mbox_rx_interrupt(mbox);
+		if (is_mbox_irq(mbox, IRQ_RX) && __mbox_rx_interrupt(mbox))
+			ret = IRQ_WAKE_THREAD;
 
 	}
+	return ret;
+}
+
+static irqreturn_t mbox_interrupt_thread(int irq, void *p)
+{
+	int i;
+
+	for (i = 0; mboxes[i]; i++)  {
+		struct omap_mbox *mbox = mboxes[i];
+
+		if (mbox->irq == irq &&
+		    mbox->rx_mode == OMAP_MBOX_RX_THREADED)
+			mbox_rx_drain(mbox->rxq, OMAP_MBOX_RX_THREADED);
+	}
 	return IRQ_HANDLED;
 }
 
 static struct omap_mbox_queue *mbox_queue_alloc(struct omap_mbox *mbox,
+					unsigned int size,
 					void (*work) (struct work_struct *),
 					void (*tasklet)(unsigned long))
 {
@@ -239,7 +309,7 @@ static struct omap_mbox_queue *mbox_queue_alloc(struct omap_mbox *mbox,
 
 	spin_lock_init(&mq->lock);
 
-	if (kfifo_alloc(&mq->fifo, mbox_kfifo_size, GFP_KERNEL))
+	if (kfifo_alloc(&mq->fifo, size, GFP_KERNEL))
 		goto error;
 
 	if (work)
@@ -275,21 +345,26 @@ static int omap_mbox_startup(struct omap_mbox *mbox)
 	}
 
 	if (!mbox->use_count++) {
-		ret = request_irq(mbox->irq, mbox_interrupt, IRQF_SHARED,
-							mbox->name, mbox);
+		ret = request_threaded_irq(mbox->irq, mbox_interrupt,
+					   mbox_interrupt_thread, IRQF_SHARED,
+					   mbox->name, mbox);
 		if (unlikely(ret)) {
 			pr_err("failed to register mailbox interrupt:%d\n",
 									ret);
 			goto fail_request_irq;
 		}
-		mq = mbox_queue_alloc(mbox, NULL, mbox_tx_tasklet);
+		mq = mbox_queue_alloc(mbox, mbox_kfifo_size, NULL,
+							mbox_tx_tasklet);
 		if (!mq) {
 			ret = -ENOMEM;
 			goto fail_alloc_txq;
 		}
 		mbox->txq = mq;
 
-		mq = mbox_queue_alloc(mbox, mbox_rx_work, NULL);
+		/* room for as many messages as the TX queue, with stamps */
+		mq = mbox_queue_alloc(mbox, mbox_kfifo_size /
+				sizeof(mbox_msg_t) * sizeof(struct mbox_rx_msg),
+				mbox_rx_work, NULL);
 		if (!mq) {
 			ret = -ENOMEM;
 			goto fail_alloc_rxq;
@@ -319,7 +394,11 @@ static void omap_mbox_fini(struct omap_mbox *mbox)
 	mutex_lock(&mbox_configured_lock);
 
 	if (!--mbox->use_count) {
+		/* free_irq() waits for the IRQ thread before rx_fn goes */
+		mbox->rx_mode = OMAP_MBOX_RX_WORK;
 		free_irq(mbox->irq, mbox);
+		mbox->rx_fn = NULL;
+		mbox->rx_data = NULL;
 		tasklet_kill(&mbox->txq->tasklet);
 		flush_work(&mbox->rxq->work);
 		mbox_queue_free(mbox->txq);
@@ -367,6 +446,148 @@ void omap_mbox_put(struct omap_mbox *mbox, struct notifier_block *nb)
 }
 EXPORT_SYMBOL(omap_mbox_put);
 
+/**
+ * omap_mbox_set_rx_handler - choose how received messages are delivered
+ * @mbox: mailbox returned by omap_mbox_get()
+ * @mode: OMAP_MBOX_RX_DIRECT or OMAP_MBOX_RX_THREADED to have @fn called,
+ *	OMAP_MBOX_RX_WORK to go back to the notifier chain
+ * @fn: called for each message, from the mailbox interrupt for
+ *	OMAP_MBOX_RX_DIRECT and from its SCHED_FIFO thread otherwise
+ * @data: passed to @fn
+ *
+ * This saves fast consumers the trip through the mboxd workqueue.  While
+ * @fn is set the notifier chain gets no messages; messages received
+ * before the switch are delivered the old way first.  The handler is
+ * dropped with the last omap_mbox_put().
+ */
+int omap_mbox_set_rx_handler(struct omap_mbox *mbox,
+			     enum omap_mbox_rx_mode mode,
+			     omap_mbox_rx_fn fn, void *data)
+{
+	int ret = 0;
+
+	if (mode >= OMAP_MBOX_RX_MODES || (mode != OMAP_MBOX_RX_WORK && !fn))
+		return -EINVAL;
+
+	mutex_lock(&mbox_configured_lock);
+	if (!mbox->use_count) {
+		ret = -ENODEV;
+		goto out;
+	}
+
+	/* keep the interrupt, its thread and mboxd off the queue */
+	disable_irq(mbox->irq);
+	flush_work(&mbox->rxq->work);
+	mbox_rx_drain(mbox->rxq, mbox->rx_mode);
+
+	mbox->rx_mode = mode;
+	mbox->rx_fn = mode == OMAP_MBOX_RX_WORK ? NULL : fn;
+	mbox->rx_data = mode == OMAP_MBOX_RX_WORK ? NULL : data;
+	enable_irq(mbox->irq);
+out:
+	mutex_unlock(&mbox_configured_lock);
+	return ret;
+}
+EXPORT_SYMBOL(omap_mbox_set_rx_handler);
+
+#ifdef CONFIG_DEBUG_FS
+/*
+ * <debugfs>/mailbox/<name>: IRQ to delivery latency of each mailbox, per
+ * delivery mode.  Writing to the file clears it.
+ */
+static struct dentry *mbox_dbg_dir;
+
+static const char *mbox_rx_mode_names[OMAP_MBOX_RX_MODES] = {
+	[OMAP_MBOX_RX_WORK]	= "work",
+	[OMAP_MBOX_RX_DIRECT]	= "direct",
+	[OMAP_MBOX_RX_THREADED]	= "threaded",
+};
+
+static int mbox_rx_latency_show(struct seq_file *s, void *unused)
+{
+	struct omap_mbox *mbox = s->private;
+	char range[16];
+	int mode, i;
+
+	seq_printf(s, "mode: %s\n\n%-12s", mbox_rx_mode_names[mbox->rx_mode],
+		   "usecs");
+	for (mode = 0; mode < OMAP_MBOX_RX_MODES; mode++)
+		seq_printf(s, " %10s", mbox_rx_mode_names[mode]);
+	seq_putc(s, '\n');
+
+	for (i = 0; i < OMAP_MBOX_LAT_BUCKETS; i++) {
+		if (i == 0)
+			snprintf(range, sizeof(range), "0");
+		else if (i == OMAP_MBOX_LAT_BUCKETS - 1)
+			snprintf(range, sizeof(range), "%u+", 1u << (i - 1));
+		else
+			snprintf(range, sizeof(range), "%u-%u", 1u << (i - 1),
+				 (1u << i) - 1);
+
+		seq_printf(s, "%-12s", range);
+		for (mode = 0; mode < OMAP_MBOX_RX_MODES; mode++)
+			seq_printf(s, " %10u", mbox->rx_lat[mode].hist[i]);
+		seq_putc(s, '\n');
+	}
+
+	seq_printf(s, "%-12s", "total");
+	for (mode = 0; mode < OMAP_MBOX_RX_MODES; mode++)
+		seq_printf(s, " %10u", mbox->rx_lat[mode].count);
+	seq_printf(s, "\n%-12s", "max");
+	for (mode = 0; mode < OMAP_MBOX_RX_MODES; mode++)
+		seq_printf(s, " %10u", mbox->rx_lat[mode].max_us);
+	seq_putc(s, '\n');
+	return 0;
+}
+
+static int mbox_rx_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, mbox_rx_latency_show, inode->i_private);
+}
+
+static ssize_t mbox_rx_latency_write(struct file *file,
+				     const char __user *buf, size_t count,
+				     loff_t *ppos)
+{
+	struct omap_mbox *mbox =
+			((struct seq_file *)file->private_data)->private;
+
+	memset(mbox->rx_lat, 0, sizeof(mbox->rx_lat));
+	return count;
+}
+
+static const struct file_operations mbox_rx_latency_fops = {
+	.open		= mbox_rx_latency_open,
+	.read		= seq_read,
+	.write		= mbox_rx_latency_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static void mbox_debugfs_init(void)
+{
+	int i;
+
+	mbox_dbg_dir = debugfs_create_dir("mailbox", NULL);
+	if (IS_ERR_OR_NULL(mbox_dbg_dir))
+		return;
+
+	for (i = 0; mboxes[i]; i++)
+		debugfs_create_file(mboxes[i]->name, S_IRUGO | S_IWUSR,
+				    mbox_dbg_dir, mboxes[i],
+				    &mbox_rx_latency_fops);
+}
+
+static void mbox_debugfs_exit(void)
+{
+	debugfs_remove_recursive(mbox_dbg_dir);
+	mbox_dbg_dir = NULL;
+}
+#else
+static inline void mbox_debugfs_init(void) { }
+static inline void mbox_debugfs_exit(void) { }
+#endif
+
 static struct class omap_mbox_class = { .name = "mbox", };
 
 int omap_mbox_register(struct device *parent, struct omap_mbox **list)
@@ -389,6 +610,7 @@ int omap_mbox_register(struct device *parent, struct omap_mbox **list)
 
 		BLOCKING_INIT_NOTIFIER_HEAD(&mbox->notifier);
 	}
+	mbox_debugfs_init();
 	return 0;
 
 err_out:
@@ -405,6 +627,7 @@ int omap_mbox_unregister(void)
 	if (!mboxes)
 		return -EINVAL;
 
+	mbox_debugfs_exit();
 	for (i = 0; mboxes[i]; i++)
 		device_unregister(mboxes[i]->dev);
 	mboxes = NULL;
@@ -0,0 +1,585 @@
+/*
+ * Memory to memory copy offload on TI EDMA3
+ *
+ * Copyright (C) 2011 Texas Instruments Incorporated - http://www.ti.com/
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation version 2.
+ *
+ * This program is distributed "as is" WITHOUT ANY WARRANTY of any
+ * kind, whether express or implied; without even the implied warranty
+ * of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * Each dmaengine channel owns one event-less EDMA channel.  Submitted
+ * copies are queued and, when the channel is idle, as many as fit are
+ * written into one PaRAM chain (see edma_chain_commit()) whose sets
+ * trigger one another, so a whole batch costs one software trigger and
+ * one completion interrupt.  The event queue, and with it the transfer
+ * controller, comes from platform data; pick one no peripheral uses.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/init.h>
+#include <linux/slab.h>
+#include <linux/interrupt.h>
+#include <linux/platform_device.h>
+#include <linux/dmaengine.h>
+#include <linux/dma-mapping.h>
+#include <linux/completion.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+
+#include <asm/sizes.h>
+#include <asm/hardware/edma.h>
+
+/* edma_chain_add_memcpy() uses at most two sets of 16 KiB arrays */
+#define EDMA_MEMCPY_ACNT	SZ_16K
+#define EDMA_MEMCPY_MAX		(0xffffUL * EDMA_MEMCPY_ACNT)
+
+#define EDMA_MEMCPY_SETS	16	/* parameter sets per started batch */
+#define EDMA_MEMCPY_DESCS	64	/* descriptors per channel */
+
+static int bench;
+module_param(bench, bool, 0444);
+MODULE_PARM_DESC(bench, "compare CPU and EDMA copy throughput at probe");
+
+struct edma_memcpy_desc {
+	struct dma_async_tx_descriptor	txd;
+	struct list_head		node;
+	dma_addr_t			dst;
+	dma_addr_t			src;
+	size_t				len;
+	unsigned			sets;
+};
+
+struct edma_memcpy_chan {
+	struct dma_chan		chan;
+	int			ch_num;		/* EDMA channel */
+	struct edma_chain	*chain;
+	dma_cookie_t		completed;
+	dma_cookie_t		error_first;	/* last failed batch */
+	dma_cookie_t		error_last;
+
+	spinlock_t		lock;
+	struct list_head	free;
+	struct list_head	queue;		/* submitted, not started */
+	struct list_head	active;		/* in the running chain */
+	struct list_head	done;		/* waiting for the tasklet */
+	struct tasklet_struct	tasklet;
+};
+
+struct edma_memcpy_device {
+	struct dma_device		dma;
+	int				nr_chans;
+	struct edma_memcpy_chan		chans[0];
+};
+
+static inline struct edma_memcpy_chan *to_edma_memcpy_chan(struct dma_chan *c)
+{
+	return container_of(c, struct edma_memcpy_chan, chan);
+}
+
+static inline struct edma_memcpy_desc *
+to_edma_memcpy_desc(struct dma_async_tx_descriptor *txd)
+{
+	return container_of(txd, struct edma_memcpy_desc, txd);
+}
+
+static inline struct device *chan2dev(struct edma_memcpy_chan *ec)
+{
+	return ec->chan.device->dev;
+}
+
+static unsigned edma_memcpy_sets(size_t len)
+{
+	return !!(len / EDMA_MEMCPY_ACNT) + !!(len % EDMA_MEMCPY_ACNT);
+}
+
+/*
+ * Start as many queued copies as fit in one chain.  Every set but the
+ * last chains to the next; only the last one interrupts.  Called with
+ * ec->lock held.
+ */
+static void edma_memcpy_start(struct edma_memcpy_chan *ec)
+{
+	struct edma_memcpy_desc *desc, *next;
+	unsigned sets = 0;
+
+	if (!list_empty(&ec->active) || list_empty(&ec->queue))
+		return;
+
+	edma_chain_reset(ec->chain);
+	list_for_each_entry_safe(desc, next, &ec->queue, node) {
+		bool last;
+
+		sets += desc->sets;
+		last = list_is_last(&desc->node, &ec->queue) ||
+			sets + next->sets > EDMA_MEMCPY_SETS;
+
+		edma_chain_add_memcpy(ec->chain, desc->dst, desc->src,
+				desc->len,
+				last ? EDMA_CHAIN_INTR : EDMA_CHAIN_NEXT);
+		list_move_tail(&desc->node, &ec->active);
+		if (last)
+			break;
+	}
+
+	edma_chain_commit(ec->chain);
+	edma_start(ec->ch_num);
+}
+
+static void edma_memcpy_callback(unsigned ch_num, u16 ch_status, void *data)
+{
+	struct edma_memcpy_chan *ec = data;
+	struct edma_memcpy_desc *first, *last;
+
+	spin_lock(&ec->lock);
+
+	if (!list_empty(&ec->active)) {
+		first = list_first_entry(&ec->active, struct edma_memcpy_desc,
+					 node);
+		last = list_entry(ec->active.prev, struct edma_memcpy_desc,
+				  node);
+		/* the whole batch is suspect, edma_memcpy_tx_status() fails it */
+		if (ch_status != DMA_COMPLETE) {
+			ec->error_first = first->txd.cookie;
+			ec->error_last = last->txd.cookie;
+		}
+		ec->completed = last->txd.cookie;
+		list_splice_tail_init(&ec->active, &ec->done);
+	}
+
+	if (ch_status != DMA_COMPLETE) {
+		dev_err(chan2dev(ec), "channel %d error %d\n",
+			EDMA_CHAN_SLOT(ch_num), ch_status);
+		edma_clean_channel(ec->ch_num);
+	}
+	edma_memcpy_start(ec);
+
+	spin_unlock(&ec->lock);
+
+	tasklet_schedule(&ec->tasklet);
+}
+
+static void edma_memcpy_unmap(struct edma_memcpy_chan *ec,
+			      struct edma_memcpy_desc *desc)
+{
+	struct dma_async_tx_descriptor *txd = &desc->txd;
+	struct device *dev = chan2dev(ec);
+
+	if (!(txd->flags & DMA_COMPL_SKIP_DEST_UNMAP)) {
+		if (txd->flags & DMA_COMPL_DEST_UNMAP_SINGLE)
+			dma_unmap_single(dev, desc->dst, desc->len,
+					 DMA_FROM_DEVICE);
+		else
+			dma_unmap_page(dev, desc->dst, desc->len,
+				       DMA_FROM_DEVICE);
+	}
+	if (!(txd->flags & DMA_COMPL_SKIP_SRC_UNMAP)) {
+		if (txd->flags & DMA_COMPL_SRC_UNMAP_SINGLE)
+			dma_unmap_single(dev, desc->src, desc->len,
+					 DMA_TO_DEVICE);
+		else
+			dma_unmap_page(dev, desc->src, desc->len,
+				       DMA_TO_DEVICE);
+	}
+}
+
+static void edma_memcpy_tasklet(unsigned long data)
+{
+	struct edma_memcpy_chan *ec = (struct edma_memcpy_chan *)data;
+	struct edma_memcpy_desc *desc;
+	unsigned long flags;
+	LIST_HEAD(list);
+
+	spin_lock_irqsave(&ec->lock, flags);
+	list_splice_init(&ec->done, &list);
+	spin_unlock_irqrestore(&ec->lock, flags);
+
+	list_for_each_entry(desc, &list, node) {
+		struct dma_async_tx_descriptor *txd = &desc->txd;
+
+		edma_memcpy_unmap(ec, desc);
+		if (txd->callback)
+			txd->callback(txd->callback_param);
+		dma_run_dependencies(txd);
+	}
+
+	spin_lock_irqsave(&ec->lock, flags);
+	list_splice_tail(&list, &ec->free);
+	spin_unlock_irqrestore(&ec->lock, flags);
+}
+
+static dma_cookie_t edma_memcpy_tx_submit(struct dma_async_tx_descriptor *txd)
+{
+	struct edma_memcpy_chan *ec = to_edma_memcpy_chan(txd->chan);
+	struct edma_memcpy_desc *desc = to_edma_memcpy_desc(txd);
+	dma_cookie_t cookie;
+	unsigned long flags;
+
+	spin_lock_irqsave(&ec->lock, flags);
+	cookie = ec->chan.cookie + 1;
+	if (cookie < 0)
+		cookie = 1;
+	ec->chan.cookie = cookie;
+	txd->cookie = cookie;
+	list_add_tail(&desc->node, &ec->queue);
+	spin_unlock_irqrestore(&ec->lock, flags);
+
+	return cookie;
+}
+
+static struct dma_async_tx_descriptor *
+edma_memcpy_prep_memcpy(struct dma_chan *chan, dma_addr_t dest,
+			dma_addr_t src, size_t len, unsigned long tx_flags)
+{
+	struct edma_memcpy_chan *ec = to_edma_memcpy_chan(chan);
+	struct edma_memcpy_desc *desc, *found = NULL;
+	unsigned long flags;
+
+	if (!len || len > EDMA_MEMCPY_MAX)
+		return NULL;
+
+	spin_lock_irqsave(&ec->lock, flags);
+	list_for_each_entry(desc, &ec->free, node) {
+		if (async_tx_test_ack(&desc->txd)) {
+			list_del(&desc->node);
+			found = desc;
+			break;
+		}
+	}
+	spin_unlock_irqrestore(&ec->lock, flags);
+
+	if (!found) {
+		dev_dbg(chan2dev(ec), "out of descriptors\n");
+		return NULL;
+	}
+
+	found->dst = dest;
+	found->src = src;
+	found->len = len;
+	found->sets = edma_memcpy_sets(len);
+	found->txd.flags = tx_flags;
+	found->txd.cookie = -EBUSY;
+
+	return &found->txd;
+}
+
+static enum dma_status edma_memcpy_tx_status(struct dma_chan *chan,
+		dma_cookie_t cookie, struct dma_tx_state *txstate)
+{
+	struct edma_memcpy_chan *ec = to_edma_memcpy_chan(chan);
+	dma_cookie_t last_used, last_complete, error_first, error_last;
+	enum dma_status ret;
+	unsigned long flags;
+
+	spin_lock_irqsave(&ec->lock, flags);
+	last_used = chan->cookie;
+	last_complete = ec->completed;
+	error_first = ec->error_first;
+	error_last = ec->error_last;
+	spin_unlock_irqrestore(&ec->lock, flags);
+
+	dma_set_tx_state(txstate, last_complete, last_used, 0);
+
+	ret = dma_async_is_complete(cookie, last_complete, last_used);
+	/* finished, but in the batch that ended in a channel error */
+	if (ret == DMA_SUCCESS && error_last &&
+	    dma_async_is_complete(cookie, error_first - 1, error_last) ==
+	    DMA_IN_PROGRESS)
+		ret = DMA_ERROR;
+
+	return ret;
+}
+
+static void edma_memcpy_issue_pending(struct dma_chan *chan)
+{
+	struct edma_memcpy_chan *ec = to_edma_memcpy_chan(chan);
+	unsigned long flags;
+
+	spin_lock_irqsave(&ec->lock, flags);
+	edma_memcpy_start(ec);
+	spin_unlock_irqrestore(&ec->lock, flags);
+}
+
+static int edma_memcpy_alloc_chan_resources(struct dma_chan *chan)
+{
+	struct edma_memcpy_chan *ec = to_edma_memcpy_chan(chan);
+	struct edma_memcpy_desc *desc;
+	int i;
+
+	for (i = 0; i < EDMA_MEMCPY_DESCS; i++) {
+		desc = kzalloc(sizeof(*desc), GFP_KERNEL);
+		if (!desc)
+			break;
+		dma_async_tx_descriptor_init(&desc->txd, chan);
+		desc->txd.tx_submit = edma_memcpy_tx_submit;
+		desc->txd.flags = DMA_CTRL_ACK;
+		list_add_tail(&desc->node, &ec->free);
+	}
+
+	if (!i)
+		return -ENOMEM;
+
+	ec->completed = chan->cookie = 1;
+	ec->error_first = ec->error_last = 0;
+
+	return i;
+}
+
+static void edma_memcpy_free_chan_resources(struct dma_chan *chan)
+{
+	struct edma_memcpy_chan *ec = to_edma_memcpy_chan(chan);
+	struct edma_memcpy_desc *desc, *tmp;
+	unsigned long flags;
+	LIST_HEAD(list);
+
+	edma_stop(ec->ch_num);
+	tasklet_kill(&ec->tasklet);
+
+	spin_lock_irqsave(&ec->lock, flags);
+	list_splice_init(&ec->free, &list);
+	list_splice_init(&ec->queue, &list);
+	list_splice_init(&ec->active, &list);
+	list_splice_init(&ec->done, &list);
+	spin_unlock_irqrestore(&ec->lock, flags);
+
+	list_for_each_entry_safe(desc, tmp, &list, node)
+		kfree(desc);
+}
+
+/*-----------------------------------------------------------------------*/
+
+static void edma_memcpy_bench_done(void *data)
+{
+	complete(data);
+}
+
+static s64 edma_memcpy_bench_edma(struct edma_memcpy_chan *ec, void *dst,
+				  void *src, size_t len, int iters)
+{
+	struct dma_async_tx_descriptor *txd;
+	struct device *dev = chan2dev(ec);
+	struct completion done;
+	ktime_t start;
+	int i;
+
+	start = ktime_get();
+	for (i = 0; i < iters; i++) {
+		dma_addr_t dma_dst, dma_src;
+
+		dma_src = dma_map_single(dev, src, len, DMA_TO_DEVICE);
+		dma_dst = dma_map_single(dev, dst, len, DMA_FROM_DEVICE);
+
+		txd = edma_memcpy_prep_memcpy(&ec->chan, dma_dst, dma_src, len,
+				DMA_CTRL_ACK | DMA_PREP_INTERRUPT |
+				DMA_COMPL_SRC_UNMAP_SINGLE |
+				DMA_COMPL_DEST_UNMAP_SINGLE);
+		if (!txd)
+			return -ENOMEM;
+
+		init_completion(&done);
+		txd->callback = edma_memcpy_bench_done;
+		txd->callback_param = &done;
+		txd->tx_submit(txd);
+		edma_memcpy_issue_pending(&ec->chan);
+
+		if (!wait_for_completion_timeout(&done,
+						 msecs_to_jiffies(1000)))
+			return -ETIMEDOUT;
+	}
+
+	return ktime_to_ns(ktime_sub(ktime_get(), start));
+}
+
+static unsigned edma_memcpy_bench_mbps(size_t len, int iters, s64 ns)
+{
+	if (ns <= 0)
+		return 0;
+	return div64_u64((u64)len * iters * 1000, ns);
+}
+
+/*
+ * Copy buffers of growing size with the CPU and with the first channel,
+ * the EDMA side including the cache maintenance done by mapping, and
+ * report the smallest size from which offloading pays off; that is a
+ * sensible value for net.ipv4.tcp_dma_copybreak.
+ */
+static void edma_memcpy_bench(struct edma_memcpy_device *ecd)
+{
+	struct edma_memcpy_chan *ec = &ecd->chans[0];
+	struct device *dev = ecd->dma.dev;
+	size_t max = SZ_1M, len, copybreak = 0;
+	void *src, *dst;
+
+	src = kmalloc(max, GFP_KERNEL);
+	dst = kmalloc(max, GFP_KERNEL);
+	if (!src || !dst)
+		goto out;
+	memset(src, 0x5a, max);
+
+	if (edma_memcpy_alloc_chan_resources(&ec->chan) < 0)
+		goto out;
+
+	for (len = SZ_512; len <= max; len <<= 1) {
+		int iters = max_t(int, 8, SZ_4M / len);
+		unsigned cpu, dma;
+		ktime_t start;
+		s64 ns;
+		int i;
+
+		start = ktime_get();
+		for (i = 0; i < iters; i++)
+			memcpy(dst, src, len);
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+		cpu = edma_memcpy_bench_mbps(len, iters, ns);
+
+		ns = edma_memcpy_bench_edma(ec, dst, src, len, iters);
+		if (ns < 0) {
+			dev_err(dev, "benchmark failed at %zu bytes: %lld\n",
+				len, ns);
+			break;
+		}
+		dma = edma_memcpy_bench_mbps(len, iters, ns);
+
+		dev_info(dev, "%7zu bytes: cpu %5u MB/s, edma %5u MB/s\n",
+			 len, cpu, dma);
+		if (!copybreak && dma > cpu)
+			copybreak = len;
+	}
+
+	if (copybreak)
+		dev_info(dev, "offload pays off from %zu bytes\n", copybreak);
+	else
+		dev_info(dev, "offload never beat the CPU\n");
+
+	edma_memcpy_free_chan_resources(&ec->chan);
+	ec->chan.cookie = 0;
+out:
+	kfree(dst);
+	kfree(src);
+}
+
+/*-----------------------------------------------------------------------*/
+
+static void edma_memcpy_free_chans(struct edma_memcpy_device *ecd)
+{
+	int i;
+
+	for (i = 0; i < ecd->nr_chans; i++) {
+		struct edma_memcpy_chan *ec = &ecd->chans[i];
+
+		edma_chain_free(ec->chain);
+		edma_free_channel(ec->ch_num);
+	}
+}
+
+static int __init edma_memcpy_probe(struct platform_device *pdev)
+{
+	struct edma_memcpy_platform_data *pdata = pdev->dev.platform_data;
+	struct edma_memcpy_device *ecd;
+	int i, ret;
+
+	if (!pdata || !pdata->nr_channels)
+		return -EINVAL;
+
+	ecd = kzalloc(sizeof(*ecd) + pdata->nr_channels * sizeof(ecd->chans[0]),
+		      GFP_KERNEL);
+	if (!ecd)
+		return -ENOMEM;
+
+	INIT_LIST_HEAD(&ecd->dma.channels);
+	for (i = 0; i < pdata->nr_channels; i++) {
+		struct edma_memcpy_chan *ec = &ecd->chans[i];
+
+		ec->ch_num = edma_alloc_channel(EDMA_CHANNEL_ANY,
+				edma_memcpy_callback, ec, pdata->queue);
+		if (ec->ch_num < 0) {
+			ret = ec->ch_num;
+			goto err;
+		}
+
+		ec->chain = edma_chain_alloc(ec->ch_num, EDMA_MEMCPY_SETS, 0);
+		if (!ec->chain) {
+			edma_free_channel(ec->ch_num);
+			ret = -ENOMEM;
+			goto err;
+		}
+		ecd->nr_chans++;
+
+		spin_lock_init(&ec->lock);
+		INIT_LIST_HEAD(&ec->free);
+		INIT_LIST_HEAD(&ec->queue);
+		INIT_LIST_HEAD(&ec->active);
+		INIT_LIST_HEAD(&ec->done);
+		tasklet_init(&ec->tasklet, edma_memcpy_tasklet,
+			     (unsigned long)ec);
+
+		ec->chan.device = &ecd->dma;
+		list_add_tail(&ec->chan.device_node, &ecd->dma.channels);
+	}
+
+	dma_cap_set(DMA_MEMCPY, ecd->dma.cap_mask);
+	ecd->dma.dev = &pdev->dev;
+	ecd->dma.device_alloc_chan_resources = edma_memcpy_alloc_chan_resources;
+	ecd->dma.device_free_chan_resources = edma_memcpy_free_chan_resources;
+	ecd->dma.device_prep_dma_memcpy = edma_memcpy_prep_memcpy;
+	ecd->dma.device_tx_status = edma_memcpy_tx_status;
+	ecd->dma.device_issue_pending = edma_memcpy_issue_pending;
+
+	if (bench)
+		edma_memcpy_bench(ecd);
+
+	ret = dma_async_device_register(&ecd->dma);
+	if (ret)
+		goto err;
+
+	platform_set_drvdata(pdev, ecd);
+	dev_info(&pdev->dev, "%d memcpy channels on event queue %d\n",
+		 ecd->nr_chans, pdata->queue);
+
+	return 0;
+
+err:
+	edma_memcpy_free_chans(ecd);
+	kfree(ecd);
+	return ret;
+}
+
+static int __exit edma_memcpy_remove(struct platform_device *pdev)
+{
+	struct edma_memcpy_device *ecd = platform_get_drvdata(pdev);
+
+	dma_async_device_unregister(&ecd->dma);
+	edma_memcpy_free_chans(ecd);
+	kfree(ecd);
+
+	return 0;
+}
+
+static struct platform_driver edma_memcpy_driver = {
+	.remove		= __exit_p(edma_memcpy_remove),
+	.driver = {
+		.name	= "edma-memcpy",
+		.owner	= THIS_MODULE,
+	},
+};
+
+static int __init edma_memcpy_init(void)
+{
+	return platform_driver_probe(&edma_memcpy_driver, edma_memcpy_probe);
+}
+module_init(edma_memcpy_init);
+
+static void __exit edma_memcpy_exit(void)
+{
+	platform_driver_unregister(&edma_memcpy_driver);
+}
+module_exit(edma_memcpy_exit);
+
+MODULE_DESCRIPTION("TI EDMA3 memcpy offload");
+MODULE_LICENSE("GPL v2");
+MODULE_ALIAS("platform:edma-memcpy");
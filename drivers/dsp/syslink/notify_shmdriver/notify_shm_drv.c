@@ -24,6 +24,7 @@
 #include <linux/io.h>
 #include <linux/module.h>
 #include <linux/slab.h>
+#include <linux/err.h>
 #include <plat/mailbox.h>
 
 #include <syslink/multiproc.h>
@@ -79,6 +80,8 @@ static int notify_shmdrv_video_isr(struct notifier_block *,
 static int notify_shmdrv_vpss_isr(struct notifier_block *,
 					unsigned long, void *);
 static bool notify_shmdrv_isr_callback(void *ref_data, void* ntfy_msg);
+static void notify_shmdrv_mbox_fast(void *mbox_handle,
+					struct notifier_block *nb);
 
 
 /* Defines the notify_shm_drv state object, which contains all
@@ -148,6 +151,14 @@ static struct notify_shm_drv_module notify_shm_drv_state = {
 	.def_inst_params.remote_int_id = (u32) -1
 };
 
+/* Deliver mailbox messages from the SCHED_FIFO mailbox IRQ thread instead
+ * of the mboxd workqueue.  Notify callbacks may sleep, so they cannot be
+ * called from the mailbox interrupt itself. */
+static bool mbox_rx_thread;
+module_param(mbox_rx_thread, bool, S_IRUGO);
+MODULE_PARM_DESC(mbox_rx_thread,
+		"Receive mailbox messages in the mailbox IRQ thread");
+
 static struct notifier_block omap_notify_nb = {
 	.notifier_call = notify_shmdrv_isr,
 };
@@ -251,6 +262,9 @@ int notify_shm_drv_setup(struct notify_shm_drv_config *cfg)
 				status = NOTIFY_E_INVALIDSTATE;
 				goto error_mailbox_get_failed;
 			}
+			notify_shmdrv_mbox_fast(
+				notify_shm_drv_state.mbox_handle[rproc_id],
+				&omap_notify_nb);
 #if 0
 			/*Set callback functions to receive notifications from
 			 *dsp */
@@ -280,6 +294,9 @@ int notify_shm_drv_setup(struct notify_shm_drv_config *cfg)
 				goto error_mailbox_get_failed;
 			}
 
+			notify_shmdrv_mbox_fast(
+				notify_shm_drv_state.mbox_handle[rproc_id],
+				&omap_notify_nb);
 #if 0
 			((struct omap_mbox *)notify_shm_drv_state. \
 				mbox_handle[appm3_proc_id])->rxq->callback = \
@@ -300,6 +317,9 @@ int notify_shm_drv_setup(struct notify_shm_drv_config *cfg)
 				status = NOTIFY_E_INVALIDSTATE;
 				goto error_mailbox_get_failed;
 			}
+			notify_shmdrv_mbox_fast(
+				notify_shm_drv_state.mbox_handle[rproc_id],
+				&omap_notify_nb);
 #if 0
 			((struct omap_mbox *)notify_shm_drv_state. \
 				mbox_handle[rproc_id])->rxq->callback = \
@@ -322,6 +342,9 @@ int notify_shm_drv_setup(struct notify_shm_drv_config *cfg)
 				goto error_mailbox_get_failed;
 			}
 
+			notify_shmdrv_mbox_fast(
+				notify_shm_drv_state.mbox_handle[rproc_id],
+				&ti81xx_dsp_notify_nb);
 #if 0
 			((struct omap_mbox *)notify_shm_drv_state. \
 				mbox_handle[rproc_id])->rxq->callback = \
@@ -344,6 +367,9 @@ int notify_shm_drv_setup(struct notify_shm_drv_config *cfg)
 				status = NOTIFY_E_INVALIDSTATE;
 				goto error_mailbox_get_failed;
 			}
+			notify_shmdrv_mbox_fast(
+				notify_shm_drv_state.mbox_handle[rproc_id],
+				&ti81xx_video_notify_nb);
 #if 0
 			((struct omap_mbox *)notify_shm_drv_state. \
 				mbox_handle[rproc_id])->rxq->callback = \
@@ -367,6 +393,9 @@ int notify_shm_drv_setup(struct notify_shm_drv_config *cfg)
 				goto error_mailbox_get_failed;
 			}
 
+			notify_shmdrv_mbox_fast(
+				notify_shm_drv_state.mbox_handle[rproc_id],
+				&ti81xx_vpss_notify_nb);
 #if 0
 			((struct omap_mbox *)notify_shm_drv_state. \
 				mbox_handle[rproc_id])->rxq->callback = \
@@ -428,6 +457,14 @@ int notify_shm_drv_destroy(void)
 	atomic_set(&(notify_shm_drv_state.ref_count),
 		NOTIFYSHMDRIVER_MAKE_MAGICSTAMP(0));
 
+	/* Give the mailboxes back to the mboxd workqueue */
+	for (i = 0 ; i < MULTIPROC_MAXPROCESSORS; i++) {
+		if (mbox_rx_thread && \
+			!IS_ERR_OR_NULL(notify_shm_drv_state.mbox_handle[i]))
+			omap_mbox_set_rx_handler(notify_shm_drv_state.
+				mbox_handle[i], OMAP_MBOX_RX_WORK, NULL, NULL);
+	}
+
 	if (cpu_is_omap343x()) {
 		/* Finalize the maibox module for dsp */
 		rproc_id = multiproc_get_id("DSP");
@@ -1522,6 +1559,33 @@ static int notify_shmdrv_vpss_isr(struct notifier_block *nb, unsigned long val,
 }
 EXPORT_SYMBOL(notify_shmdrv_vpss_isr);
 
+/* Passes a message from the mailbox IRQ thread to the notifier block the
+ * mailbox was taken with. */
+static void notify_shmdrv_mbox_rx(struct omap_mbox *mbox, mbox_msg_t msg,
+								void *data)
+{
+	struct notifier_block *nb = data;
+
+	nb->notifier_call(nb, sizeof(msg), (void *)msg);
+}
+
+/* Has the mailbox deliver its messages from its IRQ thread rather than the
+ * mboxd workqueue, if asked to with mbox_rx_thread. */
+static void notify_shmdrv_mbox_fast(void *mbox_handle,
+					struct notifier_block *nb)
+{
+	int ret;
+
+	if (!mbox_rx_thread || IS_ERR_OR_NULL(mbox_handle))
+		return;
+
+	ret = omap_mbox_set_rx_handler((struct omap_mbox *)mbox_handle,
+			OMAP_MBOX_RX_THREADED, notify_shmdrv_mbox_rx, nb);
+	if (ret)
+		printk(KERN_ERR "omap_mbox_set_rx_handler failed! "
+			"status = %d\n", ret);
+}
+
 static bool notify_shmdrv_isr_callback(void *ref_data, void *notify_msg)
 {
 	u32 payload = 0;
@@ -64,6 +64,25 @@
 
 #define CPDMA_TEARDOWN_VALUE	0xfffffffc
 
+/* Software-only bits kept in sw_len alongside the buffer length */
+#define CPDMA_DESC_SW_PAGE	BIT(31)	/* buffer mapped with dma_map_page */
+#define CPDMA_DESC_SW_MORE	BIT(30)	/* packet continues in sw_next */
+#define CPDMA_DESC_SW_MAPPED	BIT(29)	/* buffer mapped by the caller */
+#define CPDMA_DESC_SW_LEN_MASK	0xffff
+
+/*
+ * Each channel keeps a small cache of free descriptors so that the per
+ * packet paths never touch the pool lock.  TX channels refill and trim the
+ * cache in batches; RX channels recycle one descriptor per completed buffer
+ * and use the whole RX half of the pool for posted buffers, so they must
+ * not hoard more than they need.
+ */
+#define CPDMA_DESC_CACHE_SIZE	16
+#define CPDMA_DESC_BATCH	8
+
+/* completed packets reaped per channel lock hold */
+#define CPDMA_REAP_BATCH	16
+
 struct cpdma_desc {
 	/* hardware fields */
 	u32			hw_next;
@@ -116,12 +135,18 @@ struct cpdma_chan {
 	int				count;
 	u32				mask;
 	cpdma_handler_fn		handler;
+	cpdma_batch_handler_fn		batch_handler;
 	enum dma_data_direction		dir;
 	struct cpdma_chan_stats		stats;
 	/* offsets into dmaregs */
 	int	int_set, int_clear, td;
+	/* free descriptors owned by this channel, under chan->lock */
+	struct cpdma_desc __iomem	*desc_cache[CPDMA_DESC_CACHE_SIZE];
+	int				desc_cached;
+	int				desc_batch;
 };
 
+
 /* The following make access to common cpdma_ctlr params more readable */
 #define dmaregs		params.dmaregs
 #define num_chan	params.num_chan
@@ -218,60 +243,101 @@ desc_from_phys(struct cpdma_desc_pool *pool, dma_addr_t dma)
 	return dma ? pool->iomap + dma - pool->hw_addr : NULL;
 }
 
-static struct cpdma_desc __iomem *
-cpdma_desc_alloc(struct cpdma_desc_pool *pool, int num_desc, bool is_rx)
+static int
+cpdma_desc_alloc(struct cpdma_desc_pool *pool,
+		 struct cpdma_desc __iomem **descs, int count, bool is_rx)
 {
 	unsigned long flags;
-	int index;
-	struct cpdma_desc __iomem *desc = NULL;
+	int index, n;
 	static int last_index = 4096;
 
 	spin_lock_irqsave(&pool->lock, flags);
 
-	if (is_rx) {
-		index = bitmap_find_next_zero_area(pool->bitmap,
-				pool->num_desc/2, 0, num_desc, 0);
-	 } else {
-		if (last_index >= pool->num_desc)
-			last_index = pool->num_desc / 2;
-
-		index = bitmap_find_next_zero_area(pool->bitmap,
-				pool->num_desc, last_index, num_desc, 0);
+	for (n = 0; n < count; n++) {
+		if (is_rx) {
+			index = bitmap_find_next_zero_area(pool->bitmap,
+					pool->num_desc/2, 0, 1, 0);
+			if (!(index < pool->num_desc/2))
+				break;
+		} else {
+			if (last_index >= pool->num_desc)
+				last_index = pool->num_desc / 2;
 
-		if (!(index < pool->num_desc)) {
 			index = bitmap_find_next_zero_area(pool->bitmap,
-				pool->num_desc, pool->num_desc/2, num_desc, 0);
-		}
+					pool->num_desc, last_index, 1, 0);
 
-		if (index < pool->num_desc)
-			last_index = index + 1;
-		else
-			last_index = pool->num_desc / 2;
-	}
+			if (!(index < pool->num_desc)) {
+				index = bitmap_find_next_zero_area(pool->bitmap,
+					pool->num_desc, pool->num_desc/2, 1, 0);
+			}
+
+			if (index < pool->num_desc) {
+				last_index = index + 1;
+			} else {
+				last_index = pool->num_desc / 2;
+				break;
+			}
+		}
 
-	if (index < pool->num_desc) {
-		bitmap_set(pool->bitmap, index, num_desc);
-		desc = pool->iomap + pool->desc_size * index;
+		bitmap_set(pool->bitmap, index, 1);
+		descs[n] = pool->iomap + pool->desc_size * index;
 		pool->used_desc++;
 	}
 
 	spin_unlock_irqrestore(&pool->lock, flags);
-	return desc;
+	return n;
 }
 
 static void cpdma_desc_free(struct cpdma_desc_pool *pool,
-			    struct cpdma_desc __iomem *desc, int num_desc)
+			    struct cpdma_desc __iomem **descs, int count)
 {
 	unsigned long flags, index;
+	int n;
 
-	index = ((unsigned long)desc - (unsigned long)pool->iomap) /
-		pool->desc_size;
 	spin_lock_irqsave(&pool->lock, flags);
-	bitmap_clear(pool->bitmap, index, num_desc);
-	pool->used_desc--;
+	for (n = 0; n < count; n++) {
+		index = ((unsigned long)descs[n] -
+			 (unsigned long)pool->iomap) / pool->desc_size;
+		bitmap_clear(pool->bitmap, index, 1);
+		pool->used_desc--;
+	}
 	spin_unlock_irqrestore(&pool->lock, flags);
 }
 
+/* get a free descriptor from the channel cache, chan->lock held */
+static struct cpdma_desc __iomem *cpdma_chan_desc_get(struct cpdma_chan *chan)
+{
+	if (!chan->desc_cached)
+		chan->desc_cached = cpdma_desc_alloc(chan->ctlr->pool,
+						     chan->desc_cache,
+						     chan->desc_batch,
+						     chan->rxfree != 0);
+	if (!chan->desc_cached)
+		return NULL;
+	return chan->desc_cache[--chan->desc_cached];
+}
+
+/* return a descriptor to the channel cache, chan->lock held */
+static void cpdma_chan_desc_put(struct cpdma_chan *chan,
+				struct cpdma_desc __iomem *desc)
+{
+	if (chan->desc_cached == CPDMA_DESC_CACHE_SIZE) {
+		chan->desc_cached -= CPDMA_DESC_BATCH;
+		cpdma_desc_free(chan->ctlr->pool,
+				&chan->desc_cache[chan->desc_cached],
+				CPDMA_DESC_BATCH);
+	}
+	chan->desc_cache[chan->desc_cached++] = desc;
+}
+
+/* give every cached descriptor back to the pool, chan->lock held */
+static void cpdma_chan_desc_flush(struct cpdma_chan *chan)
+{
+	cpdma_desc_free(chan->ctlr->pool, chan->desc_cache,
+			chan->desc_cached);
+	chan->desc_cached = 0;
+}
+
 struct cpdma_ctlr *cpdma_ctlr_create(struct cpdma_params *params)
 {
 	struct cpdma_ctlr *ctlr;
@@ -552,6 +618,7 @@ struct cpdma_chan *cpdma_chan_create(struct cpdma_ctlr *ctlr, int chan_num,
 		chan->dir	= DMA_TO_DEVICE;
 	}
 	chan->mask = BIT(chan_linear(chan));
+	chan->desc_batch = chan->rxfree ? 1 : CPDMA_DESC_BATCH;
 
 	spin_lock_init(&chan->lock);
 
@@ -578,6 +645,7 @@ int cpdma_chan_destroy(struct cpdma_chan *chan)
 	spin_lock_irqsave(&ctlr->lock, flags);
 	if (chan->state != CPDMA_STATE_IDLE)
 		cpdma_chan_stop(chan);
+	cpdma_chan_desc_flush(chan);
 	ctlr->channels[chan->chan_num] = NULL;
 	spin_unlock_irqrestore(&ctlr->lock, flags);
 	kfree(chan);
@@ -598,6 +666,25 @@ int cpdma_chan_get_stats(struct cpdma_chan *chan,
 }
 EXPORT_SYMBOL(cpdma_chan_get_stats);
 
+/*
+ * Have cpdma_chan_process() hand each reaped run of completed packets to
+ * handler in one call instead of calling the per packet handler.  The
+ * per packet handler is still used for teardown.
+ */
+int cpdma_chan_set_batch_handler(struct cpdma_chan *chan,
+				 cpdma_batch_handler_fn handler)
+{
+	unsigned long flags;
+
+	if (!chan)
+		return -EINVAL;
+	spin_lock_irqsave(&chan->lock, flags);
+	chan->batch_handler = handler;
+	spin_unlock_irqrestore(&chan->lock, flags);
+	return 0;
+}
+EXPORT_SYMBOL(cpdma_chan_set_batch_handler);
+
 int cpdma_chan_dump(struct cpdma_chan *chan)
 {
 	unsigned long flags;
@@ -647,7 +734,8 @@ int cpdma_chan_dump(struct cpdma_chan *chan)
 }
 
 static void __cpdma_chan_submit(struct cpdma_chan *chan,
-				struct cpdma_desc __iomem *desc)
+				struct cpdma_desc __iomem *first,
+				struct cpdma_desc __iomem *last)
 {
 	struct cpdma_ctlr		*ctlr = chan->ctlr;
 	struct cpdma_desc __iomem	*prev = chan->tail;
@@ -655,13 +743,13 @@ static void __cpdma_chan_submit(struct cpdma_chan *chan,
 	dma_addr_t			desc_dma;
 	u32				mode;
 
-	desc_dma = desc_phys(pool, desc);
+	desc_dma = desc_phys(pool, first);
 
 	/* simple case - idle channel */
 	if (!chan->head) {
 		chan->stats.head_enqueue++;
-		chan->head = desc;
-		chan->tail = desc;
+		chan->head = first;
+		chan->tail = last;
 		if (chan->state == CPDMA_STATE_ACTIVE)
 			chan_write(chan, hdp, desc_dma);
 		return;
@@ -670,7 +758,7 @@ static void __cpdma_chan_submit(struct cpdma_chan *chan,
 	/* first chain the descriptor at the tail of the list */
 	desc_write(prev, hw_next, desc_dma);
 	desc_write(prev, sw_next, desc_dma);
-	chan->tail = desc;
+	chan->tail = last;
 	chan->stats.tail_enqueue++;
 
 	/* next check if EOQ has been triggered already */
@@ -683,14 +771,14 @@ static void __cpdma_chan_submit(struct cpdma_chan *chan,
 	}
 }
 
-int cpdma_chan_submit(struct cpdma_chan *chan, void *token, void *data,
-		      int len, int directed, gfp_t gfp_mask)
+static int cpdma_chan_submit_one(struct cpdma_chan *chan, void *token,
+				 void *data, dma_addr_t buffer, int len,
+				 int directed)
 {
 	struct cpdma_ctlr		*ctlr = chan->ctlr;
 	struct cpdma_desc __iomem	*desc;
-	dma_addr_t			buffer;
 	unsigned long			flags;
-	u32				mode;
+	u32				mode, sw_flags = 0;
 	int				ret = 0;
 	bool                            is_rx;
 
@@ -702,7 +790,7 @@ int cpdma_chan_submit(struct cpdma_chan *chan, void *token, void *data,
 	}
 
 	is_rx = (chan->rxfree != 0);
-	desc = cpdma_desc_alloc(ctlr->pool, 1, is_rx);
+	desc = cpdma_chan_desc_get(chan);
 	if (!desc) {
 		chan->stats.desc_alloc_fail++;
 		ret = -ENOMEM;
@@ -714,7 +802,11 @@ int cpdma_chan_submit(struct cpdma_chan *chan, void *token, void *data,
 		chan->stats.runt_transmit_buff++;
 	}
 
-	buffer = dma_map_single(ctlr->dev, data, len, chan->dir);
+	if (data)
+		buffer = dma_map_single(ctlr->dev, data, len, chan->dir);
+	else
+		sw_flags = CPDMA_DESC_SW_MAPPED;
+
 	mode = CPDMA_DESC_OWNER | CPDMA_DESC_SOP | CPDMA_DESC_EOP;
 	if ((!is_rx) && ((directed == 1) || (directed == 2)))
 		mode |= (CPDMA_DESC_TO_PORT_EN | (directed << 16));
@@ -726,9 +818,9 @@ int cpdma_chan_submit(struct cpdma_chan *chan, void *token, void *data,
 	desc_write(desc, hw_mode,   mode | len);
 	desc_write(desc, sw_token,  token);
 	desc_write(desc, sw_buffer, buffer);
-	desc_write(desc, sw_len,    len);
+	desc_write(desc, sw_len,    len | sw_flags);
 
-	__cpdma_chan_submit(chan, desc);
+	__cpdma_chan_submit(chan, desc, desc);
 
 	if (chan->state == CPDMA_STATE_ACTIVE && chan->rxfree)
 		chan_write(chan, rxfree, 1);
@@ -739,97 +831,355 @@ unlock_ret:
 	spin_unlock_irqrestore(&chan->lock, flags);
 	return ret;
 }
+
+int cpdma_chan_submit(struct cpdma_chan *chan, void *token, void *data,
+		      int len, int directed, gfp_t gfp_mask)
+{
+	return cpdma_chan_submit_one(chan, token, data, 0, len, directed);
+}
 EXPORT_SYMBOL(cpdma_chan_submit);
 
-static void __cpdma_chan_free(struct cpdma_chan *chan,
-			      struct cpdma_desc __iomem *desc,
-			      int outlen, int status)
+/*
+ * Queue a buffer that the caller has already mapped (and synced) for the
+ * device.  The buffer is left mapped on completion, so that drivers can
+ * keep a pool of long-lived DMA buffers instead of remapping every packet.
+ */
+int cpdma_chan_submit_mapped(struct cpdma_chan *chan, void *token,
+			     dma_addr_t buffer, int len, int directed,
+			     gfp_t gfp_mask)
+{
+	return cpdma_chan_submit_one(chan, token, NULL, buffer, len, directed);
+}
+EXPORT_SYMBOL(cpdma_chan_submit_mapped);
+
+/*
+ * Queue several caller-mapped single buffer packets at once.  The
+ * descriptors are chained up front and appended to the channel with a
+ * single tail link (and a single rxfree update on RX channels).
+ *
+ * Returns the number of buffers queued, which is less than count if the
+ * descriptors ran out, or a negative error code.
+ */
+int cpdma_chan_submit_mapped_batch(struct cpdma_chan *chan,
+				   struct cpdma_buf *bufs, int count,
+				   int directed)
 {
 	struct cpdma_ctlr		*ctlr = chan->ctlr;
 	struct cpdma_desc_pool		*pool = ctlr->pool;
-	dma_addr_t			buff_dma;
-	int				origlen;
-	void				*token;
+	struct cpdma_desc __iomem	*first = NULL, *prev = NULL, *desc;
+	dma_addr_t			desc_dma;
+	unsigned long			flags;
+	u32				mode;
+	int				n, len;
+	bool				is_rx;
+
+	spin_lock_irqsave(&chan->lock, flags);
+
+	if (chan->state == CPDMA_STATE_TEARDOWN) {
+		spin_unlock_irqrestore(&chan->lock, flags);
+		return -EINVAL;
+	}
 
-	token      = (void *)desc_read(desc, sw_token);
-	buff_dma   = desc_read(desc, sw_buffer);
-	origlen    = desc_read(desc, sw_len);
+	is_rx = (chan->rxfree != 0);
+	mode = CPDMA_DESC_OWNER | CPDMA_DESC_SOP | CPDMA_DESC_EOP;
+	if ((!is_rx) && ((directed == 1) || (directed == 2)))
+		mode |= (CPDMA_DESC_TO_PORT_EN | (directed << 16));
+
+	for (n = 0; n < count; n++) {
+		desc = cpdma_chan_desc_get(chan);
+		if (!desc) {
+			chan->stats.desc_alloc_fail++;
+			break;
+		}
 
-	dma_unmap_single(ctlr->dev, buff_dma, origlen, chan->dir);
-	cpdma_desc_free(pool, desc, 1);
+		len = bufs[n].len;
+		if (len < ctlr->params.min_packet_size) {
+			len = ctlr->params.min_packet_size;
+			chan->stats.runt_transmit_buff++;
+		}
 
-	(*chan->handler)(token, outlen, status);
+		desc_write(desc, hw_next,   0);
+		desc_write(desc, sw_next,   0);
+		desc_write(desc, hw_buffer, bufs[n].dma);
+		desc_write(desc, hw_len,    len);
+		desc_write(desc, hw_mode,   mode | len);
+		desc_write(desc, sw_token,  bufs[n].token);
+		desc_write(desc, sw_buffer, bufs[n].dma);
+		desc_write(desc, sw_len,    len | CPDMA_DESC_SW_MAPPED);
+
+		if (prev) {
+			desc_dma = desc_phys(pool, desc);
+			desc_write(prev, hw_next, desc_dma);
+			desc_write(prev, sw_next, desc_dma);
+		} else {
+			first = desc;
+		}
+		prev = desc;
+	}
+
+	if (n) {
+		__cpdma_chan_submit(chan, first, prev);
+
+		if (chan->state == CPDMA_STATE_ACTIVE && chan->rxfree)
+			chan_write(chan, rxfree, n);
+
+		chan->count += n;
+	}
+
+	spin_unlock_irqrestore(&chan->lock, flags);
+	return n;
+}
+EXPORT_SYMBOL(cpdma_chan_submit_mapped_batch);
+
+static void cpdma_desc_unmap(struct cpdma_chan *chan,
+			     struct cpdma_desc __iomem *desc)
+{
+	struct cpdma_ctlr	*ctlr = chan->ctlr;
+	dma_addr_t		buff_dma;
+	u32			sw_len;
+
+	buff_dma = desc_read(desc, sw_buffer);
+	sw_len   = desc_read(desc, sw_len);
+
+	if (sw_len & CPDMA_DESC_SW_MAPPED)
+		return;
+
+	if (sw_len & CPDMA_DESC_SW_PAGE)
+		dma_unmap_page(ctlr->dev, buff_dma,
+			       sw_len & CPDMA_DESC_SW_LEN_MASK, chan->dir);
+	else
+		dma_unmap_single(ctlr->dev, buff_dma,
+				 sw_len & CPDMA_DESC_SW_LEN_MASK, chan->dir);
+}
+
+/*
+ * Returns the last (EOP) descriptor of the packet that starts at desc.  Only
+ * chains built by cpdma_chan_submit_sg() span more than one descriptor.
+ */
+static struct cpdma_desc __iomem *
+cpdma_desc_last(struct cpdma_desc_pool *pool, struct cpdma_desc __iomem *desc)
+{
+	while (desc_read(desc, sw_len) & CPDMA_DESC_SW_MORE)
+		desc = desc_from_phys(pool, desc_read(desc, sw_next));
+	return desc;
 }
 
-static int __cpdma_chan_process(struct cpdma_chan *chan)
+/*
+ * Queue one packet spread over several buffers.  Each fragment gets its own
+ * descriptor; only the first carries SOP, OWNER and the packet length, the
+ * last one carries EOP.  The completion handler is called once per packet
+ * with the token, after every fragment has been unmapped.  The caller pads
+ * runt packets; shorter than min_packet_size ones are refused.
+ */
+int cpdma_chan_submit_sg(struct cpdma_chan *chan, void *token,
+			 struct cpdma_frag *frags, int nr_frags,
+			 int directed, gfp_t gfp_mask)
 {
 	struct cpdma_ctlr		*ctlr = chan->ctlr;
-	struct cpdma_desc __iomem	*desc;
-	u32				status, outlen;
 	struct cpdma_desc_pool		*pool = ctlr->pool;
-	dma_addr_t			desc_dma;
+	struct cpdma_desc __iomem	*first = NULL, *prev = NULL, *desc;
+	dma_addr_t			buffer, desc_dma;
 	unsigned long			flags;
+	u32				mode;
+	int				i, len, pkt_len = 0, ret = 0;
+
+	if (is_rx_chan(chan) || nr_frags < 1)
+		return -EINVAL;
+
+	for (i = 0; i < nr_frags; i++)
+		pkt_len += frags[i].len;
 
 	spin_lock_irqsave(&chan->lock, flags);
 
-	desc = chan->head;
-	if (!desc) {
-		chan->stats.empty_dequeue++;
-		status = -ENOENT;
+	if (chan->state == CPDMA_STATE_TEARDOWN) {
+		ret = -EINVAL;
 		goto unlock_ret;
 	}
-	desc_dma = desc_phys(pool, desc);
-
-	status	= __raw_readl(&desc->hw_mode);
-
-        /* In order to receive Jumbo Frames we need to AND by more
-           than 0x7FF (2047). The new value of 0x3FFF allows for up to
-           16383 sized reads from the descriptor
-        */
-        outlen =  status & 0x3fff;
-        // outlen = status & 0xEFF;
-	if (status & CPDMA_DESC_OWNER) {
-		chan->stats.busy_dequeue++;
-		status = -EBUSY;
+
+	/* the fragments may end at a page boundary, so they are never padded */
+	if (pkt_len < ctlr->params.min_packet_size) {
+		chan->stats.runt_transmit_buff++;
+		ret = -EINVAL;
 		goto unlock_ret;
 	}
 
-	status	= status & (CPDMA_DESC_EOQ | CPDMA_DESC_TD_COMPLETE |
-				CPDMA_DESC_PORT_MASK);
+	for (i = 0; i < nr_frags; i++) {
+		desc = cpdma_chan_desc_get(chan);
+		if (!desc) {
+			chan->stats.desc_alloc_fail++;
+			ret = -ENOMEM;
+			goto unwind;
+		}
 
-	chan->head = desc_from_phys(pool, desc_read(desc, sw_next));
-	chan_write(chan, cp, desc_dma);
-	chan->count--;
-	chan->stats.good_dequeue++;
+		len = frags[i].len;
+		buffer = dma_map_page(ctlr->dev, frags[i].page,
+				      frags[i].offset, len, chan->dir);
 
-	if ((status & CPDMA_DESC_EOQ) && (chan->head) &&
-			(!(status & CPDMA_DESC_TD_COMPLETE))) {
-		chan->stats.requeue++;
-		chan_write(chan, hdp, desc_phys(pool, chan->head));
+		mode = 0;
+		if (i == 0) {
+			mode = CPDMA_DESC_OWNER | CPDMA_DESC_SOP | pkt_len;
+			if ((directed == 1) || (directed == 2))
+				mode |= (CPDMA_DESC_TO_PORT_EN |
+					 (directed << 16));
+		}
+		if (i == nr_frags - 1)
+			mode |= CPDMA_DESC_EOP;
+
+		desc_write(desc, hw_next,   0);
+		desc_write(desc, sw_next,   0);
+		desc_write(desc, hw_buffer, buffer);
+		desc_write(desc, hw_len,    len);
+		desc_write(desc, hw_mode,   mode);
+		desc_write(desc, sw_token,  i ? NULL : token);
+		desc_write(desc, sw_buffer, buffer);
+		desc_write(desc, sw_len,    len | CPDMA_DESC_SW_PAGE);
+
+		if (prev) {
+			desc_dma = desc_phys(pool, desc);
+			desc_write(prev, hw_next, desc_dma);
+			desc_write(prev, sw_next, desc_dma);
+			desc_write(prev, sw_len,
+				   desc_read(prev, sw_len) | CPDMA_DESC_SW_MORE);
+		} else {
+			first = desc;
+		}
+		prev = desc;
 	}
 
-	spin_unlock_irqrestore(&chan->lock, flags);
-
-	__cpdma_chan_free(chan, desc, outlen, (int)status);
-	return status;
+	__cpdma_chan_submit(chan, first, prev);
+	chan->count++;
 
 unlock_ret:
 	spin_unlock_irqrestore(&chan->lock, flags);
-	return status;
+	return ret;
+
+unwind:
+	while (first) {
+		desc = first;
+		first = desc_from_phys(pool, desc_read(desc, sw_next));
+		cpdma_desc_unmap(chan, desc);
+		cpdma_chan_desc_put(chan, desc);
+	}
+	goto unlock_ret;
+}
+EXPORT_SYMBOL(cpdma_chan_submit_sg);
+
+/*
+ * Unmap and release every descriptor of the packet starting at desc.
+ * Called with chan->lock held, returns the packet's token.
+ */
+static void *__cpdma_chan_free(struct cpdma_chan *chan,
+			       struct cpdma_desc __iomem *desc)
+{
+	struct cpdma_desc_pool		*pool = chan->ctlr->pool;
+	struct cpdma_desc __iomem	*next;
+	void				*token;
+	u32				more;
+
+	token = (void *)desc_read(desc, sw_token);
+
+	do {
+		more = desc_read(desc, sw_len) & CPDMA_DESC_SW_MORE;
+		next = desc_from_phys(pool, desc_read(desc, sw_next));
+		cpdma_desc_unmap(chan, desc);
+		cpdma_chan_desc_put(chan, desc);
+		desc = next;
+	} while (more && desc);
+
+	return token;
+}
+
+/*
+ * Detach up to quota completed packets from the head of the channel and
+ * release their descriptors.  The whole run is acknowledged with a single
+ * completion pointer write for its last packet.  Called with chan->lock
+ * held; the handlers are run by the caller once the lock is dropped.
+ */
+static int __cpdma_chan_reap(struct cpdma_chan *chan, struct cpdma_done *done,
+			     int quota)
+{
+	struct cpdma_desc_pool		*pool = chan->ctlr->pool;
+	struct cpdma_desc __iomem	*desc, *last, *ack = NULL;
+	u32				status;
+	int				count = 0;
+
+	while (count < quota) {
+		desc = chan->head;
+		if (!desc) {
+			chan->stats.empty_dequeue++;
+			break;
+		}
+
+		status	= __raw_readl(&desc->hw_mode);
+		if (status & CPDMA_DESC_OWNER) {
+			chan->stats.busy_dequeue++;
+			break;
+		}
+
+		/* EOQ is reported in the EOP descriptor of a chained packet */
+		last = cpdma_desc_last(pool, desc);
+		if (last != desc)
+			status = (status & ~CPDMA_DESC_EOQ) |
+				 (desc_read(last, hw_mode) & CPDMA_DESC_EOQ);
+
+		chan->head = desc_from_phys(pool, desc_read(last, sw_next));
+		ack = desc;
+		chan->count--;
+		chan->stats.good_dequeue++;
+
+		if ((status & CPDMA_DESC_EOQ) && (chan->head) &&
+				(!(status & CPDMA_DESC_TD_COMPLETE))) {
+			chan->stats.requeue++;
+			chan_write(chan, hdp, desc_phys(pool, chan->head));
+		}
+
+		/* In order to receive Jumbo Frames we need to AND by more
+		   than 0x7FF (2047). The new value of 0x3FFF allows for up to
+		   16383 sized reads from the descriptor
+		*/
+		done[count].len = status & 0x3fff;
+		done[count].status = status & (CPDMA_DESC_EOQ |
+					       CPDMA_DESC_TD_COMPLETE |
+					       CPDMA_DESC_PORT_MASK);
+		done[count].token = __cpdma_chan_free(chan, desc);
+		count++;
+
+		if (status & CPDMA_DESC_TD_COMPLETE)
+			break;
+	}
+
+	if (ack)
+		chan_write(chan, cp, desc_phys(pool, ack));
+	return count;
 }
 
 int cpdma_chan_process(struct cpdma_chan *chan, int quota)
 {
-	int used = 0, ret = 0;
+	struct cpdma_done	done[CPDMA_REAP_BATCH];
+	unsigned long		flags;
+	int			used = 0, count, want, i;
 
 	if (chan->state != CPDMA_STATE_ACTIVE)
 		return -EINVAL;
 
 	while (used < quota) {
-		ret = __cpdma_chan_process(chan);
-		if (ret < 0)
+		want = min(quota - used, CPDMA_REAP_BATCH);
+
+		spin_lock_irqsave(&chan->lock, flags);
+		count = __cpdma_chan_reap(chan, done, want);
+		spin_unlock_irqrestore(&chan->lock, flags);
+
+		/* issue callbacks without locks held */
+		if (chan->batch_handler && count)
+			(*chan->batch_handler)(done, count);
+		else
+			for (i = 0; i < count; i++)
+				(*chan->handler)(done[i].token, done[i].len,
+						 done[i].status);
+
+		used += count;
+		if (count < want)
 			break;
-		used++;
 	}
 	return used;
 }
@@ -867,8 +1217,9 @@ int cpdma_chan_stop(struct cpdma_chan *chan)
 {
 	struct cpdma_ctlr	*ctlr = chan->ctlr;
 	struct cpdma_desc_pool	*pool = ctlr->pool;
+	struct cpdma_done	done;
 	unsigned long		flags;
-	int			ret;
+	int			count;
 	unsigned long		timeout;
 
 	spin_lock_irqsave(&chan->lock, flags);
@@ -898,27 +1249,33 @@ int cpdma_chan_stop(struct cpdma_chan *chan)
 
 	/* handle completed packets */
 	do {
-		ret = __cpdma_chan_process(chan);
-		if (ret < 0)
+		spin_lock_irqsave(&chan->lock, flags);
+		count = __cpdma_chan_reap(chan, &done, 1);
+		spin_unlock_irqrestore(&chan->lock, flags);
+		if (!count)
 			break;
-	} while ((ret & CPDMA_DESC_TD_COMPLETE) == 0);
+		(*chan->handler)(done.token, done.len, done.status);
+	} while ((done.status & CPDMA_DESC_TD_COMPLETE) == 0);
 
 	/* remaining packets haven't been tx/rx'ed, clean them up */
 	spin_lock_irqsave(&chan->lock, flags);
 	while (chan->head) {
 		struct cpdma_desc __iomem *desc = chan->head;
 		dma_addr_t next_dma;
+		void *token;
 
-		next_dma = desc_read(desc, hw_next);
+		next_dma = desc_read(cpdma_desc_last(pool, desc), hw_next);
 		chan->head = desc_from_phys(pool, next_dma);
 		chan->stats.teardown_dequeue++;
+		token = __cpdma_chan_free(chan, desc);
 
 		/* issue callback without locks held */
 		spin_unlock_irqrestore(&chan->lock, flags);
-		__cpdma_chan_free(chan, desc, 0, -ENOSYS);
+		(*chan->handler)(token, 0, -ENOSYS);
 		spin_lock_irqsave(&chan->lock, flags);
 	}
 
+	cpdma_chan_desc_flush(chan);
 	chan->state = CPDMA_STATE_IDLE;
 	spin_unlock_irqrestore(&chan->lock, flags);
 	return 0;
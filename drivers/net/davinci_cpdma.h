@@ -70,6 +70,29 @@ struct cpdma_chan;
 
 typedef void (*cpdma_handler_fn)(void *token, int len, int status);
 
+/* one completed packet, as passed to a cpdma_batch_handler_fn */
+struct cpdma_done {
+	void			*token;
+	int			len;
+	int			status;
+};
+
+typedef void (*cpdma_batch_handler_fn)(struct cpdma_done *done, int count);
+
+/* one caller-mapped packet, see cpdma_chan_submit_mapped_batch() */
+struct cpdma_buf {
+	void			*token;
+	dma_addr_t		dma;
+	int			len;
+};
+
+/* one buffer of a multi-descriptor packet, see cpdma_chan_submit_sg() */
+struct cpdma_frag {
+	struct page		*page;
+	unsigned int		offset;
+	int			len;
+};
+
 struct cpdma_ctlr *cpdma_ctlr_create(struct cpdma_params *params);
 int cpdma_ctlr_destroy(struct cpdma_ctlr *ctlr);
 int cpdma_ctlr_start(struct cpdma_ctlr *ctlr);
@@ -82,11 +105,22 @@ int cpdma_chan_destroy(struct cpdma_chan *chan);
 int cpdma_chan_start(struct cpdma_chan *chan);
 int cpdma_chan_stop(struct cpdma_chan *chan);
 int cpdma_chan_dump(struct cpdma_chan *chan);
+int cpdma_chan_set_batch_handler(struct cpdma_chan *chan,
+				 cpdma_batch_handler_fn handler);
 
 int cpdma_chan_get_stats(struct cpdma_chan *chan,
 			 struct cpdma_chan_stats *stats);
 int cpdma_chan_submit(struct cpdma_chan *chan, void *token, void *data,
 		      int len, int directed, gfp_t gfp_mask);
+int cpdma_chan_submit_mapped(struct cpdma_chan *chan, void *token,
+			     dma_addr_t buffer, int len, int directed,
+			     gfp_t gfp_mask);
+int cpdma_chan_submit_mapped_batch(struct cpdma_chan *chan,
+				   struct cpdma_buf *bufs, int count,
+				   int directed);
+int cpdma_chan_submit_sg(struct cpdma_chan *chan, void *token,
+			 struct cpdma_frag *frags, int nr_frags,
+			 int directed, gfp_t gfp_mask);
 int cpdma_chan_process(struct cpdma_chan *chan, int quota);
 
 int cpdma_ctlr_int_ctrl(struct cpdma_ctlr *ctlr, bool enable);
@@ -43,6 +43,7 @@
 #include <linux/init.h>
 #include <linux/netdevice.h>
 #include <linux/etherdevice.h>
+#include <linux/if_vlan.h>
 #include <linux/skbuff.h>
 #include <linux/ethtool.h>
 #include <linux/highmem.h>
@@ -58,6 +59,7 @@
 #include <linux/bitops.h>
 #include <linux/io.h>
 #include <linux/uaccess.h>
+#include <linux/pkt_sched.h>
 #include <linux/davinci_emac.h>
 
 #include <asm/irq.h>
@@ -69,6 +71,10 @@ static int debug_level;
 module_param(debug_level, int, 0);
 MODULE_PARM_DESC(debug_level, "DaVinci EMAC debug level (NETIF_MSG bits)");
 
+static int poll_bench;
+module_param(poll_bench, int, 0);
+MODULE_PARM_DESC(poll_bench, "Time NAPI poll, in CPU cycles per packet");
+
 /* /\* Netif debug messages possible *\/ */
 /* #define DAVINCI_EMAC_DEBUG	(NETIF_MSG_DRV | \ */
 /* 				NETIF_MSG_PROBE | \ */
@@ -118,9 +124,18 @@ static const char emac_version_string[] = "TI DaVinci EMAC Linux v6.1";
 #define EMAC_DEF_TX_CH			(0) /* Default 0th channel */
 #define EMAC_DEF_RX_CH			(0) /* Default 0th channel */
 #define EMAC_DEF_RX_NUM_DESC		(128)
-#define EMAC_DEF_MAX_TX_CH		(1) /* Max TX channels configured */
-#define EMAC_DEF_MAX_RX_CH		(1) /* Max RX channels configured */
+#define EMAC_DEF_MAX_TX_CH		(2) /* Max TX channels configured */
+#define EMAC_DEF_MAX_RX_CH		(2) /* Max RX channels configured */
+#define EMAC_CTRL_TX_CH			(1) /* Control traffic TX channel */
+#define EMAC_CTRL_RX_CH			(1) /* Unicast (control) RX channel */
+#define EMAC_CTRL_RX_NUM_DESC		(32) /* of EMAC_DEF_RX_NUM_DESC */
+#define EMAC_CTRL_RX_WEIGHT		(16) /* NAPI budget share */
 #define EMAC_POLL_WEIGHT		(64) /* Default NAPI poll weight */
+#define EMAC_RX_POOL_SIZE		(2 * EMAC_DEF_RX_NUM_DESC)
+#define EMAC_RX_COPYBREAK		(256) /* Copy frames up to this size */
+#define EMAC_RX_HDR_LEN			(128) /* Bytes pulled into skb head */
+#define EMAC_RX_REFILL_BATCH	16 /* RX buffers reposted per cpdma call */
+#define EMAC_BENCH_WINDOW	4096 /* packets per ns/pkts-per-irq sample */
 
 /* Buffer descriptor parameters */
 #define EMAC_DEF_TX_MAX_SERVICE		(32) /* TX max service BD's */
@@ -192,10 +207,14 @@ static const char emac_version_string[] = "TI DaVinci EMAC Linux v6.1";
 #define EMAC_DM644X_MAC_IN_VECTOR_STATPEND_INT	BIT(16)
 #define EMAC_DM644X_MAC_IN_VECTOR_RX_INT_VEC	BIT(8)
 #define EMAC_DM644X_MAC_IN_VECTOR_TX_INT_VEC	BIT(0)
+#define EMAC_DM644X_MAC_IN_VECTOR_RX_CH(ch)	BIT(8 + (ch))
+#define EMAC_DM644X_MAC_IN_VECTOR_TX_CH(ch)	BIT(ch)
 
 /** NOTE:: For DM646x the IN_VECTOR has changed */
 #define EMAC_DM646X_MAC_IN_VECTOR_RX_INT_VEC	BIT(EMAC_DEF_RX_CH)
 #define EMAC_DM646X_MAC_IN_VECTOR_TX_INT_VEC	BIT(16 + EMAC_DEF_TX_CH)
+#define EMAC_DM646X_MAC_IN_VECTOR_RX_CH(ch)	BIT(ch)
+#define EMAC_DM646X_MAC_IN_VECTOR_TX_CH(ch)	BIT(16 + (ch))
 #define EMAC_DM646X_MAC_IN_VECTOR_HOST_INT	BIT(26)
 #define EMAC_DM646X_MAC_IN_VECTOR_STATPEND_INT	BIT(27)
 
@@ -213,6 +232,10 @@ static const char emac_version_string[] = "TI DaVinci EMAC Linux v6.1";
 /* Max hardware defines */
 #define EMAC_MAX_TXRX_CHANNELS		 (8)  /* Max hardware channels */
 #define EMAC_DEF_MAX_MULTICAST_ADDRESSES (64) /* Max mcast addr's */
+#define EMAC_MCAST_EXACT_SLOTS		(8) /* groups in the address RAM */
+#define EMAC_MCAST_EXACT_BASE		(8) /* first MACINDEX used for them */
+#define EMAC_MCAST_REBALANCE_FRAMES	(8192) /* mcast frames per rebalance */
+#define EMAC_MCAST_NONE			(-1)
 
 /* EMAC Peripheral Device Register Memory Layout structure */
 #define EMAC_MACINVECTOR	0x90
@@ -245,6 +268,11 @@ static const char emac_version_string[] = "TI DaVinci EMAC Linux v6.1";
 #define EMAC_MACADDRHI		0x504
 #define EMAC_MACINDEX		0x508
 
+/* EMAC_MACADDRLO bit fields */
+#define EMAC_MACADDRLO_CHANNEL(ch)	(((ch) & 0x7) << 16)
+#define EMAC_MACADDRLO_MATCHFILT	BIT(19)
+#define EMAC_MACADDRLO_VALID		BIT(20)
+
 /* EMAC statistics registers */
 #define EMAC_RXGOODFRAMES	0x200
 #define EMAC_RXBCASTFRAMES	0x204
@@ -295,6 +323,8 @@ static const char emac_version_string[] = "TI DaVinci EMAC Linux v6.1";
 
 /* EMAC DM646X control module masks */
 #define EMAC_DM646X_INTPACEEN		(0x3 << 16)
+#define EMAC_DM646X_RXPACEEN		BIT(16)
+#define EMAC_DM646X_TXPACEEN		BIT(17)
 #define EMAC_DM646X_INTPRESCALE_MASK	(0x7FF << 0)
 #define EMAC_DM646X_CMINTMAX_CNT	63
 #define EMAC_DM646X_CMINTMIN_CNT	2
@@ -302,6 +332,16 @@ static const char emac_version_string[] = "TI DaVinci EMAC Linux v6.1";
 #define EMAC_DM646X_CMINTMIN_INTVL	((1000 / EMAC_DM646X_CMINTMAX_CNT) + 1)
 
 
+/* Adaptive interrupt coalescing */
+#define EMAC_COAL_PKTS_LOW		(2)  /* pkts/irq to step pacing down */
+#define EMAC_COAL_PKTS_HIGH		(16) /* pkts/irq to step pacing up */
+#define EMAC_COAL_HIST_BUCKETS		(9)  /* 0, 1, 2-3, ... 128+ pkts/irq */
+#define EMAC_COAL_STATIC		(0)
+#define EMAC_COAL_ADAPTIVE		(1)
+
+/* Pacing intervals (usecs) the adaptive mode steps through, 0 = no pacing */
+static const u32 emac_coal_levels[] = { 0, 16, 32, 64, 125, 250, 500 };
+
 /* EMAC EOI codes for C0 */
 #define EMAC_DM646X_MAC_EOI_C0_RXEN	(0x01)
 #define EMAC_DM646X_MAC_EOI_C0_TXEN	(0x02)
@@ -312,6 +352,63 @@ static const char emac_version_string[] = "TI DaVinci EMAC Linux v6.1";
 /* EMAC MAX number of IRQ lines */
 #define MAX_MODULE_IRQS 4
 
+struct emac_priv;
+
+/* emac_rx_slot: one RX descriptor's worth of buffer, the cpdma token */
+struct emac_rx_slot {
+	struct emac_priv *priv;
+	int ch; /* RX channel the slot is posted to */
+	struct page *page; /* DMA address kept in page_private() */
+};
+
+/* emac_rx_refill: RX slots waiting to be reposted to one channel */
+struct emac_rx_refill {
+	struct emac_rx_slot *slots[EMAC_DEF_RX_NUM_DESC];
+	int count;
+};
+
+/* emac_rx_pool: pre-mapped RX pages waiting for the stack to let go */
+struct emac_rx_pool {
+	struct page *ring[EMAC_RX_POOL_SIZE];
+	u32 head;
+	u32 count;
+	u32 order;
+	u32 hits; /* buffer reused without alloc/map */
+	u32 misses; /* oldest pooled page still held by the stack */
+	u32 refills; /* new page allocated and mapped */
+	u32 alloc_fail;
+	u32 copybreak; /* frame copied, page handed back directly */
+	u32 evictions; /* pool full of held pages, page not parked */
+};
+
+/* emac_mcast_group: one subscribed multicast address */
+struct emac_mcast_group {
+	u8 addr[ETH_ALEN];
+	u8 in_use;
+	u8 stale; /* missing from the list last handed down by the stack */
+	s8 slot; /* exact match slot, EMAC_MCAST_NONE while in the hash */
+	s8 next; /* next group on the same hash bit */
+	u32 hits; /* frames received, halved at every rebalance */
+};
+
+/* emac_mcast_filter: multicast hash and exact match slot bookkeeping */
+struct emac_mcast_filter {
+	struct emac_mcast_group group[EMAC_DEF_MAX_MULTICAST_ADDRESSES];
+	s8 bucket[EMAC_NUM_MULTICAST_BITS]; /* first group of each hash bit */
+	s8 slot[EMAC_MCAST_EXACT_SLOTS]; /* group held by each slot */
+	u32 nr_slots; /* exact match slots usable on this EMAC */
+	u32 all; /* accepting all multicast */
+	u32 frames; /* multicast frames since the last rebalance */
+	u32 count; /* subscribed groups */
+	u32 collisions; /* hashed groups sharing their bit with another */
+	u32 false_pos; /* multicast frames matching no group */
+	u32 exact_hits;
+	u32 hash_hits;
+	u32 hash_writes; /* MACHASH1/2 updates */
+	u32 slot_writes; /* address RAM entry updates */
+	u32 promotions; /* groups moved from the hash to a slot */
+};
+
 /* emac_priv: EMAC private data structure
  *
  * EMAC adapter private data structure
@@ -327,8 +424,9 @@ struct emac_priv {
 	void __iomem *emac_base;
 	void __iomem *ctrl_base;
 	struct cpdma_ctlr *dma;
-	struct cpdma_chan *txchan;
-	struct cpdma_chan *rxchan;
+	struct device *dma_dev; /* device CPDMA maps buffers for */
+	struct cpdma_chan *txchan[EMAC_DEF_MAX_TX_CH]; /* one per TX queue */
+	struct cpdma_chan *rxchan[EMAC_DEF_MAX_RX_CH];
 	u32 link; /* 1=link on, 0=link off */
 	u32 speed; /* 0=Auto Neg, 1=No PHY, 10,100, 1000 - mbps */
 	u32 duplex; /* Link duplex: 0=Half, 1=Full */
@@ -341,6 +439,9 @@ struct emac_priv {
 	u32 mac_hash1;
 	u32 mac_hash2;
 	u32 multicast_hash_cnt[EMAC_NUM_MULTICAST_BITS];
+	struct emac_mcast_filter mcast;
+	spinlock_t mcast_lock; /* mcast and address RAM, rx_mode/NAPI/work */
+	struct work_struct mcast_work; /* exact match slot rebalance */
 	u32 rx_addr_type;
 	const char *phy_id;
 	struct phy_device *phydev;
@@ -352,6 +453,23 @@ struct emac_priv {
 	u32 irqs_table[MAX_MODULE_IRQS];
 	u32 num_irqs;
 	u32 gigabit_en; /* Is gigabit capable AND enabled */
+	u8 coal_adaptive_rx;
+	u8 coal_adaptive_tx;
+	u32 coal_rx_level; /* index into emac_coal_levels */
+	u32 coal_tx_level;
+	u32 coal_rx_usecs; /* pacing currently programmed */
+	u32 coal_tx_usecs;
+	u32 irq_rx_pkts; /* packets handled since the last interrupt */
+	u32 irq_tx_pkts;
+	u32 coal_hist[2][EMAC_COAL_HIST_BUCKETS]; /* pkts/irq per mode */
+	struct emac_rx_slot rx_slots[EMAC_DEF_RX_NUM_DESC];
+	struct emac_rx_pool rx_pool;
+	struct emac_rx_refill rx_refill[EMAC_DEF_MAX_RX_CH];
+	u64 bench_cycles; /* cycles in emac_poll this window, poll_bench=1 */
+	u32 bench_pkts; /* packets this window */
+	u32 bench_irqs; /* interrupts this window */
+	u32 bench_cycles_per_pkt; /* last completed window */
+	u32 bench_pkts_per_irq_x100;
 };
 
 /* clock frequency for EMAC */
@@ -539,16 +657,237 @@ static int emac_get_coalesce(struct net_device *ndev,
 	struct emac_priv *priv = netdev_priv(ndev);
 
 	coal->rx_coalesce_usecs = priv->coal_intvl;
+	coal->use_adaptive_rx_coalesce = priv->coal_adaptive_rx;
+	coal->use_adaptive_tx_coalesce = priv->coal_adaptive_tx;
 	return 0;
 
 }
 
+/**
+ * emac_set_pacing : Program per-direction interrupt pacing
+ * @priv : The DaVinci EMAC private adapter structure
+ * @rx_intvl : RX pacing interval in usecs, 0 disables RX pacing
+ * @tx_intvl : TX pacing interval in usecs, 0 disables TX pacing
+ *
+ * Used by the adaptive coalescing mode, which only needs intervals within
+ * the range of the undilated 4us pacer pulse. DM644x has a single interval
+ * timer, so the longer of the two intervals is used there, and pacing is
+ * only turned off once both intervals are 0.
+ *
+ */
+static void emac_set_pacing(struct emac_priv *priv, u32 rx_intvl,
+			    u32 tx_intvl)
+{
+	u32 int_ctrl, prescale;
+
+	switch (priv->version) {
+	case EMAC_VERSION_2:
+		int_ctrl = emac_ctrl_read(EMAC_DM646X_CMINTCTRL);
+		int_ctrl &= ~(EMAC_DM646X_INTPACEEN |
+			      EMAC_DM646X_INTPRESCALE_MASK);
+		int_ctrl |= ((priv->bus_freq_mhz * 4) &
+			     EMAC_DM646X_INTPRESCALE_MASK);
+
+		if (rx_intvl) {
+			rx_intvl = clamp_t(u32, rx_intvl,
+					   EMAC_DM646X_CMINTMIN_INTVL,
+					   EMAC_DM646X_CMINTMAX_INTVL);
+			emac_ctrl_write(EMAC_DM646X_CMRXINTMAX,
+					1000 / rx_intvl);
+			int_ctrl |= EMAC_DM646X_RXPACEEN;
+		}
+		if (tx_intvl) {
+			tx_intvl = clamp_t(u32, tx_intvl,
+					   EMAC_DM646X_CMINTMIN_INTVL,
+					   EMAC_DM646X_CMINTMAX_INTVL);
+			emac_ctrl_write(EMAC_DM646X_CMTXINTMAX,
+					1000 / tx_intvl);
+			int_ctrl |= EMAC_DM646X_TXPACEEN;
+		}
+		emac_ctrl_write(EMAC_DM646X_CMINTCTRL, int_ctrl);
+		break;
+	default:
+		int_ctrl = emac_ctrl_read(EMAC_CTRL_EWINTTCNT);
+		int_ctrl &= (~EMAC_DM644X_EWINTCNT_MASK);
+		prescale = max(rx_intvl, tx_intvl) * priv->bus_freq_mhz;
+		/* a zero count leaves the interrupt timer, and pacing, off */
+		if (prescale)
+			prescale = clamp_t(u32, prescale,
+					   EMAC_DM644X_INTMIN_INTVL,
+					   EMAC_DM644X_INTMAX_INTVL);
+		emac_ctrl_write(EMAC_CTRL_EWINTTCNT, (int_ctrl | prescale));
+		break;
+	}
+
+	priv->coal_rx_usecs = rx_intvl;
+	priv->coal_tx_usecs = tx_intvl;
+}
+
+/**
+ * emac_adapt_program : Program pacing for the current adaptive levels
+ * @priv : The DaVinci EMAC private adapter structure
+ *
+ * A direction that is not adaptive keeps the static interval
+ *
+ */
+static void emac_adapt_program(struct emac_priv *priv)
+{
+	u32 rx_intvl = priv->coal_intvl, tx_intvl = priv->coal_intvl;
+
+	if (priv->coal_adaptive_rx)
+		rx_intvl = emac_coal_levels[priv->coal_rx_level];
+	if (priv->coal_adaptive_tx)
+		tx_intvl = emac_coal_levels[priv->coal_tx_level];
+
+	emac_set_pacing(priv, rx_intvl, tx_intvl);
+}
+
+/**
+ * emac_adapt_level : Step one adaptive pacing level
+ * @level : current index into emac_coal_levels
+ * @pkts : packets handled for this direction
+ * @exhausted : the NAPI budget (or TX service quota) was used up
+ *
+ * Packets per interrupt at a given pacing interval track the packet rate:
+ * many packets (or a full budget) mean interrupts can be spaced further
+ * apart, one or two mean we are only adding latency.
+ *
+ * Returns true if the level changed
+ */
+static bool emac_adapt_level(u32 *level, u32 pkts, bool exhausted)
+{
+	u32 old = *level;
+
+	if (exhausted || pkts >= EMAC_COAL_PKTS_HIGH) {
+		if (*level < ARRAY_SIZE(emac_coal_levels) - 1)
+			(*level)++;
+	} else if (pkts <= EMAC_COAL_PKTS_LOW) {
+		if (*level)
+			(*level)--;
+	}
+
+	return *level != old;
+}
+
+/**
+ * emac_coal_update : Per NAPI cycle coalescing bookkeeping
+ * @priv : The DaVinci EMAC private adapter structure
+ * @tx_exhausted : TX completion hit EMAC_DEF_TX_MAX_SERVICE
+ * @rx_exhausted : RX processing used the whole NAPI budget
+ *
+ * Called from emac_poll() after the packets of this cycle have been added
+ * to irq_rx_pkts/irq_tx_pkts. On the last cycle of an interrupt (nothing
+ * exhausted) the packets per interrupt are recorded in the histogram of
+ * the active mode.
+ *
+ */
+static void emac_coal_update(struct emac_priv *priv, bool tx_exhausted,
+			     bool rx_exhausted)
+{
+	bool adaptive = priv->coal_adaptive_rx || priv->coal_adaptive_tx;
+	bool changed = false;
+	u32 pkts;
+
+	if (adaptive) {
+		if (priv->coal_adaptive_rx)
+			changed |= emac_adapt_level(&priv->coal_rx_level,
+						    priv->irq_rx_pkts,
+						    rx_exhausted);
+		if (priv->coal_adaptive_tx)
+			changed |= emac_adapt_level(&priv->coal_tx_level,
+						    priv->irq_tx_pkts,
+						    tx_exhausted);
+		if (changed)
+			emac_adapt_program(priv);
+	}
+
+	if (rx_exhausted || tx_exhausted)
+		return;
+
+	pkts = priv->irq_rx_pkts + priv->irq_tx_pkts;
+	priv->bench_irqs++;
+	priv->coal_hist[adaptive ? EMAC_COAL_ADAPTIVE : EMAC_COAL_STATIC]
+		       [min(fls(pkts), EMAC_COAL_HIST_BUCKETS - 1)]++;
+	priv->irq_rx_pkts = 0;
+	priv->irq_tx_pkts = 0;
+}
+
+/*
+ * CPU cycle counter for poll_bench.  sched_clock() only has jiffy
+ * resolution on TI81XX, far too coarse for a single poll, so the
+ * Cortex-A8 PMU cycle counter (PMCCNTR) is read directly.  Other cores
+ * fall back to get_cycles().
+ */
+static inline u32 emac_bench_cycles(void)
+{
+#ifdef CONFIG_CPU_V7
+	u32 cycles;
+
+	asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r" (cycles));
+	return cycles;
+#else
+	return get_cycles();
+#endif
+}
+
+/* enable and start the cycle counter read by emac_bench_cycles() */
+static void emac_bench_start(void)
+{
+#ifdef CONFIG_CPU_V7
+	u32 pmcr;
+
+	asm volatile("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+	/* E: enable the counters; D clear: count every cycle */
+	pmcr = (pmcr | BIT(0)) & ~BIT(3);
+	asm volatile("mcr p15, 0, %0, c9, c12, 0" : : "r" (pmcr));
+	/* PMCNTENSET.C */
+	asm volatile("mcr p15, 0, %0, c9, c12, 1" : : "r" (BIT(31)));
+#endif
+}
+
+/* start of a timed emac_poll, meaningful only with poll_bench set */
+static inline u32 emac_bench_read(struct emac_priv *priv)
+{
+	return poll_bench ? emac_bench_cycles() : 0;
+}
+
+/**
+ * emac_bench_update : Per NAPI cycle benchmark bookkeeping
+ * @priv : The DaVinci EMAC private adapter structure
+ * @start : emac_bench_read() at the start of the cycle
+ * @pkts : RX and TX packets handled in the cycle
+ *
+ * Every EMAC_BENCH_WINDOW packets the average poll cycles per packet (with
+ * poll_bench set) and packets per interrupt (in hundredths) are published
+ * in the ethtool statistics.
+ *
+ */
+static void emac_bench_update(struct emac_priv *priv, u32 start, int pkts)
+{
+	if (poll_bench)
+		priv->bench_cycles += (u32)(emac_bench_cycles() - start);
+	priv->bench_pkts += pkts;
+	if (priv->bench_pkts < EMAC_BENCH_WINDOW)
+		return;
+
+	priv->bench_cycles_per_pkt = div_u64(priv->bench_cycles,
+					     priv->bench_pkts);
+	priv->bench_cycles = 0;
+	if (priv->bench_irqs)
+		priv->bench_pkts_per_irq_x100 = priv->bench_pkts * 100 /
+						priv->bench_irqs;
+	priv->bench_pkts = 0;
+	priv->bench_irqs = 0;
+}
+
 /**
  * emac_set_coalesce : Set interrupt coalesce settings for this device
  * @ndev : The DaVinci EMAC network adapter
  * @coal : ethtool coalesce settings structure
  *
- * Set interrupt coalesce parameters
+ * Set interrupt coalesce parameters. With adaptive-rx/adaptive-tx the
+ * pacing is retuned from emac_poll() and rx_coalesce_usecs only applies
+ * to a direction left static.
  *
  */
 static int emac_set_coalesce(struct net_device *ndev,
@@ -558,6 +897,15 @@ static int emac_set_coalesce(struct net_device *ndev,
 	u32 int_ctrl, num_interrupts = 0;
 	u32 prescale = 0, addnl_dvdr = 1, coal_intvl = 0;
 
+	priv->coal_adaptive_rx = !!coal->use_adaptive_rx_coalesce;
+	priv->coal_adaptive_tx = !!coal->use_adaptive_tx_coalesce;
+
+	if (priv->coal_adaptive_rx || priv->coal_adaptive_tx) {
+		priv->coal_intvl = coal->rx_coalesce_usecs;
+		emac_adapt_program(priv);
+		return 0;
+	}
+
 	if (!coal->rx_coalesce_usecs)
 		return -EINVAL;
 
@@ -616,12 +964,114 @@ static int emac_set_coalesce(struct net_device *ndev,
 
 	printk(KERN_INFO"Set coalesce to %d usecs.\n", coal_intvl);
 	priv->coal_intvl = coal_intvl;
+	priv->coal_rx_usecs = coal_intvl;
+	priv->coal_tx_usecs = coal_intvl;
 
 	return 0;
 
 }
 
 
+/* EMAC driver statistics reported through ethtool -S */
+struct emac_stat {
+	char string[ETH_GSTRING_LEN];
+	int offset;
+};
+
+#define EMAC_STAT(name, member) \
+	{ name, offsetof(struct emac_priv, member) }
+
+#define EMAC_COAL_HIST_STATS(mode, m) \
+	EMAC_STAT("irq_pkts_" mode "_0", coal_hist[m][0]), \
+	EMAC_STAT("irq_pkts_" mode "_1", coal_hist[m][1]), \
+	EMAC_STAT("irq_pkts_" mode "_2_3", coal_hist[m][2]), \
+	EMAC_STAT("irq_pkts_" mode "_4_7", coal_hist[m][3]), \
+	EMAC_STAT("irq_pkts_" mode "_8_15", coal_hist[m][4]), \
+	EMAC_STAT("irq_pkts_" mode "_16_31", coal_hist[m][5]), \
+	EMAC_STAT("irq_pkts_" mode "_32_63", coal_hist[m][6]), \
+	EMAC_STAT("irq_pkts_" mode "_64_127", coal_hist[m][7]), \
+	EMAC_STAT("irq_pkts_" mode "_128_up", coal_hist[m][8])
+
+static const struct emac_stat emac_gstrings_stats[] = {
+	EMAC_STAT("rx_pool_hits", rx_pool.hits),
+	EMAC_STAT("rx_pool_misses", rx_pool.misses),
+	EMAC_STAT("rx_pool_refills", rx_pool.refills),
+	EMAC_STAT("rx_pool_alloc_fail", rx_pool.alloc_fail),
+	EMAC_STAT("rx_pool_copybreak", rx_pool.copybreak),
+	EMAC_STAT("rx_pool_evictions", rx_pool.evictions),
+	EMAC_STAT("coal_rx_usecs", coal_rx_usecs),
+	EMAC_STAT("coal_tx_usecs", coal_tx_usecs),
+	EMAC_STAT("mcast_groups", mcast.count),
+	EMAC_STAT("mcast_hash_collisions", mcast.collisions),
+	EMAC_STAT("mcast_false_positives", mcast.false_pos),
+	EMAC_STAT("mcast_exact_hits", mcast.exact_hits),
+	EMAC_STAT("mcast_hash_hits", mcast.hash_hits),
+	EMAC_STAT("mcast_hash_writes", mcast.hash_writes),
+	EMAC_STAT("mcast_slot_writes", mcast.slot_writes),
+	EMAC_STAT("mcast_promotions", mcast.promotions),
+	EMAC_STAT("bench_cycles_per_pkt", bench_cycles_per_pkt),
+	EMAC_STAT("bench_pkts_per_irq_x100", bench_pkts_per_irq_x100),
+	EMAC_COAL_HIST_STATS("static", EMAC_COAL_STATIC),
+	EMAC_COAL_HIST_STATS("adaptive", EMAC_COAL_ADAPTIVE),
+};
+
+#define EMAC_STATS_LEN	ARRAY_SIZE(emac_gstrings_stats)
+
+/**
+ * emac_get_sset_count: Get number of driver statistics
+ * @ndev: The DaVinci EMAC network adapter
+ * @sset: string set requested
+ *
+ * Returns the number of entries in the requested string set
+ *
+ */
+static int emac_get_sset_count(struct net_device *ndev, int sset)
+{
+	switch (sset) {
+	case ETH_SS_STATS:
+		return EMAC_STATS_LEN;
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+/**
+ * emac_get_strings: Get names of driver statistics
+ * @ndev: The DaVinci EMAC network adapter
+ * @stringset: string set requested
+ * @data: buffer for the names
+ *
+ */
+static void emac_get_strings(struct net_device *ndev, u32 stringset, u8 *data)
+{
+	int i;
+
+	if (stringset != ETH_SS_STATS)
+		return;
+
+	for (i = 0; i < EMAC_STATS_LEN; i++)
+		memcpy(data + i * ETH_GSTRING_LEN,
+		       emac_gstrings_stats[i].string, ETH_GSTRING_LEN);
+}
+
+/**
+ * emac_get_ethtool_stats: Get driver statistics
+ * @ndev: The DaVinci EMAC network adapter
+ * @stats: ethtool stats request
+ * @data: buffer for the values
+ *
+ */
+static void emac_get_ethtool_stats(struct net_device *ndev,
+				   struct ethtool_stats *stats, u64 *data)
+{
+	struct emac_priv *priv = netdev_priv(ndev);
+	int i;
+
+	for (i = 0; i < EMAC_STATS_LEN; i++)
+		data[i] = *(u32 *)((char *)priv +
+				   emac_gstrings_stats[i].offset);
+}
+
 /**
  * ethtool_ops: DaVinci EMAC Ethtool structure
  *
@@ -635,6 +1085,13 @@ static const struct ethtool_ops ethtool_ops = {
 	.get_link = ethtool_op_get_link,
 	.get_coalesce = emac_get_coalesce,
 	.set_coalesce =  emac_set_coalesce,
+	.get_sg = ethtool_op_get_sg,
+	.set_sg = ethtool_op_set_sg,
+	.get_tx_csum = ethtool_op_get_tx_csum,
+	.set_tx_csum = ethtool_op_set_tx_hw_csum,
+	.get_sset_count = emac_get_sset_count,
+	.get_strings = emac_get_strings,
+	.get_ethtool_stats = emac_get_ethtool_stats,
 };
 
 /**
@@ -692,14 +1149,13 @@ static void emac_update_phystatus(struct emac_priv *priv)
 		if (!netif_carrier_ok(ndev))
 			netif_carrier_on(ndev);
 	/* reactivate the transmit queue if it is stopped */
-		if (netif_running(ndev) && netif_queue_stopped(ndev))
-			netif_wake_queue(ndev);
+		if (netif_running(ndev))
+			netif_tx_wake_all_queues(ndev);
 	} else {
 		/* link OFF */
 		if (netif_carrier_ok(ndev))
 			netif_carrier_off(ndev);
-		if (!netif_queue_stopped(ndev))
-			netif_stop_queue(ndev);
+		netif_tx_stop_all_queues(ndev);
 	}
 }
 
@@ -754,6 +1210,8 @@ static int hash_add(struct emac_priv *priv, u8 *mac_addr)
 	}
 
 	/* set the hash bit only if not previously set */
+	if (priv->multicast_hash_cnt[hash_value] > 0)
+		priv->mcast.collisions++;
 	if (priv->multicast_hash_cnt[hash_value] == 0) {
 		rc = 1; /* hash value changed */
 		if (hash_value < 32) {
@@ -787,7 +1245,8 @@ static int hash_del(struct emac_priv *priv, u8 *mac_addr)
 	hash_value = hash_get(mac_addr);
 	if (priv->multicast_hash_cnt[hash_value] > 0) {
 		/* dec cntr for num of mcast addr's mapped to this hash bit */
-		--priv->multicast_hash_cnt[hash_value];
+		if (--priv->multicast_hash_cnt[hash_value] > 0)
+			priv->mcast.collisions--;
 	}
 
 	/* if counter still > 0, at least one multicast address refers
@@ -807,58 +1266,343 @@ static int hash_del(struct emac_priv *priv, u8 *mac_addr)
 	return 1;
 }
 
-/* EMAC multicast operation */
-#define EMAC_MULTICAST_ADD	0
-#define EMAC_MULTICAST_DEL	1
-#define EMAC_ALL_MULTI_SET	2
-#define EMAC_ALL_MULTI_CLR	3
+/**
+ * emac_mcast_write_hash: Write the multicast hash to the EMAC
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ */
+static void emac_mcast_write_hash(struct emac_priv *priv)
+{
+	emac_write(EMAC_MACHASH1, priv->mac_hash1);
+	emac_write(EMAC_MACHASH2, priv->mac_hash2);
+	priv->mcast.hash_writes++;
+}
 
 /**
- * emac_add_mcast: Set multicast address in the EMAC adapter (Internal)
+ * emac_mcast_slot_write: Program an exact match multicast slot
  * @priv: The DaVinci EMAC private adapter structure
- * @action: multicast operation to perform
- * mac_addr: mac address to set
+ * @slot: exact match slot
+ * @addr: multicast address to match, NULL to invalidate the slot
  *
- * Set multicast addresses in EMAC adapter - internal function
+ * Slots are type 2 address RAM entries routed to the multicast channel
  *
  */
-static void emac_add_mcast(struct emac_priv *priv, u32 action, u8 *mac_addr)
+static void emac_mcast_slot_write(struct emac_priv *priv, int slot, u8 *addr)
 {
-	struct device *emac_dev = &priv->ndev->dev;
-	int update = -1;
+	u32 val = 0;
+
+	emac_write(EMAC_MACINDEX, EMAC_MCAST_EXACT_BASE + slot);
+	if (addr) {
+		emac_write(EMAC_MACADDRHI, (addr[3] << 24) | (addr[2] << 16) |
+			   (addr[1] << 8) | addr[0]);
+		val = ((addr[5] << 8) | addr[4] |
+		       EMAC_MACADDRLO_CHANNEL(EMAC_DEF_MCAST_CH) |
+		       EMAC_MACADDRLO_MATCHFILT | EMAC_MACADDRLO_VALID);
+	} else {
+		emac_write(EMAC_MACADDRHI, 0);
+	}
+	emac_write(EMAC_MACADDRLO, val);
+	priv->mcast.slot_writes++;
+}
 
-	switch (action) {
-	case EMAC_MULTICAST_ADD:
-		update = hash_add(priv, mac_addr);
-		break;
-	case EMAC_MULTICAST_DEL:
-		update = hash_del(priv, mac_addr);
-		break;
-	case EMAC_ALL_MULTI_SET:
-		update = 1;
-		priv->mac_hash1 = EMAC_ALL_MULTI_REG_VALUE;
-		priv->mac_hash2 = EMAC_ALL_MULTI_REG_VALUE;
-		break;
-	case EMAC_ALL_MULTI_CLR:
-		update = 1;
-		priv->mac_hash1 = 0;
-		priv->mac_hash2 = 0;
-		memset(&(priv->multicast_hash_cnt[0]), 0,
-		sizeof(priv->multicast_hash_cnt[0]) *
-		       EMAC_NUM_MULTICAST_BITS);
-		break;
-	default:
-		if (netif_msg_drv(priv))
-			dev_err(emac_dev, "DaVinci EMAC: add_mcast"\
-				": bad operation %d", action);
-		break;
+/**
+ * emac_mcast_reset: Forget all multicast groups
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ * Clears the hash and every exact match slot, called once the EMAC has
+ * been reset and its address matching type is known
+ *
+ */
+static void emac_mcast_reset(struct emac_priv *priv)
+{
+	struct emac_mcast_filter *f = &priv->mcast;
+	int i;
+
+	spin_lock_bh(&priv->mcast_lock);
+	memset(f, 0, sizeof(*f));
+	memset(f->bucket, EMAC_MCAST_NONE, sizeof(f->bucket));
+	memset(f->slot, EMAC_MCAST_NONE, sizeof(f->slot));
+	memset(priv->multicast_hash_cnt, 0, sizeof(priv->multicast_hash_cnt));
+	f->nr_slots = (priv->rx_addr_type == 2) ? EMAC_MCAST_EXACT_SLOTS : 0;
+	for (i = 0; i < f->nr_slots; i++)
+		emac_mcast_slot_write(priv, i, NULL);
+
+	priv->mac_hash1 = 0;
+	priv->mac_hash2 = 0;
+	emac_mcast_write_hash(priv);
+	spin_unlock_bh(&priv->mcast_lock);
+}
+
+/**
+ * emac_mcast_find: Look up a subscribed multicast group
+ * @f: multicast filter
+ * @addr: multicast address
+ *
+ * Returns the group index or EMAC_MCAST_NONE
+ *
+ */
+static int emac_mcast_find(struct emac_mcast_filter *f, const u8 *addr)
+{
+	int i;
+
+	for (i = f->bucket[hash_get((u8 *)addr)]; i != EMAC_MCAST_NONE;
+	     i = f->group[i].next)
+		if (!compare_ether_addr(f->group[i].addr, addr))
+			return i;
+	return EMAC_MCAST_NONE;
+}
+
+/**
+ * emac_mcast_add: Subscribe a multicast group
+ * @priv: The DaVinci EMAC private adapter structure
+ * @addr: multicast address
+ *
+ * The group takes a free exact match slot if there is one, otherwise
+ * it goes into the hash
+ *
+ * Returns 1 if the hash registers need to be rewritten
+ *
+ */
+static int emac_mcast_add(struct emac_priv *priv, u8 *addr)
+{
+	struct emac_mcast_filter *f = &priv->mcast;
+	struct emac_mcast_group *g;
+	int i, s, hash_value = hash_get(addr);
+
+	for (i = 0; i < EMAC_DEF_MAX_MULTICAST_ADDRESSES; i++)
+		if (!f->group[i].in_use)
+			break;
+	if (i == EMAC_DEF_MAX_MULTICAST_ADDRESSES)
+		return 0;
+
+	g = &f->group[i];
+	memcpy(g->addr, addr, ETH_ALEN);
+	g->in_use = 1;
+	g->stale = 0;
+	g->hits = 0;
+	g->next = f->bucket[hash_value];
+	f->bucket[hash_value] = i;
+	f->count++;
+
+	for (s = 0; s < f->nr_slots; s++) {
+		if (f->slot[s] == EMAC_MCAST_NONE) {
+			g->slot = s;
+			f->slot[s] = i;
+			emac_mcast_slot_write(priv, s, addr);
+			return 0;
+		}
 	}
+	g->slot = EMAC_MCAST_NONE;
+	return hash_add(priv, addr) > 0;
+}
 
-	/* write to the hardware only if the register status chances */
-	if (update > 0) {
-		emac_write(EMAC_MACHASH1, priv->mac_hash1);
-		emac_write(EMAC_MACHASH2, priv->mac_hash2);
+/**
+ * emac_mcast_del: Unsubscribe a multicast group
+ * @priv: The DaVinci EMAC private adapter structure
+ * @i: group index
+ *
+ * Returns 1 if the hash registers need to be rewritten
+ *
+ */
+static int emac_mcast_del(struct emac_priv *priv, int i)
+{
+	struct emac_mcast_filter *f = &priv->mcast;
+	struct emac_mcast_group *g = &f->group[i];
+	s8 *pp = &f->bucket[hash_get(g->addr)];
+	int update = 0;
+
+	if (g->slot != EMAC_MCAST_NONE) {
+		emac_mcast_slot_write(priv, g->slot, NULL);
+		f->slot[g->slot] = EMAC_MCAST_NONE;
+	} else {
+		update = hash_del(priv, g->addr);
 	}
+
+	while (*pp != i)
+		pp = &f->group[*pp].next;
+	*pp = g->next;
+	g->in_use = 0;
+	f->count--;
+	return update;
+}
+
+/**
+ * emac_mcast_rebalance: Give the exact match slots to the busiest groups
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ * Hashed groups that received more frames than the coldest slotted group
+ * (or any hashed group, while a slot is free) swap places with it; a group
+ * is always matched by either its slot or its hash bit during the swap.
+ * Frame counts are halved so old traffic ages out.
+ *
+ * Returns 1 if the hash registers need to be rewritten
+ *
+ */
+static int emac_mcast_rebalance(struct emac_priv *priv)
+{
+	struct emac_mcast_filter *f = &priv->mcast;
+	struct emac_mcast_group *g;
+	int i, s, n, hot, cold, update = 0;
+	s64 cold_hits;
+
+	for (n = 0; n < EMAC_DEF_MAX_MULTICAST_ADDRESSES; n++) {
+		hot = EMAC_MCAST_NONE;
+		for (i = 0; i < EMAC_DEF_MAX_MULTICAST_ADDRESSES; i++) {
+			g = &f->group[i];
+			if (g->in_use && g->slot == EMAC_MCAST_NONE &&
+			    (hot == EMAC_MCAST_NONE ||
+			     g->hits > f->group[hot].hits))
+				hot = i;
+		}
+		if (hot == EMAC_MCAST_NONE)
+			break;
+
+		cold = EMAC_MCAST_NONE;
+		cold_hits = LLONG_MAX;
+		for (s = 0; s < f->nr_slots; s++) {
+			if (f->slot[s] == EMAC_MCAST_NONE) {
+				cold = s;
+				cold_hits = -1;
+				break;
+			}
+			if (f->group[f->slot[s]].hits < cold_hits) {
+				cold = s;
+				cold_hits = f->group[f->slot[s]].hits;
+			}
+		}
+		if (cold == EMAC_MCAST_NONE || f->group[hot].hits <= cold_hits)
+			break;
+
+		if (f->slot[cold] != EMAC_MCAST_NONE) {
+			g = &f->group[f->slot[cold]];
+			update |= hash_add(priv, g->addr) > 0;
+			g->slot = EMAC_MCAST_NONE;
+		}
+		g = &f->group[hot];
+		emac_mcast_slot_write(priv, cold, g->addr);
+		g->slot = cold;
+		f->slot[cold] = hot;
+		update |= hash_del(priv, g->addr);
+		f->promotions++;
+	}
+
+	for (i = 0; i < EMAC_DEF_MAX_MULTICAST_ADDRESSES; i++)
+		f->group[i].hits >>= 1;
+	f->frames = 0;
+	return update;
+}
+
+/**
+ * emac_mcast_sync: Bring the filter in line with the device's mc list
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ * Only groups that joined or left touch the hardware.  Groups that had to
+ * go into the hash are moved to free slots later, by mcast_work
+ *
+ * Returns 1 if the hash registers need to be rewritten
+ *
+ */
+static int emac_mcast_sync(struct emac_priv *priv)
+{
+	struct net_device *ndev = priv->ndev;
+	struct emac_mcast_filter *f = &priv->mcast;
+	struct netdev_hw_addr *ha;
+	int i, update = 0;
+
+	for (i = 0; i < EMAC_DEF_MAX_MULTICAST_ADDRESSES; i++)
+		f->group[i].stale = 1;
+	netdev_for_each_mc_addr(ha, ndev) {
+		i = emac_mcast_find(f, ha->addr);
+		if (i != EMAC_MCAST_NONE)
+			f->group[i].stale = 0;
+	}
+
+	/* leave first so that joins can reuse the freed slots */
+	for (i = 0; i < EMAC_DEF_MAX_MULTICAST_ADDRESSES; i++)
+		if (f->group[i].in_use && f->group[i].stale)
+			update |= emac_mcast_del(priv, i);
+
+	netdev_for_each_mc_addr(ha, ndev)
+		if (emac_mcast_find(f, ha->addr) == EMAC_MCAST_NONE)
+			update |= emac_mcast_add(priv, (u8 *) ha->addr);
+
+	/* the rebalance is too much work with BHs off, leave it to a worker */
+	if (f->count > f->nr_slots)
+		schedule_work(&priv->mcast_work);
+
+	return update;
+}
+
+/**
+ * emac_mcast_flush: Drop every multicast group
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ */
+static void emac_mcast_flush(struct emac_priv *priv)
+{
+	struct emac_mcast_filter *f = &priv->mcast;
+	int i;
+
+	for (i = 0; i < EMAC_DEF_MAX_MULTICAST_ADDRESSES; i++)
+		if (f->group[i].in_use)
+			emac_mcast_del(priv, i);
+	priv->mac_hash1 = 0;
+	priv->mac_hash2 = 0;
+}
+
+/**
+ * emac_mcast_account: Per multicast frame filter statistics
+ * @priv: The DaVinci EMAC private adapter structure
+ * @addr: destination address of a received multicast frame
+ *
+ * Counts frames per group to pick the exact match groups, and frames the
+ * hash let through for groups nobody subscribed (false positives)
+ *
+ */
+static void emac_mcast_account(struct emac_priv *priv, const u8 *addr)
+{
+	struct emac_mcast_filter *f = &priv->mcast;
+	int i;
+
+	spin_lock(&priv->mcast_lock);
+	if (f->all || (priv->ndev->flags & IFF_PROMISC))
+		goto unlock;
+
+	i = emac_mcast_find(f, addr);
+	if (i == EMAC_MCAST_NONE) {
+		f->false_pos++;
+	} else {
+		f->group[i].hits++;
+		if (f->group[i].slot == EMAC_MCAST_NONE)
+			f->hash_hits++;
+		else
+			f->exact_hits++;
+	}
+
+	/* the rebalance is too much work for NAPI, leave it to a worker */
+	if (++f->frames == EMAC_MCAST_REBALANCE_FRAMES)
+		schedule_work(&priv->mcast_work);
+unlock:
+	spin_unlock(&priv->mcast_lock);
+}
+
+/**
+ * emac_mcast_rebalance_work: Deferred exact match slot rebalance
+ * @work: the adapter's mcast_work
+ *
+ * Scheduled by emac_mcast_account() every EMAC_MCAST_REBALANCE_FRAMES
+ * multicast frames, and by emac_mcast_sync() while groups are hashed
+ *
+ */
+static void emac_mcast_rebalance_work(struct work_struct *work)
+{
+	struct emac_priv *priv = container_of(work, struct emac_priv,
+					      mcast_work);
+
+	spin_lock_bh(&priv->mcast_lock);
+	if (!priv->mcast.all && emac_mcast_rebalance(priv))
+		emac_mcast_write_hash(priv);
+	spin_unlock_bh(&priv->mcast_lock);
 }
 
 /**
@@ -872,6 +1616,8 @@ static void emac_dev_mcast_set(struct net_device *ndev)
 {
 	u32 mbp_enable;
 	struct emac_priv *priv = netdev_priv(ndev);
+	struct emac_mcast_filter *f = &priv->mcast;
+	int update = 0;
 
 	mbp_enable = emac_read(EMAC_RXMBPENABLE);
 	if (ndev->flags & IFF_PROMISC) {
@@ -879,25 +1625,33 @@ static void emac_dev_mcast_set(struct net_device *ndev)
 		mbp_enable |= (EMAC_MBP_RXPROMISC);
 	} else {
 		mbp_enable = (mbp_enable & ~EMAC_MBP_RXPROMISC);
+		spin_lock(&priv->mcast_lock);
 		if ((ndev->flags & IFF_ALLMULTI) ||
 		    netdev_mc_count(ndev) > EMAC_DEF_MAX_MULTICAST_ADDRESSES) {
-			mbp_enable = (mbp_enable | EMAC_MBP_RXMCAST);
-			emac_add_mcast(priv, EMAC_ALL_MULTI_SET, NULL);
+			if (!f->all) {
+				emac_mcast_flush(priv);
+				f->all = 1;
+				priv->mac_hash1 = EMAC_ALL_MULTI_REG_VALUE;
+				priv->mac_hash2 = EMAC_ALL_MULTI_REG_VALUE;
+				update = 1;
+			}
+		} else {
+			if (f->all) {
+				f->all = 0;
+				priv->mac_hash1 = 0;
+				priv->mac_hash2 = 0;
+				update = 1;
+			}
+			update |= emac_mcast_sync(priv);
 		}
-		if (!netdev_mc_empty(ndev)) {
-			struct netdev_hw_addr *ha;
+		if (update)
+			emac_mcast_write_hash(priv);
 
+		if (f->all || f->count)
 			mbp_enable = (mbp_enable | EMAC_MBP_RXMCAST);
-			emac_add_mcast(priv, EMAC_ALL_MULTI_CLR, NULL);
-			/* program multicast address list into EMAC hardware */
-			netdev_for_each_mc_addr(ha, ndev) {
-				emac_add_mcast(priv, EMAC_MULTICAST_ADD,
-					       (u8 *) ha->addr);
-			}
-		} else {
+		else
 			mbp_enable = (mbp_enable & ~EMAC_MBP_RXMCAST);
-			emac_add_mcast(priv, EMAC_ALL_MULTI_CLR, NULL);
-		}
+		spin_unlock(&priv->mcast_lock);
 	}
 	/* Set mbp config register */
 	emac_write(EMAC_RXMBPENABLE, mbp_enable);
@@ -1003,28 +1757,226 @@ static irqreturn_t emac_irq(int irq, void *dev_id)
 	return IRQ_HANDLED;
 }
 
-static struct sk_buff *emac_rx_alloc(struct emac_priv *priv)
+/**
+ * emac_rx_page_free: Release a pooled RX page
+ * @priv: The DaVinci EMAC private adapter structure
+ * @page: page to release
+ *
+ * Drops the driver's mapping and reference; the page is freed once the
+ * stack has released any fragments still pointing at it
+ *
+ */
+static void emac_rx_page_free(struct emac_priv *priv, struct page *page)
 {
-	struct sk_buff *skb = dev_alloc_skb(priv->rx_buf_size);
-	if (WARN_ON(!skb))
+	dma_unmap_page(priv->dma_dev, page_private(page),
+		       PAGE_SIZE << priv->rx_pool.order, DMA_FROM_DEVICE);
+	put_page(page);
+}
+
+/**
+ * emac_rx_page_get: Get a mapped page for an RX descriptor
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ * Reuses the oldest pooled page if the stack is done with it, otherwise
+ * allocates and maps a fresh one
+ *
+ * Returns the page or NULL on allocation or mapping failure
+ */
+static struct page *emac_rx_page_get(struct emac_priv *priv)
+{
+	struct emac_rx_pool *pool = &priv->rx_pool;
+	struct page *page;
+	dma_addr_t dma;
+
+	if (pool->count) {
+		page = pool->ring[pool->head];
+		if (page_count(page) == 1) {
+			pool->head = (pool->head + 1) % EMAC_RX_POOL_SIZE;
+			pool->count--;
+			pool->hits++;
+			return page;
+		}
+		pool->misses++;
+	}
+
+	page = alloc_pages(GFP_ATOMIC | __GFP_COLD | __GFP_COMP, pool->order);
+	if (unlikely(!page)) {
+		pool->alloc_fail++;
 		return NULL;
-	skb->dev = priv->ndev;
-	skb_reserve(skb, NET_IP_ALIGN);
+	}
+
+	dma = dma_map_page(priv->dma_dev, page, 0,
+			   PAGE_SIZE << pool->order, DMA_FROM_DEVICE);
+	if (unlikely(dma_mapping_error(priv->dma_dev, dma))) {
+		__free_pages(page, pool->order);
+		pool->alloc_fail++;
+		return NULL;
+	}
+	set_page_private(page, dma);
+	pool->refills++;
+	return page;
+}
+
+/**
+ * emac_rx_page_recycle: Return a page to the RX pool
+ * @priv: The DaVinci EMAC private adapter structure
+ * @page: page whose fragment is about to be handed to the stack
+ *
+ * Must be called before the skb holding @page goes up the stack.  If the
+ * pool is full, the oldest page is released to make room once the stack
+ * is done with it (page_count() == 1); otherwise @page itself is unmapped
+ * and released while the driver still owns its data
+ *
+ */
+static void emac_rx_page_recycle(struct emac_priv *priv, struct page *page)
+{
+	struct emac_rx_pool *pool = &priv->rx_pool;
+
+	if (pool->count == EMAC_RX_POOL_SIZE) {
+		if (page_count(pool->ring[pool->head]) != 1) {
+			pool->evictions++;
+			emac_rx_page_free(priv, page);
+			return;
+		}
+		emac_rx_page_free(priv, pool->ring[pool->head]);
+		pool->head = (pool->head + 1) % EMAC_RX_POOL_SIZE;
+		pool->count--;
+	}
+
+	pool->ring[(pool->head + pool->count) % EMAC_RX_POOL_SIZE] = page;
+	pool->count++;
+}
+
+/**
+ * emac_rx_pool_drain: Release every page held in the RX pool
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ */
+static void emac_rx_pool_drain(struct emac_priv *priv)
+{
+	struct emac_rx_pool *pool = &priv->rx_pool;
+
+	while (pool->count) {
+		emac_rx_page_free(priv, pool->ring[pool->head]);
+		pool->head = (pool->head + 1) % EMAC_RX_POOL_SIZE;
+		pool->count--;
+	}
+	pool->head = 0;
+}
+
+/**
+ * emac_rx_slot_queue: Queue an RX slot for reposting to its channel
+ * @priv: The DaVinci EMAC private adapter structure
+ * @slot: RX slot holding a mapped page
+ *
+ * The slot is handed back to the hardware by the next emac_rx_refill()
+ */
+static void emac_rx_slot_queue(struct emac_priv *priv,
+			       struct emac_rx_slot *slot)
+{
+	struct emac_rx_refill *rf = &priv->rx_refill[slot->ch];
+
+	rf->slots[rf->count++] = slot;
+}
+
+/**
+ * emac_rx_refill: Repost the queued RX slots of a channel
+ * @priv: The DaVinci EMAC private adapter structure
+ * @ch: RX channel
+ *
+ * Slots are posted EMAC_RX_REFILL_BATCH at a time, each batch as one
+ * descriptor chain.  Pages that could not be posted are freed.
+ */
+static void emac_rx_refill(struct emac_priv *priv, int ch)
+{
+	struct emac_rx_refill *rf = &priv->rx_refill[ch];
+	struct cpdma_buf bufs[EMAC_RX_REFILL_BATCH];
+	struct emac_rx_slot *slot;
+	int done, n, i, ret;
+
+	for (done = 0; done < rf->count; done += n) {
+		n = min(rf->count - done, EMAC_RX_REFILL_BATCH);
+
+		for (i = 0; i < n; i++) {
+			slot = rf->slots[done + i];
+			bufs[i].token = slot;
+			bufs[i].dma = page_private(slot->page);
+			bufs[i].len = priv->rx_buf_size;
+			dma_sync_single_for_device(priv->dma_dev,
+						   bufs[i].dma,
+						   priv->rx_buf_size,
+						   DMA_FROM_DEVICE);
+		}
+
+		ret = cpdma_chan_submit_mapped_batch(priv->rxchan[ch], bufs,
+						     n, 0);
+		for (i = max(ret, 0); i < n; i++) {
+			slot = rf->slots[done + i];
+			emac_rx_page_free(priv, slot->page);
+			slot->page = NULL;
+		}
+	}
+	rf->count = 0;
+}
+
+/**
+ * emac_rx_build_skb: Build an skb around a received page
+ * @priv: The DaVinci EMAC private adapter structure
+ * @page: received page
+ * @len: frame length
+ *
+ * Small frames are copied so the page can go straight back to hardware.
+ * Larger frames get their headers copied and the rest attached as a page
+ * fragment; the stack then holds a reference on the page.
+ *
+ * Returns the skb or NULL on allocation failure
+ */
+static struct sk_buff *emac_rx_build_skb(struct emac_priv *priv,
+					 struct page *page, int len)
+{
+	struct sk_buff *skb;
+	void *va = page_address(page);
+	int hlen = (len <= EMAC_RX_COPYBREAK) ? len : EMAC_RX_HDR_LEN;
+
+	skb = netdev_alloc_skb_ip_align(priv->ndev, hlen);
+	if (unlikely(!skb))
+		return NULL;
+
+	dma_sync_single_for_cpu(priv->dma_dev, page_private(page), len,
+				DMA_FROM_DEVICE);
+	memcpy(skb_put(skb, hlen), va, hlen);
+
+	if (len > hlen) {
+		get_page(page);
+		skb_add_rx_frag(skb, 0, page, hlen, len - hlen);
+		/* the socket is charged for the whole page the frame pins */
+		skb->truesize += (PAGE_SIZE << priv->rx_pool.order) -
+				 (len - hlen);
+	}
 	return skb;
 }
 
-static void emac_rx_handler(void *token, int len, int status)
+/**
+ * emac_rx_frame: Turn a completed RX slot into an skb and repost the slot
+ * @slot: completed RX slot
+ * @len: frame length
+ * @status: cpdma completion status
+ *
+ * Returns the skb to hand to the stack, or NULL if the frame was dropped
+ */
+static struct sk_buff *emac_rx_frame(struct emac_rx_slot *slot, int len,
+				     int status)
 {
-	struct sk_buff		*skb = token;
-	struct net_device	*ndev = skb->dev;
-	struct emac_priv	*priv = netdev_priv(ndev);
+	struct emac_priv	*priv = slot->priv;
+	struct net_device	*ndev = priv->ndev;
 	struct device		*emac_dev = &ndev->dev;
-	int			ret;
+	struct sk_buff		*skb;
 
 	/* free and bail if we are shutting down */
-	if (unlikely(!netif_running(ndev))) {
-		dev_kfree_skb_any(skb);
-		return;
+	if (unlikely(!netif_running(ndev) || status == -ENOSYS)) {
+		emac_rx_page_free(priv, slot->page);
+		slot->page = NULL;
+		return NULL;
 	}
 
 	/* recycle on recieve error */
@@ -1033,40 +1985,151 @@ static void emac_rx_handler(void *token, int len, int status)
 		goto recycle;
 	}
 
-	/* feed received packet up the stack */
-	skb_put(skb, len);
+	skb = emac_rx_build_skb(priv, slot->page, len);
+	if (unlikely(!skb)) {
+		if (netif_msg_rx_err(priv) && net_ratelimit())
+			dev_err(emac_dev, "failed rx skb alloc\n");
+		ndev->stats.rx_dropped++;
+		goto recycle;
+	}
 	skb->protocol = eth_type_trans(skb, ndev);
-	netif_receive_skb(skb);
+	if (skb->pkt_type == PACKET_MULTICAST)
+		emac_mcast_account(priv, eth_hdr(skb)->h_dest);
 	ndev->stats.rx_bytes += len;
 	ndev->stats.rx_packets++;
 
-	/* alloc a new packet for receive */
-	skb = emac_rx_alloc(priv);
-	if (!skb) {
+	if (!skb_shinfo(skb)->nr_frags) {
+		priv->rx_pool.copybreak++;
+		emac_rx_slot_queue(priv, slot);
+		return skb;
+	}
+
+	/* park the page until the stack lets go of it, get another one */
+	emac_rx_page_recycle(priv, slot->page);
+	slot->page = emac_rx_page_get(priv);
+	if (!slot->page) {
 		if (netif_msg_rx_err(priv) && net_ratelimit())
 			dev_err(emac_dev, "failed rx buffer alloc\n");
-		return;
+		return skb;
 	}
+	emac_rx_slot_queue(priv, slot);
+	return skb;
 
 recycle:
-	ret = cpdma_chan_submit(priv->rxchan, skb, skb->data,
-			skb_tailroom(skb), 0, GFP_KERNEL);
-	if (ret < 0)
-		dev_kfree_skb_any(skb);
+	emac_rx_slot_queue(priv, slot);
+	return NULL;
+}
+
+static void emac_rx_handler(void *token, int len, int status)
+{
+	struct emac_rx_slot	*slot = token;
+	struct sk_buff		*skb;
+
+	skb = emac_rx_frame(slot, len, status);
+	if (skb)
+		napi_gro_receive(&slot->priv->napi, skb);
+}
+
+/**
+ * emac_rx_batch_handler: Deliver a run of completed RX slots
+ * @done: completed packets reaped by cpdma_chan_process()
+ * @count: number of entries in @done
+ *
+ * All skbs of the run are built (and their slots queued for refill) first,
+ * then fed to GRO back to back so that flows aggregate across the run
+ */
+static void emac_rx_batch_handler(struct cpdma_done *done, int count)
+{
+	struct emac_rx_slot	*slot = done[0].token;
+	struct sk_buff_head	list;
+	struct sk_buff		*skb;
+	int			i;
+
+	__skb_queue_head_init(&list);
+	for (i = 0; i < count; i++) {
+		skb = emac_rx_frame(done[i].token, done[i].len,
+				    done[i].status);
+		if (skb)
+			__skb_queue_tail(&list, skb);
+	}
+
+	while ((skb = __skb_dequeue(&list)) != NULL)
+		napi_gro_receive(&slot->priv->napi, skb);
 }
 
 static void emac_tx_handler(void *token, int len, int status)
 {
 	struct sk_buff		*skb = token;
 	struct net_device	*ndev = skb->dev;
+	u16			q = skb_get_queue_mapping(skb);
 
-	if (unlikely(netif_queue_stopped(ndev)))
-		netif_start_queue(ndev);
+	if (unlikely(__netif_subqueue_stopped(ndev, q)))
+		netif_wake_subqueue(ndev, q);
 	ndev->stats.tx_packets++;
 	ndev->stats.tx_bytes += len;
 	dev_kfree_skb_any(skb);
 }
 
+/**
+ * emac_tx_batch_handler: Release a run of transmitted skbs
+ * @done: completed packets reaped by cpdma_chan_process()
+ * @count: number of entries in @done
+ *
+ * Every skb of a run comes from the same TX channel, so the queue is
+ * woken at most once per run
+ */
+static void emac_tx_batch_handler(struct cpdma_done *done, int count)
+{
+	struct sk_buff		*skb = done[0].token;
+	struct net_device	*ndev = skb->dev;
+	u16			q = skb_get_queue_mapping(skb);
+	int			i;
+
+	for (i = 0; i < count; i++) {
+		ndev->stats.tx_bytes += done[i].len;
+		dev_kfree_skb_any(done[i].token);
+	}
+	ndev->stats.tx_packets += count;
+
+	if (unlikely(__netif_subqueue_stopped(ndev, q)))
+		netif_wake_subqueue(ndev, q);
+}
+
+/**
+ * emac_submit_sg: Queue a fragmented skb without linearizing it
+ * @priv: The DaVinci EMAC private adapter structure
+ * @skb: SKB pointer
+ *
+ * Maps the linear part and every page fragment of the skb to its own CPPI
+ * descriptor and hands the chain to the TX channel as one packet
+ *
+ * Returns 0 on success or the cpdma_chan_submit_sg() error code
+ */
+static int emac_submit_sg(struct emac_priv *priv, struct sk_buff *skb)
+{
+	struct cpdma_frag frags[MAX_SKB_FRAGS + 1];
+	int i, nr = 0;
+
+	if (skb_headlen(skb)) {
+		frags[nr].page = virt_to_page(skb->data);
+		frags[nr].offset = offset_in_page(skb->data);
+		frags[nr].len = skb_headlen(skb);
+		nr++;
+	}
+
+	for (i = 0; i < skb_shinfo(skb)->nr_frags; i++) {
+		skb_frag_t *frag = &skb_shinfo(skb)->frags[i];
+
+		frags[nr].page = frag->page;
+		frags[nr].offset = frag->page_offset;
+		frags[nr].len = frag->size;
+		nr++;
+	}
+
+	return cpdma_chan_submit_sg(priv->txchan[skb_get_queue_mapping(skb)],
+				    skb, frags, nr, 0, GFP_KERNEL);
+}
+
 /**
  * emac_dev_xmit: EMAC Transmit function
  * @skb: SKB pointer
@@ -1082,6 +2145,7 @@ static int emac_dev_xmit(struct sk_buff *skb, struct net_device *ndev)
 	struct device *emac_dev = &ndev->dev;
 	int ret_code;
 	struct emac_priv *priv = netdev_priv(ndev);
+	u16 q = skb_get_queue_mapping(skb);
 
 	/* If no link, return */
 	if (unlikely(!priv->link)) {
@@ -1090,6 +2154,10 @@ static int emac_dev_xmit(struct sk_buff *skb, struct net_device *ndev)
 		goto fail_tx;
 	}
 
+	/*
+	 * skb_padto() linearizes a runt, so emac_submit_sg() only ever sees
+	 * packets of at least the minimum size
+	 */
 	ret_code = skb_padto(skb, EMAC_DEF_MIN_ETHPKTSIZE);
 	if (unlikely(ret_code < 0)) {
 		if (netif_msg_tx_err(priv) && net_ratelimit())
@@ -1097,8 +2165,23 @@ static int emac_dev_xmit(struct sk_buff *skb, struct net_device *ndev)
 		goto fail_tx;
 	}
 
-	ret_code = cpdma_chan_submit(priv->txchan, skb, skb->data, skb->len,
-					0, GFP_KERNEL);
+	/*
+	 * The EMAC has no checksum engine; NETIF_F_HW_CSUM is advertised only
+	 * so that the stack will hand us paged skbs, so finish it here.
+	 */
+	if (skb->ip_summed == CHECKSUM_PARTIAL && skb_checksum_help(skb)) {
+		if (netif_msg_tx_err(priv) && net_ratelimit())
+			dev_err(emac_dev, "DaVinci EMAC: checksum failed");
+		dev_kfree_skb_any(skb);
+		ndev->stats.tx_dropped++;
+		return NETDEV_TX_OK;
+	}
+
+	if (skb_is_nonlinear(skb))
+		ret_code = emac_submit_sg(priv, skb);
+	else
+		ret_code = cpdma_chan_submit(priv->txchan[q], skb, skb->data,
+					     skb->len, 0, GFP_KERNEL);
 	if (unlikely(ret_code != 0)) {
 		if (netif_msg_tx_err(priv) && net_ratelimit())
 			dev_err(emac_dev, "DaVinci EMAC: desc submit failed");
@@ -1109,10 +2192,28 @@ static int emac_dev_xmit(struct sk_buff *skb, struct net_device *ndev)
 
 fail_tx:
 	ndev->stats.tx_dropped++;
-	netif_stop_queue(ndev);
+	netif_stop_subqueue(ndev, q);
 	return NETDEV_TX_BUSY;
 }
 
+/**
+ * emac_dev_select_queue: Pick the TX queue for a packet
+ * @ndev: The DaVinci EMAC network adapter
+ * @skb: SKB pointer
+ *
+ * Interactive and control priority traffic (e.g. IPTOS_LOWDELAY sockets)
+ * goes to the control queue, whose CPDMA channel the EMAC services ahead
+ * of the bulk channel (fixed TX channel priority, higher channel first)
+ *
+ * Returns the TX queue index, which is also the CPDMA TX channel
+ */
+static u16 emac_dev_select_queue(struct net_device *ndev, struct sk_buff *skb)
+{
+	if (skb->priority >= TC_PRIO_INTERACTIVE)
+		return EMAC_CTRL_TX_CH;
+	return EMAC_DEF_TX_CH;
+}
+
 /**
  * emac_dev_tx_timeout: EMAC Transmit timeout function
  * @ndev: The DaVinci EMAC network adapter
@@ -1127,6 +2228,7 @@ static void emac_dev_tx_timeout(struct net_device *ndev)
 {
 	struct emac_priv *priv = netdev_priv(ndev);
 	struct device *emac_dev = &ndev->dev;
+	int ch;
 
 	if (netif_msg_tx_err(priv))
 		dev_err(emac_dev, "DaVinci EMAC: xmit timeout, restarting TX");
@@ -1135,8 +2237,10 @@ static void emac_dev_tx_timeout(struct net_device *ndev)
 
 	ndev->stats.tx_errors++;
 	emac_int_disable(priv);
-	cpdma_chan_stop(priv->txchan);
-	cpdma_chan_start(priv->txchan);
+	for (ch = 0; ch < EMAC_DEF_MAX_TX_CH; ch++) {
+		cpdma_chan_stop(priv->txchan[ch]);
+		cpdma_chan_start(priv->txchan[ch]);
+	}
 	emac_int_enable(priv);
 }
 
@@ -1209,8 +2313,8 @@ static void emac_set_type2addr(struct emac_priv *priv, u32 ch,
 	val = ((mac_addr[3] << 24) | (mac_addr[2] << 16) | \
 	       (mac_addr[1] << 8) | (mac_addr[0]));
 	emac_write(EMAC_MACADDRHI, val);
-	val = ((mac_addr[5] << 8) | mac_addr[4] | ((ch & 0x7) << 16) | \
-	       (match << 19) | BIT(20));
+	val = ((mac_addr[5] << 8) | mac_addr[4] | EMAC_MACADDRLO_CHANNEL(ch) | \
+	       (match ? EMAC_MACADDRLO_MATCHFILT : 0) | EMAC_MACADDRLO_VALID);
 	emac_write(EMAC_MACADDRLO, val);
 	emac_set_type0addr(priv, ch, mac_addr);
 }
@@ -1229,6 +2333,8 @@ static void emac_setmac(struct emac_priv *priv, u32 ch, char *mac_addr)
 {
 	struct device *emac_dev = &priv->ndev->dev;
 
+	/* MACINDEX/MACADDRHI/LO are shared with the multicast slots */
+	spin_lock_bh(&priv->mcast_lock);
 	if (priv->rx_addr_type == 0) {
 		emac_set_type0addr(priv, ch, mac_addr);
 	} else if (priv->rx_addr_type == 1) {
@@ -1242,6 +2348,7 @@ static void emac_setmac(struct emac_priv *priv, u32 ch, char *mac_addr)
 		if (netif_msg_drv(priv))
 			dev_err(emac_dev, "DaVinci EMAC: Wrong addressing\n");
 	}
+	spin_unlock_bh(&priv->mcast_lock);
 }
 
 /**
@@ -1269,7 +2376,7 @@ static int emac_dev_setmac_addr(struct net_device *ndev, void *addr)
 	/* MAC address is configured only after the interface is enabled. */
 	if (netif_running(ndev)) {
 		memcpy(priv->mac_addr, sa->sa_data, ndev->addr_len);
-		emac_setmac(priv, EMAC_DEF_RX_CH, priv->mac_addr);
+		emac_setmac(priv, EMAC_CTRL_RX_CH, priv->mac_addr);
 	}
 
 	if (netif_msg_drv(priv))
@@ -1325,17 +2432,20 @@ static int emac_hw_enable(struct emac_priv *priv)
 		 ((EMAC_DEF_MCAST_CH & EMAC_RXMBP_CHMASK) << \
 			EMAC_RXMBP_MULTICH_SHIFT));
 	emac_write(EMAC_RXMBPENABLE, mbp_enable);
-	emac_write(EMAC_RXMAXLEN, (EMAC_DEF_MAX_FRAME_SIZE &
+	/* longer frames would spill into a second RX buffer */
+	emac_write(EMAC_RXMAXLEN, (priv->rx_buf_size &
 				   EMAC_RX_MAX_LEN_MASK));
 	emac_write(EMAC_RXBUFFEROFFSET, (EMAC_DEF_BUFFER_OFFSET &
 					 EMAC_RX_BUFFER_OFFSET_MASK));
 	emac_write(EMAC_RXFILTERLOWTHRESH, 0);
 	emac_write(EMAC_RXUNICASTCLEAR, EMAC_RX_UNICAST_CLEAR_ALL);
 	priv->rx_addr_type = (emac_read(EMAC_MACCONFIG) >> 8) & 0xFF;
+	emac_mcast_reset(priv);
 
 	emac_write(EMAC_MACINTMASKSET, EMAC_MAC_HOST_ERR_INTMASK_VAL);
 
-	emac_setmac(priv, EMAC_DEF_RX_CH, priv->mac_addr);
+	/* unicast goes to the control channel, mcast/bcast stay on ch 0 */
+	emac_setmac(priv, EMAC_CTRL_RX_CH, priv->mac_addr);
 
 	/* Enable MII */
 	val = emac_read(EMAC_MACCONTROL);
@@ -1369,30 +2479,59 @@ static int emac_poll(struct napi_struct *napi, int budget)
 	struct net_device *ndev = priv->ndev;
 	struct device *emac_dev = &ndev->dev;
 	u32 status = 0;
-	u32 num_tx_pkts = 0, num_rx_pkts = 0;
+	int num_tx_pkts = 0, num_rx_pkts = 0;
+	int ch, used, quota;
+	bool tx_exhausted = false, rx_exhausted = false;
+	u32 start = emac_bench_read(priv);
 
 	/* Check interrupt vectors and call packet processing */
 	status = emac_read(EMAC_MACINVECTOR);
 
-	mask = EMAC_DM644X_MAC_IN_VECTOR_TX_INT_VEC;
-
-	if (priv->version == EMAC_VERSION_2)
-		mask = EMAC_DM646X_MAC_IN_VECTOR_TX_INT_VEC;
-
-	if (status & mask) {
-		num_tx_pkts = cpdma_chan_process(priv->txchan,
-					      EMAC_DEF_TX_MAX_SERVICE);
+	/* TX completion, highest priority channel first */
+	for (ch = EMAC_DEF_MAX_TX_CH - 1; ch >= 0; ch--) {
+		mask = EMAC_DM644X_MAC_IN_VECTOR_TX_CH(ch);
+		if (priv->version == EMAC_VERSION_2)
+			mask = EMAC_DM646X_MAC_IN_VECTOR_TX_CH(ch);
+
+		if (status & mask) {
+			used = cpdma_chan_process(priv->txchan[ch],
+						  EMAC_DEF_TX_MAX_SERVICE);
+			used = max(used, 0);
+			if (used >= EMAC_DEF_TX_MAX_SERVICE)
+				tx_exhausted = true;
+			num_tx_pkts += used;
+		}
 	} /* TX processing */
 
-	mask = EMAC_DM644X_MAC_IN_VECTOR_RX_INT_VEC;
-
-	if (priv->version == EMAC_VERSION_2)
-		mask = EMAC_DM646X_MAC_IN_VECTOR_RX_INT_VEC;
-
-	if (status & mask) {
-		num_rx_pkts = cpdma_chan_process(priv->rxchan, budget);
+	/*
+	 * RX, control channel first with its own share of the budget, the
+	 * bulk channel gets whatever is left of it
+	 */
+	for (ch = EMAC_DEF_MAX_RX_CH - 1; ch >= 0; ch--) {
+		mask = EMAC_DM644X_MAC_IN_VECTOR_RX_CH(ch);
+		if (priv->version == EMAC_VERSION_2)
+			mask = EMAC_DM646X_MAC_IN_VECTOR_RX_CH(ch);
+
+		quota = budget - num_rx_pkts;
+		if (ch == EMAC_CTRL_RX_CH)
+			quota = min(quota, EMAC_CTRL_RX_WEIGHT);
+
+		if (status & mask) {
+			used = (quota > 0) ?
+				cpdma_chan_process(priv->rxchan[ch], quota) : 0;
+			used = max(used, 0);
+			if (used >= quota)
+				rx_exhausted = true;
+			num_rx_pkts += used;
+			emac_rx_refill(priv, ch);
+		}
 	} /* RX processing */
 
+	priv->irq_tx_pkts += num_tx_pkts;
+	priv->irq_rx_pkts += num_rx_pkts;
+	emac_coal_update(priv, tx_exhausted, rx_exhausted);
+	emac_bench_update(priv, start, num_tx_pkts + num_rx_pkts);
+
 	mask = EMAC_DM644X_MAC_IN_VECTOR_HOST_INT;
 	if (priv->version == EMAC_VERSION_2)
 		mask = EMAC_DM646X_MAC_IN_VECTOR_HOST_INT;
@@ -1400,7 +2539,7 @@ static int emac_poll(struct napi_struct *napi, int budget)
 	if (unlikely(status & mask)) {
 		u32 ch, cause;
 		dev_err(emac_dev, "DaVinci EMAC: Fatal Hardware Error\n");
-		netif_stop_queue(ndev);
+		netif_tx_stop_all_queues(ndev);
 		napi_disable(&priv->napi);
 
 		status = emac_read(EMAC_MACSTATUS);
@@ -1423,7 +2562,7 @@ static int emac_poll(struct napi_struct *napi, int budget)
 				dev_err(emac_dev, "RX Host error %s on ch=%d\n",
 					&emac_rxhost_errcodes[cause][0], ch);
 		}
-	} else if (num_rx_pkts < budget) {
+	} else if (!rx_exhausted) {
 		int i;
 
 		napi_complete(napi);
@@ -1432,6 +2571,9 @@ static int emac_poll(struct napi_struct *napi, int budget)
 			enable_irq(priv->irqs_table[i]);
 	}
 
+	/* a channel that used its share must be polled again */
+	if (rx_exhausted)
+		return budget;
 	return num_rx_pkts;
 }
 
@@ -1598,7 +2740,7 @@ static int emac_dev_open(struct net_device *ndev)
 	struct device *emac_dev = &ndev->dev;
 	u32 cnt;
 	struct resource *res;
-	int q, m, ret;
+	int q, m, ch;
 	int i = 0, irq_num = 0;
 	int k = 0;
 	struct emac_priv *priv = netdev_priv(ndev);
@@ -1608,24 +2750,25 @@ static int emac_dev_open(struct net_device *ndev)
 		ndev->dev_addr[cnt] = priv->mac_addr[cnt];
 
 	/* Configuration items */
-	priv->rx_buf_size = EMAC_DEF_MAX_FRAME_SIZE + NET_IP_ALIGN;
-
-	priv->mac_hash1 = 0;
-	priv->mac_hash2 = 0;
-	emac_write(EMAC_MACHASH1, 0);
-	emac_write(EMAC_MACHASH2, 0);
+	/* a 1500 byte MTU fits one page, so the refill never needs order > 0 */
+	priv->rx_buf_size = min_t(u32, EMAC_DEF_MAX_FRAME_SIZE, ndev->mtu +
+				  ETH_HLEN + VLAN_HLEN + ETH_FCS_LEN);
+	priv->rx_pool.order = get_order(priv->rx_buf_size);
 
 	for (i = 0; i < EMAC_DEF_RX_NUM_DESC; i++) {
-		struct sk_buff *skb = emac_rx_alloc(priv);
+		struct emac_rx_slot *slot = &priv->rx_slots[i];
 
-		if (!skb)
+		slot->priv = priv;
+		slot->ch = (i < EMAC_CTRL_RX_NUM_DESC) ?
+			   EMAC_CTRL_RX_CH : EMAC_DEF_RX_CH;
+		slot->page = emac_rx_page_get(priv);
+		if (WARN_ON(!slot->page))
 			break;
 
-		ret = cpdma_chan_submit(priv->rxchan, skb, skb->data,
-					skb_tailroom(skb), 0, GFP_KERNEL);
-		if (WARN_ON(ret < 0))
-			break;
+		emac_rx_slot_queue(priv, slot);
 	}
+	for (ch = 0; ch < EMAC_DEF_MAX_RX_CH; ch++)
+		emac_rx_refill(priv, ch);
 
 	/* Request IRQ */
 
@@ -1644,10 +2787,16 @@ static int emac_dev_open(struct net_device *ndev)
 	/* Start/Enable EMAC hardware */
 	emac_hw_enable(priv);
 
+	if (poll_bench)
+		emac_bench_start();
+
 	/* Enable Interrupt pacing if configured */
-	if (priv->coal_intvl != 0) {
+	if (priv->coal_adaptive_rx || priv->coal_adaptive_tx) {
+		emac_adapt_program(priv);
+	} else if (priv->coal_intvl != 0) {
 		struct ethtool_coalesce coal;
 
+		memset(&coal, 0, sizeof(coal));
 		coal.rx_coalesce_usecs = (priv->coal_intvl << 4);
 		emac_set_coalesce(ndev, &coal);
 	}
@@ -1749,12 +2898,14 @@ static int emac_dev_stop(struct net_device *ndev)
 	struct device *emac_dev = &ndev->dev;
 
 	/* inform the upper layers. */
-	netif_stop_queue(ndev);
+	netif_tx_stop_all_queues(ndev);
 	napi_disable(&priv->napi);
+	cancel_work_sync(&priv->mcast_work);
 
 	netif_carrier_off(ndev);
 	emac_int_disable(priv);
 	cpdma_ctlr_stop(priv->dma);
+	emac_rx_pool_drain(priv);
 	emac_write(EMAC_SOFTRESET, 1);
 
 	if (priv->phydev)
@@ -1835,6 +2986,7 @@ static const struct net_device_ops emac_netdev_ops = {
 	.ndo_open		= emac_dev_open,
 	.ndo_stop		= emac_dev_stop,
 	.ndo_start_xmit		= emac_dev_xmit,
+	.ndo_select_queue	= emac_dev_select_queue,
 	.ndo_set_multicast_list	= emac_dev_mcast_set,
 	.ndo_set_mac_address	= emac_dev_setmac_addr,
 	.ndo_do_ioctl		= emac_devioctl,
@@ -1845,6 +2997,25 @@ static const struct net_device_ops emac_netdev_ops = {
 #endif
 };
 
+/**
+ * emac_chan_destroy_all: Release every CPDMA channel of the adapter
+ * @priv: The DaVinci EMAC private adapter structure
+ *
+ */
+static void emac_chan_destroy_all(struct emac_priv *priv)
+{
+	int ch;
+
+	for (ch = 0; ch < EMAC_DEF_MAX_TX_CH; ch++) {
+		if (priv->txchan[ch])
+			cpdma_chan_destroy(priv->txchan[ch]);
+	}
+	for (ch = 0; ch < EMAC_DEF_MAX_RX_CH; ch++) {
+		if (priv->rxchan[ch])
+			cpdma_chan_destroy(priv->rxchan[ch]);
+	}
+}
+
 /**
  * davinci_emac_probe: EMAC device probe
  * @pdev: The DaVinci EMAC device that we are removing
@@ -1863,6 +3034,7 @@ static int __devinit davinci_emac_probe(struct platform_device *pdev)
 	struct emac_platform_data *pdata;
 	struct device *emac_dev;
 	struct cpdma_params dma_params;
+	int ch;
 
 	/* obtain emac clock from kernel */
 	emac_clk = clk_get(&pdev->dev, NULL);
@@ -1873,7 +3045,7 @@ static int __devinit davinci_emac_probe(struct platform_device *pdev)
 	emac_bus_frequency = clk_get_rate(emac_clk);
 	/* TODO: Probe PHY here if possible */
 
-	ndev = alloc_etherdev(sizeof(struct emac_priv));
+	ndev = alloc_etherdev_mq(sizeof(struct emac_priv), EMAC_DEF_MAX_TX_CH);
 	if (!ndev) {
 		printk(KERN_ERR "DaVinci EMAC: Error allocating net_device\n");
 		clk_put(emac_clk);
@@ -1887,6 +3059,8 @@ static int __devinit davinci_emac_probe(struct platform_device *pdev)
 	priv->msg_enable = netif_msg_init(debug_level, DAVINCI_EMAC_DEBUG);
 
 	spin_lock_init(&priv->lock);
+	spin_lock_init(&priv->mcast_lock);
+	INIT_WORK(&priv->mcast_work, emac_mcast_rebalance_work);
 
 	pdata = pdev->dev.platform_data;
 	if (!pdata) {
@@ -1941,6 +3115,7 @@ static int __devinit davinci_emac_probe(struct platform_device *pdev)
 
 	memset(&dma_params, 0, sizeof(dma_params));
 	dma_params.dev			= emac_dev;
+	priv->dma_dev			= dma_params.dev;
 	dma_params.dmaregs		= priv->emac_base;
 	dma_params.rxthresh		= priv->emac_base + 0x120;
 	dma_params.rxfree		= priv->emac_base + 0x140;
@@ -1964,13 +3139,27 @@ static int __devinit davinci_emac_probe(struct platform_device *pdev)
 		goto no_dma;
 	}
 
-	priv->txchan = cpdma_chan_create(priv->dma, tx_chan_num(EMAC_DEF_TX_CH),
-				       emac_tx_handler);
-	priv->rxchan = cpdma_chan_create(priv->dma, rx_chan_num(EMAC_DEF_RX_CH),
-				       emac_rx_handler);
-	if (WARN_ON(!priv->txchan || !priv->rxchan)) {
-		rc = -ENOMEM;
-		goto no_irq_res;
+	for (ch = 0; ch < EMAC_DEF_MAX_TX_CH; ch++) {
+		priv->txchan[ch] = cpdma_chan_create(priv->dma, tx_chan_num(ch),
+						     emac_tx_handler);
+		if (WARN_ON(IS_ERR_OR_NULL(priv->txchan[ch]))) {
+			priv->txchan[ch] = NULL;
+			rc = -ENOMEM;
+			goto no_irq_res;
+		}
+		cpdma_chan_set_batch_handler(priv->txchan[ch],
+					     emac_tx_batch_handler);
+	}
+	for (ch = 0; ch < EMAC_DEF_MAX_RX_CH; ch++) {
+		priv->rxchan[ch] = cpdma_chan_create(priv->dma, rx_chan_num(ch),
+						     emac_rx_handler);
+		if (WARN_ON(IS_ERR_OR_NULL(priv->rxchan[ch]))) {
+			priv->rxchan[ch] = NULL;
+			rc = -ENOMEM;
+			goto no_irq_res;
+		}
+		cpdma_chan_set_batch_handler(priv->rxchan[ch],
+					     emac_rx_batch_handler);
 	}
 
 	res = platform_get_resource(pdev, IORESOURCE_IRQ, 0);
@@ -1989,6 +3178,7 @@ static int __devinit davinci_emac_probe(struct platform_device *pdev)
 	}
 
 	ndev->netdev_ops = &emac_netdev_ops;
+	ndev->features |= NETIF_F_SG | NETIF_F_HW_CSUM | NETIF_F_GRO;
 	SET_ETHTOOL_OPS(ndev, &ethtool_ops);
 	netif_napi_add(ndev, &priv->napi, emac_poll, EMAC_POLL_WEIGHT);
 
@@ -2014,10 +3204,7 @@ static int __devinit davinci_emac_probe(struct platform_device *pdev)
 netdev_reg_err:
 	clk_disable(emac_clk);
 no_irq_res:
-	if (priv->txchan)
-		cpdma_chan_destroy(priv->txchan);
-	if (priv->rxchan)
-		cpdma_chan_destroy(priv->rxchan);
+	emac_chan_destroy_all(priv);
 	cpdma_ctlr_destroy(priv->dma);
 no_dma:
 	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
@@ -2048,10 +3235,7 @@ static int __devexit davinci_emac_remove(struct platform_device *pdev)
 	platform_set_drvdata(pdev, NULL);
 	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
 
-	if (priv->txchan)
-		cpdma_chan_destroy(priv->txchan);
-	if (priv->rxchan)
-		cpdma_chan_destroy(priv->rxchan);
+	emac_chan_destroy_all(priv);
 	cpdma_ctlr_destroy(priv->dma);
 
 	release_mem_region(res->start, res->end - res->start + 1);
@@ -181,6 +181,21 @@ enum {
 
 	/* ensure the originating sk reference is available on driver level */
 	SKBTX_DRV_NEEDS_SK_REF = 1 << 3,
+
+	/* frags are user pages, destructor_arg is a struct ubuf_info */
+	SKBTX_DEV_ZEROCOPY = 1 << 4,
+};
+
+/*
+ * The callback notifies the owner of zero-copy user pages once the last
+ * skb data area referencing them has been released.  Every data area
+ * carrying SKBTX_DEV_ZEROCOPY holds one reference on refcnt.
+ */
+struct ubuf_info {
+	void		(*callback)(struct ubuf_info *);
+	atomic_t	refcnt;
+	void		*ctx;
+	unsigned long	desc;
 };
 
 /* This data is invariant across clones and lives at
@@ -243,6 +258,9 @@ enum {
 	SKB_GSO_TCPV6 = 1 << 4,
 
 	SKB_GSO_FCOE = 1 << 5,
+
+	/* UDP datagram to be cut into gso_size datagrams (UDP_SEGMENT). */
+	SKB_GSO_UDP_L4 = 1 << 6,
 };
 
 #if BITS_PER_LONG > 32
@@ -573,6 +591,63 @@ static inline struct skb_shared_hwtstamps *skb_hwtstamps(struct sk_buff *skb)
 	return &skb_shinfo(skb)->hwtstamps;
 }
 
+static inline struct ubuf_info *skb_zcopy(struct sk_buff *skb)
+{
+	if (skb_shinfo(skb)->tx_flags & SKBTX_DEV_ZEROCOPY)
+		return skb_shinfo(skb)->destructor_arg;
+	return NULL;
+}
+
+/**
+ *	skb_zcopy_set - mark an skb's frags as zero-copy user pages
+ *	@skb: buffer
+ *	@uarg: completion to notify once the frags are released
+ */
+static inline void skb_zcopy_set(struct sk_buff *skb, struct ubuf_info *uarg)
+{
+	atomic_inc(&uarg->refcnt);
+	skb_shinfo(skb)->destructor_arg = uarg;
+	skb_shinfo(skb)->tx_flags |= SKBTX_DEV_ZEROCOPY;
+}
+
+static inline void skb_zcopy_put(struct ubuf_info *uarg)
+{
+	if (atomic_dec_and_test(&uarg->refcnt))
+		uarg->callback(uarg);
+}
+
+/**
+ *	skb_zcopy_clone - propagate zero-copy state to a copy of the frags
+ *	@nskb: buffer that took references on some of @skb's frags
+ *	@skb: zero-copy source buffer
+ */
+static inline void skb_zcopy_clone(struct sk_buff *nskb, struct sk_buff *skb)
+{
+	struct ubuf_info *uarg = skb_zcopy(skb);
+
+	if (uarg && !skb_zcopy(nskb))
+		skb_zcopy_set(nskb, uarg);
+}
+
+extern int skb_copy_ubufs(struct sk_buff *skb, gfp_t gfp_mask);
+extern int __skb_orphan_frags(struct sk_buff *skb, gfp_t gfp_mask);
+
+/**
+ *	skb_orphan_frags - make an skb's frags independent of the sender
+ *	@skb: buffer
+ *	@gfp_mask: allocation priority
+ *
+ *	Zero-copy user pages, of @skb and of the buffers on its frag_list,
+ *	are replaced by kernel copies; must be called before an skb is
+ *	looped back, cloned or delivered locally.
+ */
+static inline int skb_orphan_frags(struct sk_buff *skb, gfp_t gfp_mask)
+{
+	if (likely(!skb_zcopy(skb) && !skb_shinfo(skb)->frag_list))
+		return 0;
+	return __skb_orphan_frags(skb, gfp_mask);
+}
+
 /**
  *	skb_queue_empty - check if a queue is empty
  *	@list: queue head
@@ -54,6 +54,7 @@ struct ipcm_cookie {
 	int			oif;
 	struct ip_options	*opt;
 	__u8			tx_flags;
+	__u16			gso_size;
 };
 
 #define IPCB(skb) ((struct inet_skb_parm*)((skb)->cb))
@@ -190,6 +190,7 @@ struct sock_common {
   *	@sk_err_soft: errors that don't cause failure but are the cause of a
   *		      persistent failure not just 'timed out'
   *	@sk_drops: raw/udp drops counter
+  *	@sk_zckey: id of the next %MSG_ZEROCOPY send
   *	@sk_ack_backlog: current listen backlog
   *	@sk_max_ack_backlog: listen backlog set in listen()
   *	@sk_priority: %SO_PRIORITY setting
@@ -294,6 +295,7 @@ struct sock {
 	int			sk_err,
 				sk_err_soft;
 	atomic_t		sk_drops;
+	atomic_t		sk_zckey;
 	unsigned short		sk_ack_backlog;
 	unsigned short		sk_max_ack_backlog;
 	__u32			sk_priority;
@@ -1531,6 +1533,10 @@ extern int sock_queue_rcv_skb(struct sock *sk, struct sk_buff *skb);
 
 extern int sock_queue_err_skb(struct sock *sk, struct sk_buff *skb);
 
+extern struct ubuf_info *sock_zerocopy_alloc(struct sock *sk);
+extern void sock_zerocopy_copied(struct ubuf_info *uarg);
+extern void sock_zerocopy_abort(struct ubuf_info *uarg);
+
 /*
  *	Recover an error report and clear atomically
  */
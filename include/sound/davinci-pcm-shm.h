@@ -0,0 +1,41 @@
+/*
+ * DaVinci PCM shared-memory buffer provider
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef __SOUND_DAVINCI_PCM_SHM_H
+#define __SOUND_DAVINCI_PCM_SHM_H
+
+#include <linux/types.h>
+
+struct module;
+
+/*
+ * While a provider is registered, davinci-pcm allocates each stream's
+ * buffer from it at hw_params time, e.g. from a syslink SharedRegion, so
+ * a remote core can process the samples in place.  It is then told the
+ * DMA position, in bytes, each time a period has elapsed.
+ *
+ * A stream is identified by its PCM device number and direction
+ * (SNDRV_PCM_STREAM_*).  alloc() returns the CPU address of a page
+ * aligned buffer and sets its physical one, or returns NULL to have the
+ * stream use a normal buffer.
+ * period_elapsed() is called in interrupt context and must not sleep.
+ *
+ * A provider can only be unregistered once every buffer it handed out
+ * has been freed again.
+ */
+struct davinci_pcm_shm_ops {
+	struct module *owner;
+	void *(*alloc)(int device, int stream, size_t size, dma_addr_t *phys);
+	void (*free)(int device, int stream, void *buf, size_t size);
+	void (*period_elapsed)(int device, int stream, unsigned int pos);
+};
+
+extern int davinci_pcm_register_shm(struct davinci_pcm_shm_ops *ops);
+extern int davinci_pcm_unregister_shm(struct davinci_pcm_shm_ops *ops);
+
+#endif
@@ -327,6 +327,9 @@ static void skb_release_data(struct sk_buff *skb)
 				put_page(skb_shinfo(skb)->frags[i].page);
 		}
 
+		if (skb_zcopy(skb))
+			skb_zcopy_put(skb_zcopy(skb));
+
 		if (skb_has_frag_list(skb))
 			skb_drop_fraglist(skb);
 
@@ -593,6 +596,84 @@ struct sk_buff *skb_morph(struct sk_buff *dst, struct sk_buff *src)
 }
 EXPORT_SYMBOL_GPL(skb_morph);
 
+/**
+ *	skb_copy_ubufs	-	copy zero-copy user frags into kernel pages
+ *	@skb: buffer whose frags are MSG_ZEROCOPY user pages
+ *	@gfp_mask: allocation priority
+ *
+ *	Replaces every frag with a private copy and drops the buffer's
+ *	reference on the send completion, which is reported as copied.
+ *	Needed before the frags go anywhere but the device: a local
+ *	receiver would otherwise see the sender change the data, and the
+ *	completion would wait on that receiver.
+ *
+ *	Returns 0, or -ENOMEM with the buffer left as it was.
+ */
+int skb_copy_ubufs(struct sk_buff *skb, gfp_t gfp_mask)
+{
+	struct ubuf_info *uarg = skb_zcopy(skb);
+	int i, num_frags = skb_shinfo(skb)->nr_frags;
+	struct page *page, *head = NULL;
+
+	for (i = 0; i < num_frags; i++) {
+		skb_frag_t *f = &skb_shinfo(skb)->frags[i];
+		u8 *vaddr;
+
+		page = alloc_page(gfp_mask);
+		if (!page) {
+			while (head) {
+				page = (struct page *)head->private;
+				head->private = 0;
+				put_page(head);
+				head = page;
+			}
+			return -ENOMEM;
+		}
+		vaddr = kmap_skb_frag(f);
+		memcpy(page_address(page), vaddr + f->page_offset, f->size);
+		kunmap_skb_frag(vaddr);
+		page->private = (unsigned long)head;
+		head = page;
+	}
+
+	/* release the user pages, then point the frags at the copies */
+	for (i = 0; i < num_frags; i++)
+		put_page(skb_shinfo(skb)->frags[i].page);
+
+	for (i = num_frags - 1; i >= 0; i--) {
+		page = head;
+		head = (struct page *)page->private;
+		page->private = 0;
+		skb_shinfo(skb)->frags[i].page = page;
+		skb_shinfo(skb)->frags[i].page_offset = 0;
+	}
+
+	skb_shinfo(skb)->tx_flags &= ~SKBTX_DEV_ZEROCOPY;
+	sock_zerocopy_copied(uarg);
+	skb_zcopy_put(uarg);
+	return 0;
+}
+EXPORT_SYMBOL_GPL(skb_copy_ubufs);
+
+/*
+ *	Slow path of skb_orphan_frags(): corked zero-copy datagrams carry
+ *	user pages on every fragment of the frag_list, not just the head.
+ */
+int __skb_orphan_frags(struct sk_buff *skb, gfp_t gfp_mask)
+{
+	struct sk_buff *frag;
+
+	if (skb_zcopy(skb) && skb_copy_ubufs(skb, gfp_mask))
+		return -ENOMEM;
+
+	skb_walk_frags(skb, frag)
+		if (skb_orphan_frags(frag, gfp_mask))
+			return -ENOMEM;
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(__skb_orphan_frags);
+
 /**
  *	skb_clone	-	duplicate an sk_buff
  *	@skb: buffer to clone
@@ -611,6 +692,10 @@ struct sk_buff *skb_clone(struct sk_buff *skb, gfp_t gfp_mask)
 {
 	struct sk_buff *n;
 
+	/* a clone goes to a tap or a local receiver, never with user pages */
+	if (skb_orphan_frags(skb, gfp_mask))
+		return NULL;
+
 	n = skb + 1;
 	if (skb->fclone == SKB_FCLONE_ORIG &&
 	    n->fclone == SKB_FCLONE_UNAVAILABLE) {
@@ -733,6 +818,7 @@ struct sk_buff *pskb_copy(struct sk_buff *skb, gfp_t gfp_mask)
 			get_page(skb_shinfo(n)->frags[i].page);
 		}
 		skb_shinfo(n)->nr_frags = i;
+		skb_zcopy_clone(n, skb);
 	}
 
 	if (skb_has_frag_list(skb)) {
@@ -808,6 +894,10 @@ int pskb_expand_head(struct sk_buff *skb, int nhead, int ntail,
 		for (i = 0; i < skb_shinfo(skb)->nr_frags; i++)
 			get_page(skb_shinfo(skb)->frags[i].page);
 
+		/* the new data area holds its own zero-copy reference */
+		if (skb_zcopy(skb))
+			atomic_inc(&skb_zcopy(skb)->refcnt);
+
 		if (skb_has_frag_list(skb))
 			skb_clone_fraglist(skb);
 
@@ -2581,6 +2671,7 @@ struct sk_buff *skb_segment(struct sk_buff *skb, int features)
 		}
 
 		frag = skb_shinfo(nskb)->frags;
+		skb_zcopy_clone(nskb, skb);
 
 		skb_copy_from_linear_data_offset(skb, offset,
 						 skb_put(nskb, hsize), hsize);
@@ -2985,6 +3076,121 @@ int sock_queue_err_skb(struct sock *sk, struct sk_buff *skb)
 }
 EXPORT_SYMBOL(sock_queue_err_skb);
 
+struct sock_zerocopy {
+	struct ubuf_info	uarg;
+	struct sk_buff		*notify;
+	u8			copied;
+};
+
+static void sock_zerocopy_callback(struct ubuf_info *uarg)
+{
+	struct sock_zerocopy *zc = container_of(uarg, struct sock_zerocopy,
+						uarg);
+	struct sock *sk = uarg->ctx;
+	struct sk_buff *skb = zc->notify, *tail;
+	struct sock_exterr_skb *serr;
+	u8 code = zc->copied ? SO_EE_CODE_ZEROCOPY_COPIED : 0;
+	u32 id = uarg->desc;
+	unsigned long flags;
+	bool merged = false;
+
+	/* extend the id range of a pending notification when possible */
+	spin_lock_irqsave(&sk->sk_error_queue.lock, flags);
+	tail = skb_peek_tail(&sk->sk_error_queue);
+	if (tail) {
+		serr = SKB_EXT_ERR(tail);
+		if (serr->ee.ee_origin == SO_EE_ORIGIN_ZEROCOPY &&
+		    serr->ee.ee_code == code && serr->ee.ee_data + 1 == id) {
+			serr->ee.ee_data = id;
+			merged = true;
+		}
+	}
+	spin_unlock_irqrestore(&sk->sk_error_queue.lock, flags);
+
+	if (merged) {
+		kfree_skb(skb);
+	} else {
+		serr = SKB_EXT_ERR(skb);
+		memset(serr, 0, sizeof(*serr));
+		serr->ee.ee_origin = SO_EE_ORIGIN_ZEROCOPY;
+		serr->ee.ee_code = code;
+		serr->ee.ee_info = id;
+		serr->ee.ee_data = id;
+		if (sock_queue_err_skb(sk, skb))
+			kfree_skb(skb);
+	}
+
+	kfree(zc);
+	sock_put(sk);
+}
+
+/**
+ *	sock_zerocopy_alloc - set up a MSG_ZEROCOPY send completion
+ *	@sk: sending socket
+ *
+ *	Once the last skb referencing the send's user pages is released,
+ *	an SO_EE_ORIGIN_ZEROCOPY extended error is queued on @sk carrying
+ *	the send's id in ee_info and ee_data.  Ids count up per socket and
+ *	contiguous completions are merged into one ee_info..ee_data range.
+ *	The caller holds the initial reference and drops it with
+ *	skb_zcopy_put(), or with sock_zerocopy_abort() if no skb ever
+ *	took one.
+ */
+struct ubuf_info *sock_zerocopy_alloc(struct sock *sk)
+{
+	struct sock_zerocopy *zc;
+
+	zc = kmalloc(sizeof(*zc), sk->sk_allocation);
+	if (!zc)
+		return NULL;
+
+	/* allocated up front: completions run in atomic context */
+	zc->notify = alloc_skb(0, sk->sk_allocation);
+	if (!zc->notify) {
+		kfree(zc);
+		return NULL;
+	}
+
+	sock_hold(sk);
+	zc->copied = 0;
+	zc->uarg.callback = sock_zerocopy_callback;
+	zc->uarg.ctx = sk;
+	zc->uarg.desc = atomic_inc_return(&sk->sk_zckey) - 1;
+	atomic_set(&zc->uarg.refcnt, 1);
+	return &zc->uarg;
+}
+EXPORT_SYMBOL(sock_zerocopy_alloc);
+
+/**
+ *	sock_zerocopy_copied - report that a send fell back to copying
+ *	@uarg: send completion
+ */
+void sock_zerocopy_copied(struct ubuf_info *uarg)
+{
+	container_of(uarg, struct sock_zerocopy, uarg)->copied = 1;
+}
+EXPORT_SYMBOL(sock_zerocopy_copied);
+
+/**
+ *	sock_zerocopy_abort - drop a completion for a send that failed
+ *	@uarg: send completion, only referenced by the caller
+ *
+ *	No notification is queued.  The send's id is given back unless a
+ *	concurrent send on the socket has already taken the next one.
+ */
+void sock_zerocopy_abort(struct ubuf_info *uarg)
+{
+	struct sock_zerocopy *zc = container_of(uarg, struct sock_zerocopy,
+						uarg);
+	struct sock *sk = uarg->ctx;
+
+	atomic_cmpxchg(&sk->sk_zckey, uarg->desc + 1, uarg->desc);
+	kfree_skb(zc->notify);
+	kfree(zc);
+	sock_put(sk);
+}
+EXPORT_SYMBOL(sock_zerocopy_abort);
+
 void skb_tstamp_tx(struct sk_buff *orig_skb,
 		struct skb_shared_hwtstamps *hwtstamps)
 {
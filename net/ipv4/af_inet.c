@@ -1231,6 +1231,7 @@ static struct sk_buff *inet_gso_segment(struct sk_buff *skb, int features)
 	int proto;
 	int ihl;
 	int id;
+	int udpfrag;
 	unsigned int offset = 0;
 
 	if (!(features & NETIF_F_V4_CSUM))
@@ -1241,6 +1242,7 @@ static struct sk_buff *inet_gso_segment(struct sk_buff *skb, int features)
 		       SKB_GSO_UDP |
 		       SKB_GSO_DODGY |
 		       SKB_GSO_TCP_ECN |
+		       SKB_GSO_UDP_L4 |
 		       0)))
 		goto out;
 
@@ -1262,6 +1264,10 @@ static struct sk_buff *inet_gso_segment(struct sk_buff *skb, int features)
 	proto = iph->protocol & (MAX_INET_PROTOS - 1);
 	segs = ERR_PTR(-EPROTONOSUPPORT);
 
+	/* UFO makes IP fragments, UDP_SEGMENT makes whole datagrams */
+	udpfrag = proto == IPPROTO_UDP &&
+		  !(skb_shinfo(skb)->gso_type & SKB_GSO_UDP_L4);
+
 	rcu_read_lock();
 	ops = rcu_dereference(inet_protos[proto]);
 	if (likely(ops && ops->gso_segment))
@@ -1274,7 +1280,7 @@ static struct sk_buff *inet_gso_segment(struct sk_buff *skb, int features)
 	skb = segs;
 	do {
 		iph = ip_hdr(skb);
-		if (proto == IPPROTO_UDP) {
+		if (udpfrag) {
 			iph->id = htons(id);
 			iph->frag_off = htons(offset >> 3);
 			if (skb->next != NULL)
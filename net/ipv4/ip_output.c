@@ -125,6 +125,39 @@ static int ip_dev_loopback_xmit(struct sk_buff *newskb)
 	return 0;
 }
 
+/*
+ * Loop a copy of a multicast or broadcast datagram back to local
+ * listeners.  A UDP_SEGMENT train is cut into its datagrams first, so
+ * that they are received as they go out on the wire.
+ */
+static void ip_mc_loopback(struct sk_buff *skb)
+{
+	struct sk_buff *newskb = skb_clone(skb, GFP_ATOMIC);
+	struct sk_buff *segs;
+
+	if (!newskb)
+		return;
+
+	if (skb_is_gso(newskb)) {
+		segs = skb_gso_segment(newskb, 0);
+		kfree_skb(newskb);
+		if (IS_ERR_OR_NULL(segs))
+			return;
+
+		while (segs) {
+			newskb = segs;
+			segs = segs->next;
+			newskb->next = NULL;
+			NF_HOOK(NFPROTO_IPV4, NF_INET_POST_ROUTING, newskb,
+				NULL, newskb->dev, ip_dev_loopback_xmit);
+		}
+		return;
+	}
+
+	NF_HOOK(NFPROTO_IPV4, NF_INET_POST_ROUTING, newskb, NULL,
+		newskb->dev, ip_dev_loopback_xmit);
+}
+
 static inline int ip_select_ttl(struct inet_sock *inet, struct dst_entry *dst)
 {
 	int ttl = inet->uc_ttl;
@@ -269,13 +302,8 @@ int ip_mc_output(struct sk_buff *skb)
 		    ((rt->rt_flags & RTCF_LOCAL) ||
 		     !(IPCB(skb)->flags & IPSKB_FORWARDED))
 #endif
-		   ) {
-			struct sk_buff *newskb = skb_clone(skb, GFP_ATOMIC);
-			if (newskb)
-				NF_HOOK(NFPROTO_IPV4, NF_INET_POST_ROUTING,
-					newskb, NULL, newskb->dev,
-					ip_dev_loopback_xmit);
-		}
+		   )
+			ip_mc_loopback(skb);
 
 		/* Multicasts with ttl 0 must not go beyond the host */
 
@@ -285,12 +313,8 @@ int ip_mc_output(struct sk_buff *skb)
 		}
 	}
 
-	if (rt->rt_flags&RTCF_BROADCAST) {
-		struct sk_buff *newskb = skb_clone(skb, GFP_ATOMIC);
-		if (newskb)
-			NF_HOOK(NFPROTO_IPV4, NF_INET_POST_ROUTING, newskb,
-				NULL, newskb->dev, ip_dev_loopback_xmit);
-	}
+	if (rt->rt_flags&RTCF_BROADCAST)
+		ip_mc_loopback(skb);
 
 	return NF_HOOK_COND(NFPROTO_IPV4, NF_INET_POST_ROUTING, skb, NULL,
 			    skb->dev, ip_finish_output,
@@ -737,14 +761,16 @@ static inline int ip_ufo_append_data(struct sock *sk,
 			int getfrag(void *from, char *to, int offset, int len,
 			       int odd, struct sk_buff *skb),
 			void *from, int length, int hh_len, int fragheaderlen,
-			int transhdrlen, int mtu, unsigned int flags)
+			int transhdrlen, int gso_size, int gso_type,
+			unsigned int flags)
 {
 	struct sk_buff *skb;
 	int err;
 
 	/* There is support for UDP fragmentation offload by network
-	 * device, so create one single skb packet containing complete
-	 * udp datagram
+	 * device, or the datagram is to be segmented at transmit time
+	 * (UDP_SEGMENT), so create one single skb packet containing
+	 * complete udp datagram
 	 */
 	if ((skb = skb_peek_tail(&sk->sk_write_queue)) == NULL) {
 		skb = sock_alloc_send_skb(sk,
@@ -771,8 +797,8 @@ static inline int ip_ufo_append_data(struct sock *sk,
 		sk->sk_sndmsg_off = 0;
 
 		/* specify the length of each IP datagram fragment */
-		skb_shinfo(skb)->gso_size = mtu - fragheaderlen;
-		skb_shinfo(skb)->gso_type = SKB_GSO_UDP;
+		skb_shinfo(skb)->gso_size = gso_size;
+		skb_shinfo(skb)->gso_type = gso_type;
 		__skb_queue_tail(&sk->sk_write_queue, skb);
 	}
 
@@ -880,11 +906,31 @@ int ip_append_data(struct sock *sk,
 	skb = skb_peek_tail(&sk->sk_write_queue);
 
 	inet->cork.length += length;
+
+	/*
+	 * UDP_SEGMENT: queue the whole uncorked datagram as one skb and let
+	 * the GSO layer cut it into ipc->gso_size sized datagrams just
+	 * before the driver, so the stack is traversed once for all of them.
+	 */
+	if (ipc->gso_size && transhdrlen && !exthdrlen &&
+	    length > transhdrlen + ipc->gso_size) {
+		err = -EINVAL;
+		if (fragheaderlen + transhdrlen + ipc->gso_size > mtu)
+			goto error;
+		err = ip_ufo_append_data(sk, getfrag, from, length, hh_len,
+					 fragheaderlen, transhdrlen,
+					 ipc->gso_size, SKB_GSO_UDP_L4, flags);
+		if (err)
+			goto error;
+		return 0;
+	}
+
 	if (((length > mtu) || (skb && skb_is_gso(skb))) &&
 	    (sk->sk_protocol == IPPROTO_UDP) &&
 	    (rt->dst.dev->features & NETIF_F_UFO)) {
 		err = ip_ufo_append_data(sk, getfrag, from, length, hh_len,
-					 fragheaderlen, transhdrlen, mtu,
+					 fragheaderlen, transhdrlen,
+					 mtu - fragheaderlen, SKB_GSO_UDP,
 					 flags);
 		if (err)
 			goto error;
@@ -1305,7 +1351,11 @@ int ip_push_pending_frames(struct sock *sk)
 	}
 	iph->tos = inet->tos;
 	iph->frag_off = df;
-	ip_select_ident(iph, &rt->dst, sk);
+	if (skb_shinfo(skb)->gso_type & SKB_GSO_UDP_L4)
+		ip_select_ident_more(iph, &rt->dst, sk,
+				     skb_shinfo(skb)->gso_segs - 1);
+	else
+		ip_select_ident(iph, &rt->dst, sk);
 	iph->ttl = ttl;
 	iph->protocol = sk->sk_protocol;
 	iph->saddr = rt->rt_src;
@@ -1394,6 +1444,7 @@ void ip_send_reply(struct sock *sk, struct sk_buff *skb, struct ip_reply_arg *ar
 	daddr = ipc.addr = rt->rt_src;
 	ipc.opt = NULL;
 	ipc.tx_flags = 0;
+	ipc.gso_size = 0;
 
 	if (replyopts.opt.optlen) {
 		ipc.opt = &replyopts.opt;
@@ -725,6 +725,9 @@ static int udp_push_pending_frames(struct sock *sk)
 	 * Create a UDP header
 	 */
 	uh = udp_hdr(skb);
+	if (skb_shinfo(skb)->gso_type & SKB_GSO_UDP_L4)
+		skb_shinfo(skb)->gso_segs = DIV_ROUND_UP(up->len - sizeof(*uh),
+						skb_shinfo(skb)->gso_size);
 	uh->source = fl->fl_ip_sport;
 	uh->dest = fl->fl_ip_dport;
 	uh->len = htons(up->len);
@@ -769,6 +772,156 @@ out:
 	return err;
 }
 
+/*
+ *	Pin the user pages of a datagram for MSG_ZEROCOPY.  Returns the number
+ *	of pages pinned, 0 if the datagram has to be copied after all (too
+ *	many pages for one skb) or a negative error code.
+ */
+static int udp_zerocopy_pin(struct msghdr *msg, size_t len,
+			    struct page **pages, unsigned int *offs,
+			    unsigned int *lens)
+{
+	struct iovec *iov = msg->msg_iov;
+	unsigned long addr, seg;
+	unsigned int off;
+	int i, n = 0, nr, ret;
+
+	for (i = 0; i < msg->msg_iovlen && len; i++, iov++) {
+		addr = (unsigned long)iov->iov_base;
+		seg = min_t(size_t, iov->iov_len, len);
+		len -= seg;
+		if (!seg)
+			continue;
+
+		off = addr & ~PAGE_MASK;
+		nr = DIV_ROUND_UP(off + seg, PAGE_SIZE);
+		if (n + nr > MAX_SKB_FRAGS) {
+			ret = 0;
+			goto unpin;
+		}
+
+		ret = get_user_pages_fast(addr & PAGE_MASK, nr, 0, pages + n);
+		if (ret < nr) {
+			while (ret > 0)
+				put_page(pages[n + --ret]);
+			ret = -EFAULT;
+			goto unpin;
+		}
+
+		for (nr += n; n < nr; n++) {
+			offs[n] = off;
+			lens[n] = min_t(unsigned long, PAGE_SIZE - off, seg);
+			seg -= lens[n];
+			off = 0;
+		}
+	}
+	return n;
+
+unpin:
+	while (n > 0)
+		put_page(pages[--n]);
+	return ret;
+}
+
+/*
+ *	MSG_ZEROCOPY: attach the pinned user pages to the datagram as page
+ *	frags instead of copying them, the way udp_sendpage() appends pages.
+ *	The application learns from the socket error queue when the device
+ *	has released the pages and the buffer may be reused.  Corked sends,
+ *	UDP-Lite and routes whose device cannot do scatter-gather are copied
+ *	and reported with SO_EE_CODE_ZEROCOPY_COPIED.
+ */
+static int udp_sendmsg_zerocopy(struct kiocb *iocb, struct sock *sk,
+				struct msghdr *msg, size_t len)
+{
+	struct udp_sock *up = udp_sk(sk);
+	struct page *pages[MAX_SKB_FRAGS];
+	unsigned int offs[MAX_SKB_FRAGS], lens[MAX_SKB_FRAGS];
+	struct msghdr hmsg = *msg;
+	struct ubuf_info *uarg;
+	struct sk_buff *skb;
+	int i, n = 0, err;
+
+	hmsg.msg_flags &= ~MSG_ZEROCOPY;
+	if (len > 0xFFFF)
+		return -EMSGSIZE;
+
+	uarg = sock_zerocopy_alloc(sk);
+	if (!uarg)
+		return -ENOBUFS;
+
+	if (up->pending || up->corkflag || (msg->msg_flags & MSG_MORE) ||
+	    IS_UDPLITE(sk))
+		goto copy;
+
+	n = udp_zerocopy_pin(msg, len, pages, offs, lens);
+	if (n < 0) {
+		sock_zerocopy_abort(uarg);
+		return n;
+	}
+	if (!n)
+		goto copy;
+
+	/* set up the cork and the headers, then append the pages */
+	hmsg.msg_flags |= MSG_MORE;
+	err = udp_sendmsg(iocb, sk, &hmsg, 0);
+	if (err < 0)
+		goto abort;
+
+	lock_sock(sk);
+	if (unlikely(!up->pending)) {
+		release_sock(sk);
+		err = -EINVAL;
+		goto abort;
+	}
+
+	for (i = 0; i < n; i++) {
+		err = ip_append_page(sk, pages[i], offs[i], lens[i],
+				     msg->msg_flags);
+		if (err < 0)
+			break;
+	}
+	if (err < 0) {
+		udp_flush_pending_frames(sk);
+		release_sock(sk);
+		if (err != -EOPNOTSUPP)
+			goto abort;
+		while (n > 0)
+			put_page(pages[--n]);
+		goto copy;
+	}
+
+	skb_queue_walk(&sk->sk_write_queue, skb)
+		if (skb_shinfo(skb)->nr_frags)
+			skb_zcopy_set(skb, uarg);
+
+	up->len += len;
+	err = udp_push_pending_frames(sk);
+	release_sock(sk);
+
+	while (n > 0)
+		put_page(pages[--n]);
+	skb_zcopy_put(uarg);
+	return err ? err : len;
+
+copy:
+	sock_zerocopy_copied(uarg);
+	hmsg.msg_flags = msg->msg_flags & ~MSG_ZEROCOPY;
+	err = udp_sendmsg(iocb, sk, &hmsg, len);
+	if (err < 0) {
+		sock_zerocopy_abort(uarg);
+		return err;
+	}
+	skb_zcopy_put(uarg);
+	return err;
+
+abort:
+	while (n > 0)
+		put_page(pages[--n]);
+	sock_zerocopy_abort(uarg);
+	return err;
+}
+
 int udp_sendmsg(struct kiocb *iocb, struct sock *sk, struct msghdr *msg,
 		size_t len)
 {
@@ -789,6 +942,9 @@ int udp_sendmsg(struct kiocb *iocb, struct sock *sk, struct msghdr *msg,
 	if (len > 0xFFFF)
 		return -EMSGSIZE;
 
+	if (msg->msg_flags & MSG_ZEROCOPY)
+		return udp_sendmsg_zerocopy(iocb, sk, msg, len);
+
 	/*
 	 *	Check the flags.
 	 */
@@ -798,6 +954,7 @@ int udp_sendmsg(struct kiocb *iocb, struct sock *sk, struct msghdr *msg,
 
 	ipc.opt = NULL;
 	ipc.tx_flags = 0;
+	ipc.gso_size = 0;
 
 	if (up->pending) {
 		/*
@@ -925,6 +1082,11 @@ back_from_confirm:
 	if (!ipc.addr)
 		daddr = ipc.addr = rt->rt_dst;
 
+	/* UDP_SEGMENT: hand one datagram train to ip_append_data() */
+	if (up->gso_size && !corkreq && !is_udplite &&
+	    sk->sk_no_check != UDP_CSUM_NOXMIT)
+		ipc.gso_size = up->gso_size;
+
 	lock_sock(sk);
 	if (unlikely(up->pending)) {
 		/* The socket is already corked while preparing it. */
@@ -1751,6 +1913,15 @@ int udp_lib_setsockopt(struct sock *sk, int level, int optname,
 		up->pcflag |= UDPLITE_RECV_CC;
 		break;
 
+	/* Payload size of the datagrams a large send is cut into (IPv4). */
+	case UDP_SEGMENT:
+		if (is_udplite || sk->sk_family != AF_INET)
+			return -ENOPROTOOPT;
+		if (val < 0 || val > USHRT_MAX)
+			return -EINVAL;
+		up->gso_size = val;
+		break;
+
 	default:
 		err = -ENOPROTOOPT;
 		break;
@@ -1813,6 +1984,12 @@ int udp_lib_getsockopt(struct sock *sk, int level, int optname,
 		val = up->pcrlen;
 		break;
 
+	case UDP_SEGMENT:
+		if (sk->sk_family != AF_INET)
+			return -ENOPROTOOPT;
+		val = up->gso_size;
+		break;
+
 	default:
 		return -ENOPROTOOPT;
 	}
@@ -2201,6 +2378,66 @@ int udp4_ufo_send_check(struct sk_buff *skb)
 	return 0;
 }
 
+/*
+ * UDP_SEGMENT: cut the payload into gso_size pieces and give each its own
+ * UDP header and checksum.  IP ids and lengths are fixed up by
+ * inet_gso_segment().
+ */
+static struct sk_buff *udp4_gso_segment(struct sk_buff *skb, int features)
+{
+	struct sk_buff *segs = ERR_PTR(-EINVAL);
+	unsigned int mss = skb_shinfo(skb)->gso_size;
+	struct sk_buff *seg;
+	struct udphdr *uh;
+	struct iphdr *iph;
+	unsigned int len;
+
+	if (unlikely(skb->len <= sizeof(*uh) + mss))
+		goto out;
+
+	if (skb_gso_ok(skb, features | NETIF_F_GSO_ROBUST)) {
+		/* Packet is from an untrusted source, reset gso_segs. */
+		skb_shinfo(skb)->gso_segs = DIV_ROUND_UP(skb->len - sizeof(*uh),
+							 mss);
+		segs = NULL;
+		goto out;
+	}
+
+	if (unlikely(!pskb_may_pull(skb, sizeof(*uh))))
+		goto out;
+
+	__skb_pull(skb, sizeof(*uh));
+	segs = skb_segment(skb, features);
+	if (IS_ERR(segs))
+		goto out;
+
+	for (seg = segs; seg; seg = seg->next) {
+		iph = ip_hdr(seg);
+		uh = udp_hdr(seg);
+		len = seg->len - skb_transport_offset(seg);
+		uh->len = htons(len);
+
+		if (seg->ip_summed == CHECKSUM_PARTIAL) {
+			uh->check = ~csum_tcpudp_magic(iph->saddr, iph->daddr,
+						       len, IPPROTO_UDP, 0);
+			seg->csum_start = skb_transport_header(seg) - seg->head;
+			seg->csum_offset = offsetof(struct udphdr, check);
+			continue;
+		}
+
+		/* skb_segment() summed the payload while copying it */
+		uh->check = 0;
+		uh->check = csum_tcpudp_magic(iph->saddr, iph->daddr, len,
+					      IPPROTO_UDP,
+					      csum_partial(uh, sizeof(*uh),
+							   seg->csum));
+		if (uh->check == 0)
+			uh->check = CSUM_MANGLED_0;
+	}
+out:
+	return segs;
+}
+
 struct sk_buff *udp4_ufo_fragment(struct sk_buff *skb, int features)
 {
 	struct sk_buff *segs = ERR_PTR(-EINVAL);
@@ -2208,6 +2445,9 @@ struct sk_buff *udp4_ufo_fragment(struct sk_buff *skb, int features)
 	int offset;
 	__wsum csum;
 
+	if (skb_shinfo(skb)->gso_type & SKB_GSO_UDP_L4)
+		return udp4_gso_segment(skb, features);
+
 	mss = skb_shinfo(skb)->gso_size;
 	if (unlikely(skb->len <= mss))
 		goto out;
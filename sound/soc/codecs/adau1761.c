@@ -21,6 +21,7 @@
 #include <sound/adau17x1.h>
 
 #include "adau17x1.h"
+#include "sigma.h"
 
 #include "microburst-sigmadsp.h"
 
@@ -401,52 +402,6 @@ uint32_t MICROBURST_SIGMADSP_EQ_PANEL_STAGE_7_FIXPT_BOOST[21][5] = {
 //uint32_t MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[4] = { MOD_RX_EQ_RX_EQ_PANEL_ALG0_DATA_ADR_FIXPT, MOD_RX_EQ_RX_EQ_PANEL_ALG0_DATAR_ADR_FIXPT, MOD_RX_EQ_RX_EQ_PANEL_ALG0_COEFF_ADR_FIXPT, MOD_RX_EQ_RX_EQ_PANEL_ALG0_LOOP_FIXPT }; /*  */
 
 
-/* Safeload write function for SigmaDSP Firmware parameters */
-
-static int adau1761_safeload_write(struct adau *adau, uint32_t addr, uint32_t *data,
-          unsigned int size)
-{
-          unsigned int i;
-          int ret;
-          uint32_t bytes_to_write = size/4;
-          uint32_t data_swapped[(size/4)];
-         // printk (KERN_DEBUG "MB-sigmadsp: register safeload write addr %d size %d\n", addr, size);
-
-          if (size/4 > 5)
-                    return -EINVAL;
-          for (i = 0; i < size/4; i++)
-          {
-            // printk (KERN_DEBUG "MB-sigmadsp: %d: %08X\n", addr+i, data[i]);
-              data_swapped[i] = htonl(data[i]);
-          }
-
-          for (i = 0; i < size/4; i++)
-          {
-          	//printk (KERN_DEBUG "MB-sigmadsp: safeload regmap write addr %d data %08X\n", ADAU1761_SAFELOAD_DATA(i), data_swapped[i]);
-          		ret = regmap_raw_write(adau->regmap, ADAU1761_SAFELOAD_DATA(i), &data_swapped[i], 4);
-          	if (ret)
-                    	return ret;
-          }
-
-//          addr = htonl(addr - 1);
-          addr = addr - 0x0001;
-          addr = htonl(addr);
-          //printk (KERN_DEBUG "MB-sigmadsp: safeload regmap write addr %08X data %08X\n", ADAU1761_SAFELOAD_ADDR, addr);
-          ret = regmap_raw_write(adau->regmap, ADAU1761_SAFELOAD_ADDR, &addr, 4);
-          if (ret)
-                    return ret;
-          //printk (KERN_DEBUG "MB-sigmadsp: safeload regmap write addr %08X data %08X\n", ADAU1761_SAFELOAD_SIZE, size/4);
-          bytes_to_write = htonl(bytes_to_write);
-          ret = regmap_raw_write(adau->regmap, ADAU1761_SAFELOAD_SIZE, &bytes_to_write , 4);
-          if (ret)
-                    return ret;
-
-          /* Wait for the operation to finish */
-          udelay(60);
-
-          return 0;
-}
-
 /* Block write function for SigmaDSP Firmware parameters     */
 
 static int adau1761_block_write(struct adau *adau, uint32_t addr, uint32_t *data,
@@ -464,172 +419,178 @@ static int adau1761_block_write(struct adau *adau, uint32_t addr, uint32_t *data
         	  //printk (KERN_DEBUG "MB-sigmadsp: blockwrite regmap write addr %08X data %08X\n", addr, data_swapped[i]);
           }
 
+          sigma_dsp_invalidate_range(adau->sigma, addr, size / 4);
           ret = regmap_raw_write(adau->regmap, addr, data_swapped, size);
 		  return ret;
 };
 
-/* 
- * TODO: Update for your system's data type
+/*
+ * SigmaDSP parameter transactions
+ *
+ * A safeload hands the DSP up to five words, which it copies to parameter
+ * RAM at the start of the next audio frame, so a coefficient set never
+ * runs half updated.  The data slots, the target address and the word
+ * count are consecutive, so each safeload goes out as a single I2C burst
+ * ending with the count, which triggers it.
+ *
+ * Writes are queued in a transaction and issued back to back by
+ * adau1761_param_commit() with the safeload slots held, so updates made of
+ * several biquads or blocks are not interleaved with other controls.
+ * Rather than busy-waiting after every load, the next one only waits for
+ * whatever is left of the previous one's frame; the I2C transfer normally
+ * covers it.
  */
-typedef unsigned short ADI_DATA_U16;
-typedef unsigned char  ADI_REG_TYPE;
+#define ADAU1761_SAFELOAD_WORDS		5
+/* a safeload has run after this long, three frames at 48 kHz */
+#define ADAU1761_SAFELOAD_US		60
+#define ADAU1761_PARAM_TXN_MAX		8
 
-
-
-/* Microburst SigmaDSP kcontrol definitions */
-
-static const unsigned int microburst_sigmadsp_input_source_values[] = {
-		0, 1, 2,
+struct adau1761_param_write {
+	uint32_t addr;
+	unsigned int words;
+	bool safeload;
+	uint32_t data[ADAU1761_SAFELOAD_WORDS];
 };
 
-static const char * const microburst_sigmadsp_input_source_text[] = {
-		"Signal Generator", "Balanced Input", "Microphone",
+struct adau1761_param_txn {
+	struct adau *adau;
+	unsigned int count;
+	int error;
+	struct adau1761_param_write w[ADAU1761_PARAM_TXN_MAX];
 };
 
-static const char * const microburst_sigmadsp_monitor_voice_cw_text[] = {
-		"Monitor Voice", "Monitor CW",
-};
+static void adau1761_param_begin(struct adau1761_param_txn *txn,
+	struct adau *adau)
+{
+	txn->adau = adau;
+	txn->count = 0;
+	txn->error = 0;
+}
 
+static void adau1761_param_queue(struct adau1761_param_txn *txn,
+	bool safeload, uint32_t addr, const uint32_t *data, unsigned int size)
+{
+	struct adau1761_param_write *w;
+	unsigned int words = size / 4;
+	unsigned int n;
+
+	while (words && !txn->error) {
+		w = txn->count ? &txn->w[txn->count - 1] : NULL;
+		/* coalesce with the previous write when it continues it */
+		if (!w || w->safeload != safeload ||
+		    w->addr + w->words != addr ||
+		    w->words == ADAU1761_SAFELOAD_WORDS) {
+			if (txn->count == ADAU1761_PARAM_TXN_MAX) {
+				txn->error = -ENOSPC;
+				return;
+			}
+			w = &txn->w[txn->count++];
+			w->safeload = safeload;
+			w->addr = addr;
+			w->words = 0;
+		}
+		n = min(words, ADAU1761_SAFELOAD_WORDS - w->words);
+		memcpy(&w->data[w->words], data, n * 4);
+		w->words += n;
+		addr += n;
+		data += n;
+		words -= n;
+	}
+}
 
-static int microburst_sigmadsp_rx_mute_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
+/* Queue a write through the safeload slots, split in five word loads */
+static void adau1761_param_safeload(struct adau1761_param_txn *txn,
+	uint32_t addr, const uint32_t *data, unsigned int size)
 {
-	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_3_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
-};
-
+	adau1761_param_queue(txn, true, addr, data, size);
+}
 
-static int microburst_sigmadsp_rx_mute_set(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
+/* Queue a direct write, for values that need not change atomically */
+static void adau1761_param_block(struct adau1761_param_txn *txn,
+	uint32_t addr, const uint32_t *data, unsigned int size)
 {
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-  uint32_t mute_addr =        MOD_RX_MUTE_MUTENOSLEWALG1MUTE_ADDR;
- //MOD_RX_MUTE_ALG0_MUTEONOFF_ADDR;
+	adau1761_param_queue(txn, false, addr, data, size);
+}
 
+static int adau1761_safeload_burst(struct adau *adau,
+	const struct adau1761_param_write *w)
+{
+	uint32_t buf[ADAU1761_SAFELOAD_WORDS + 2];
+	unsigned int i;
+	s64 wait;
+	int ret;
 
-        int state;
-        uint32_t mute_rx = MICROBURST_SIGMADSP_FIXPT_ONE;
-	uint32_t unmute = MICROBURST_SIGMADSP_FIXPT_ZERO;
+	memset(buf, 0, sizeof(buf));
+	for (i = 0; i < w->words; i++)
+		buf[i] = htonl(w->data[i]);
+	buf[ADAU1761_SAFELOAD_ADDR - ADAU1761_SAFELOAD_DATA(0)] =
+		htonl(w->addr - 0x0001);
+	buf[ADAU1761_SAFELOAD_SIZE - ADAU1761_SAFELOAD_DATA(0)] =
+		htonl(w->words);
+
+	/* the slots are about to be reused, the previous load must have run */
+	wait = ktime_us_delta(adau->safeload_done, ktime_get());
+	if (wait > 0)
+		usleep_range(wait, wait + 20);
+
+	sigma_dsp_invalidate_range(adau->sigma, w->addr, w->words);
+	ret = regmap_raw_write(adau->regmap, ADAU1761_SAFELOAD_DATA(0),
+			buf, sizeof(buf));
+	if (ret)
+		return ret;
 
-        state = ucontrol->value.integer.value[0];
+	adau->safeload_done = ktime_add_us(ktime_get(), ADAU1761_SAFELOAD_US);
+	return 0;
+}
 
-	//printk (KERN_DEBUG "MB-codecdsp: microburst_sigmadsp_cw_key_put called.  Key state: %d\n", key_state);
-	if (state) {
-            	adau1761_safeload_write(adau, mute_addr, &mute_rx, 4);
-	}
-	else  {
-            	adau1761_safeload_write(adau, mute_addr, &unmute, 4);
-		
-	}
+static int adau1761_param_commit(struct adau1761_param_txn *txn)
+{
+	struct adau *adau = txn->adau;
+	struct adau1761_param_write *w;
+	unsigned int i;
+	int ret = txn->error;
 
-        //        printk (KERN_CRIT  "MB-sigmadsp: RX MUTE SET = 0x%08X", state);
+	if (ret)
+		return ret;
 
-	return 0;
-};
+	mutex_lock(&adau->safeload_lock);
+	for (i = 0; i < txn->count && !ret; i++) {
+		w = &txn->w[i];
+		if (w->safeload)
+			ret = adau1761_safeload_burst(adau, w);
+		else
+			ret = adau1761_block_write(adau, w->addr, w->data,
+					w->words * 4);
+	}
+	mutex_unlock(&adau->safeload_lock);
 
+	return ret;
+}
 
-/* Microburst SigmaDSP kcontrol functions */
+/* 
+ * TODO: Update for your system's data type
+ */
+typedef unsigned short ADI_DATA_U16;
+typedef unsigned char  ADI_REG_TYPE;
 
-static int microburst_sigmadsp_cw_key_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-codecdsp: microburst_sigmadsp_cw_key_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
-};
 
-static int microburst_sigmadsp_cw_key_put(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-	int key_state;
-	uint32_t cw_key_addr = MOD_CW_KEY_ISON_ADDR;
-	uint32_t key_down = MICROBURST_SIGMADSP_FIXPT_ONE;
-	uint32_t key_up = MICROBURST_SIGMADSP_FIXPT_ZERO;
-	key_state = ucontrol->value.integer.value[0];
-
-	//printk (KERN_DEBUG "MB-codecdsp: microburst_sigmadsp_cw_key_put called.  Key state: %d\n", key_state);
-	if (key_state) {
-		////printk ("MB-codecdsp: setting key down state\n");
-		adau1761_block_write(adau, cw_key_addr, &key_down ,sizeof(key_down));
-	}
-	else  {
-		////printk ("MB-codecdsp: setting key up state\n");
-		adau1761_block_write(adau, cw_key_addr, &key_up, sizeof(key_up));
-	}
-	return 0;
-};
 
+/* Microburst SigmaDSP kcontrol definitions */
 
-static int microburst_sigmadsp_cw_key_rx_mute_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-codecdsp: microburst_sigmadsp_cw_key_rx_mute_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
+static const unsigned int microburst_sigmadsp_input_source_values[] = {
+		0, 1, 2,
 };
 
-static int microburst_sigmadsp_cw_key_rx_mute_put(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-	int key_state;
-	uint32_t cw_key_addr = MOD_CW_KEY_RX_MUTE_ISON_ADDR;
-	uint32_t key_down = MICROBURST_SIGMADSP_FIXPT_ONE;
-	uint32_t key_up = MICROBURST_SIGMADSP_FIXPT_ZERO;
-	key_state = ucontrol->value.integer.value[0];
-
-	//printk (KERN_DEBUG "MB-codecdsp: microburst_sigmadsp_cw_key_rx_mute_put called.  Key state: %d\n", key_state);
-	if (key_state) {
-		////printk ("MB-codecdsp: setting key down mute state\n");
-		adau1761_block_write(adau, cw_key_addr, &key_down ,sizeof(key_down));
-	}
-	else  {
-		////printk ("MB-codecdsp: setting key up mute state\n");
-		adau1761_block_write(adau, cw_key_addr, &key_up, sizeof(key_up));
-	}
-	return 0;
+static const char * const microburst_sigmadsp_input_source_text[] = {
+		"Signal Generator", "Balanced Input", "Microphone",
 };
 
-
-static int microburst_sigmadsp_monitor_voice_cw_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_voice_cw_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
+static const char * const microburst_sigmadsp_monitor_voice_cw_text[] = {
+		"Monitor Voice", "Monitor CW",
 };
 
-static int microburst_sigmadsp_monitor_voice_cw_put(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_voice_cw_put called\n");
-	uint32_t buf[2];
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-	int mon_cw;		//monitor CW is state 1, monitor Voice is state 0
-	uint32_t mux_addr = MOD_MONITOR_VOICE_CW_ALG0_STAGE0_STEREOSWITCHNOSLEW_ADDR;
-	mon_cw = ucontrol->value.integer.value[0];
-	if (mon_cw)
-	{
-		buf[0] = MICROBURST_SIGMADSP_FIXPT_ZERO;
-		buf[1] = MICROBURST_SIGMADSP_FIXPT_ONE;
-	}
-	else
-	{
-		buf[0] = MICROBURST_SIGMADSP_FIXPT_ONE;
-		buf[1] = MICROBURST_SIGMADSP_FIXPT_ZERO;
-	}
-
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor voice cw setting to %d\n", mon_cw);
-	adau1761_block_write(adau, mux_addr, buf, 8);
 
-	return 0;
-};
+/* Microburst SigmaDSP kcontrol functions */
 
 static int microburst_sigmadsp_compander_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
@@ -944,197 +905,6 @@ static int microburst_sigmadsp_sig_gen_select_put(struct snd_kcontrol *kcontrol,
 	return 0;
 };
 
-static int microburst_sigmadsp_cw_monitor_level_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_level_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
-};
-
-static int microburst_sigmadsp_cw_monitor_level_put(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_level_put called\n");
-	uint32_t buf;
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-	int monitor_level;
-        uint32_t mux_addr = MOD_CW_MONITOR_LEVEL_GAIN1940ALGNS2_ADDR;
-        //	uint32_t mux_addr = MOD_MONITOR_LEVEL_GAIN1940ALGNS2_ADDR;
-	monitor_level = ucontrol->value.integer.value[0];
-	buf = MICROBURST_SIGMADSP_FIXPT_LEVEL_LOOKUP_64_STEP_MINUS_96_TO_ZERO[monitor_level];
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_level setting to %d\n", monitor_level);
-	adau1761_block_write(adau, mux_addr, &buf, 4);
-
-	return 0;
-};
-
-static int microburst_sigmadsp_voice_monitor_level_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_level_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
-};
-
-static int microburst_sigmadsp_voice_monitor_level_put(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_level_put called\n");
-	uint32_t buf;
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-	int monitor_level;
-        uint32_t mux_addr = MOD_VOICE_MONITOR_LEVEL_GAIN1940ALGNS8_ADDR;
-        //	uint32_t mux_addr = MOD_MONITOR_LEVEL_GAIN1940ALGNS2_ADDR;
-	monitor_level = ucontrol->value.integer.value[0];
-	buf = MICROBURST_SIGMADSP_FIXPT_LEVEL_LOOKUP_64_STEP_MINUS_96_TO_ZERO[monitor_level];
-	//printk (KERN_DEBUG "MB-sigmadsp: monitor_level setting to %d\n", monitor_level);
-	adau1761_block_write(adau, mux_addr, &buf, 4);
-
-	return 0;
-};
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_voice_monitor_left_pan_get(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value;
-
-  regmap_raw_read(adau->regmap, MOD_SB_MON_LEFT_PAN_GAIN1940ALGNS9_ADDR, &value, 4);
-  value = htonl(value);
-  ucontrol->value.integer.value[0] = value ; // 20 * log10(value) ! 
-  return 0;
-};
-// Conversion needs to be done in Firmware
-static int microburst_sigmadsp_voice_monitor_left_pan_put(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value[1];
-
-  value[0] = ucontrol->value.integer.value[0]; // Convert by  pow( 10.0, (ucontrol->value.integer.value[0] - 90) / 20.0);
-  adau1761_block_write(adau, MOD_SB_MON_LEFT_PAN_GAIN1940ALGNS9_ADDR, value, 4);
-  return 0;
-};
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_voice_monitor_right_pan_get(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value;
-
-  regmap_raw_read(adau->regmap,MOD_SB_MON_RIGHT_PAN_GAIN1940ALGNS10_ADDR, &value, 4);
-  value = htonl(value);
-  ucontrol->value.integer.value[0] = value ; // 20 * log10(value) ! 
-  return 0;
-};
-// Conversion needs to be done in Firmware
-static int microburst_sigmadsp_voice_monitor_right_pan_put(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value[1];
-
-  value[0] = ucontrol->value.integer.value[0]; // Convert by  pow( 10.0, (ucontrol->value.integer.value[0] - 90) / 20.0);
-  adau1761_block_write(adau, MOD_SB_MON_RIGHT_PAN_GAIN1940ALGNS10_ADDR, value, 4);
-  return 0;
-};
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_cw_monitor_left_pan_get(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value;
-
-  regmap_raw_read(adau->regmap, MOD_CW_MON_LEFT_PAN_GAIN1940ALGNS11_ADDR, &value, 4);
-  value = htonl(value);
-  ucontrol->value.integer.value[0] = value ; // 20 * log10(value) ! 
-  return 0;
-};
-// Conversion needs to be done in Firmware
-static int microburst_sigmadsp_cw_monitor_left_pan_put(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value[1];
-
-  value[0] = ucontrol->value.integer.value[0]; // Convert by  pow( 10.0, (ucontrol->value.integer.value[0] - 90) / 20.0);
-  adau1761_block_write(adau, MOD_CW_MON_LEFT_PAN_GAIN1940ALGNS11_ADDR, value, 4);
-  return 0;
-};
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_cw_monitor_right_pan_get(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value;
-
-  regmap_raw_read(adau->regmap, MOD_CW_MON_RIGHT_PAN_GAIN1940ALGNS12_ADDR, &value, 4);
-  value = htonl(value);
-  ucontrol->value.integer.value[0] = value ; // 20 * log10(value) ! 
-  return 0;
-};
-// Conversion needs to be done in Firmware
-static int microburst_sigmadsp_cw_monitor_right_pan_put(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value[1];
-
-  value[0] = ucontrol->value.integer.value[0]; // Convert by  pow( 10.0, (ucontrol->value.integer.value[0] - 90) / 20.0);
-  adau1761_block_write(adau, MOD_CW_MON_RIGHT_PAN_GAIN1940ALGNS12_ADDR, value, 4);
-  return 0;
-};
-
-
-
-static int microburst_sigmadsp_sig_gen_level_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: sig_gen_level_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
-};
-
-static int microburst_sigmadsp_sig_gen_level_put(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: sig_gen_level_put called\n");
-	uint32_t buf;
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-	int sig_gen_level;
-	uint32_t mux_addr = MOD_SIGGEN_SIG_GEN_LEVEL_GAIN1940ALGNS3_ADDR;
-	sig_gen_level = ucontrol->value.integer.value[0];
-	buf = MICROBURST_SIGMADSP_FIXPT_LEVEL_LOOKUP_64_STEP_MINUS_96_TO_ZERO[sig_gen_level];
-	//printk (KERN_DEBUG "MB-sigmadsp: sig_gen_level setting to %d\n", sig_gen_level);
-	adau1761_block_write(adau, mux_addr, &buf, 4);
-
-	return 0;
-};
-
 static int microburst_sigmadsp_cw_sidetone_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
 {
@@ -1176,6 +946,7 @@ static int microburst_sigmadsp_tx_filter_bw_put(struct snd_kcontrol *kcontrol,
     //	printk(KERN_DEBUG "MB-sigmadsp: tx_filter_bw_put called\n");
 	uint32_t *buf_lp;
 	uint32_t *buf_hp;
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int bandwidth_select;
@@ -1204,13 +975,12 @@ static int microburst_sigmadsp_tx_filter_bw_put(struct snd_kcontrol *kcontrol,
         //	printk (KERN_DEBUG "MB-sigmadsp: tx_filter_bw setting to %d\n", bandwidth_select);
         //	adau1761_block_write(adau, lp_addr, buf_lp, 24);
         //	adau1761_block_write(adau, hp_addr, buf_hp, 24);
-        adau1761_safeload_write(adau, lp_addr, buf_lp, 20);
-        adau1761_block_write(adau, lp_loop_addr ,buf_lp + 5, 4);
-
-        adau1761_safeload_write(adau, hp_addr, buf_hp, 20);
-        adau1761_block_write(adau, hp_loop_addr, buf_hp + 5, 4);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, lp_addr, buf_lp, 20);
+	adau1761_param_block(&txn, lp_loop_addr, buf_lp + 5, 4);
+	adau1761_param_safeload(&txn, hp_addr, buf_hp, 20);
+	adau1761_param_block(&txn, hp_loop_addr, buf_hp + 5, 4);
+	return adau1761_param_commit(&txn);
 };
 /*
 static int microburst_sigmadsp_tx_eq_stage_0_get(struct snd_kcontrol *kcontrol,
@@ -1227,6 +997,7 @@ static int microburst_sigmadsp_tx_eq_stage_0_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_0_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1246,11 +1017,10 @@ static int microburst_sigmadsp_tx_eq_stage_0_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_0 boost level setting to %d\n", boost_level);
 //	adau1761_block_write(adau, stage_addr, &buf, 20);
 //	adau1761_block_write(adau, data_addr, &buf2, 12);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_tx_eq_stage_1_get(struct snd_kcontrol *kcontrol,
@@ -1268,6 +1038,7 @@ static int microburst_sigmadsp_tx_eq_stage_1_put(struct snd_kcontrol *kcontrol,
 
         uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1288,9 +1059,10 @@ static int microburst_sigmadsp_tx_eq_stage_1_put(struct snd_kcontrol *kcontrol,
 //	adau1761_block_write(adau, stage_addr, &buf, 20);
 //	adau1761_block_write(adau, data_addr, &buf2, 12);
 
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_tx_eq_stage_2_get(struct snd_kcontrol *kcontrol,
@@ -1307,6 +1079,7 @@ static int microburst_sigmadsp_tx_eq_stage_2_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_2_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1324,10 +1097,10 @@ static int microburst_sigmadsp_tx_eq_stage_2_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_TX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_2 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 
@@ -1345,6 +1118,7 @@ static int microburst_sigmadsp_tx_eq_stage_3_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_3_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1362,10 +1136,10 @@ static int microburst_sigmadsp_tx_eq_stage_3_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_TX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_3 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_tx_eq_stage_4_get(struct snd_kcontrol *kcontrol,
@@ -1382,6 +1156,7 @@ static int microburst_sigmadsp_tx_eq_stage_4_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_4_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1399,10 +1174,10 @@ static int microburst_sigmadsp_tx_eq_stage_4_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_TX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_4 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_tx_eq_stage_5_get(struct snd_kcontrol *kcontrol,
@@ -1419,6 +1194,7 @@ static int microburst_sigmadsp_tx_eq_stage_5_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_5_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1436,10 +1212,10 @@ static int microburst_sigmadsp_tx_eq_stage_5_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_TX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_5 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_tx_eq_stage_6_get(struct snd_kcontrol *kcontrol,
@@ -1456,6 +1232,7 @@ static int microburst_sigmadsp_tx_eq_stage_6_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_6_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1473,10 +1250,10 @@ static int microburst_sigmadsp_tx_eq_stage_6_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_TX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_6 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_tx_eq_stage_7_get(struct snd_kcontrol *kcontrol,
@@ -1493,6 +1270,7 @@ static int microburst_sigmadsp_tx_eq_stage_7_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_7_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[3];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1510,10 +1288,10 @@ static int microburst_sigmadsp_tx_eq_stage_7_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_TX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: tx_eq_stage_7 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 12);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 12);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_rx_eq_stage_0_get(struct snd_kcontrol *kcontrol,
@@ -1530,6 +1308,7 @@ static int microburst_sigmadsp_rx_eq_stage_0_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_0_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1547,10 +1326,10 @@ static int microburst_sigmadsp_rx_eq_stage_0_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_0 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 
 static int microburst_sigmadsp_rx_eq_stage_1_get(struct snd_kcontrol *kcontrol,
@@ -1567,6 +1346,7 @@ static int microburst_sigmadsp_rx_eq_stage_1_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_1_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1584,10 +1364,10 @@ static int microburst_sigmadsp_rx_eq_stage_1_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_1 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 static int microburst_sigmadsp_rx_eq_stage_2_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
@@ -1603,6 +1383,7 @@ static int microburst_sigmadsp_rx_eq_stage_2_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_2_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1620,10 +1401,10 @@ static int microburst_sigmadsp_rx_eq_stage_2_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_2 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 static int microburst_sigmadsp_rx_eq_stage_3_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
@@ -1639,6 +1420,7 @@ static int microburst_sigmadsp_rx_eq_stage_3_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_3_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1656,10 +1438,10 @@ static int microburst_sigmadsp_rx_eq_stage_3_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_3 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 static int microburst_sigmadsp_rx_eq_stage_4_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
@@ -1675,6 +1457,7 @@ static int microburst_sigmadsp_rx_eq_stage_4_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_4_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1692,10 +1475,10 @@ static int microburst_sigmadsp_rx_eq_stage_4_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_4 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 static int microburst_sigmadsp_rx_eq_stage_5_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
@@ -1711,6 +1494,7 @@ static int microburst_sigmadsp_rx_eq_stage_5_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_5_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1728,10 +1512,10 @@ static int microburst_sigmadsp_rx_eq_stage_5_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_5 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 static int microburst_sigmadsp_rx_eq_stage_6_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
@@ -1747,6 +1531,7 @@ static int microburst_sigmadsp_rx_eq_stage_6_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_6_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1764,10 +1549,10 @@ static int microburst_sigmadsp_rx_eq_stage_6_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_6 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 static int microburst_sigmadsp_rx_eq_stage_7_get(struct snd_kcontrol *kcontrol,
 		struct snd_ctl_elem_value *ucontrol)
@@ -1783,6 +1568,7 @@ static int microburst_sigmadsp_rx_eq_stage_7_put(struct snd_kcontrol *kcontrol,
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_7_put called\n");
 	uint32_t buf[5];
 	uint32_t buf2[4];
+	struct adau1761_param_txn txn;
 	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
 	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int boost_level;
@@ -1800,175 +1586,13 @@ static int microburst_sigmadsp_rx_eq_stage_7_put(struct snd_kcontrol *kcontrol,
 	buf2[i] = MICROBURST_SIGMADSP_RX_EQ_PANEL_DATA_COEFF_LOOP_FIXPT[i];
 	};
 	//printk (KERN_DEBUG "MB-sigmadsp: rx_eq_stage_7 boost level setting to %d\n", boost_level);
-	adau1761_safeload_write(adau, stage_addr, buf, 20);
-	adau1761_block_write(adau, data_addr, buf2, 16);
-
-	return 0;
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn, stage_addr, buf, 20);
+	adau1761_param_block(&txn, data_addr, buf2, 16);
+	return adau1761_param_commit(&txn);
 };
 */
 
-static int microburst_sigmadsp_compander_decay_put(struct snd_kcontrol *kcontrol,
-                                                  struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t c_decay_address = MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1DECAY_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t buf[1];
-
-  buf[0] = ucontrol->value.integer.value[0];
-
-  adau1761_block_write(adau, c_decay_address, buf, 4);
-
-  return 0;
-
-};
-
-static int microburst_sigmadsp_compander_decay_get(struct snd_kcontrol *kcontrol,
-                                                  struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t c_decay_address = MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1DECAY_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t decay_value;
-
-  //  buf[0] = SIGMASTUDIOTYPE_INTEGER_CONVERT(ucontrol->value.integer.value[0]);
-  regmap_raw_read(adau->regmap, c_decay_address, &decay_value, 4);
-  decay_value = htonl(decay_value);
-  ucontrol->value.integer.value[0] = decay_value;
-  return 0;
-
-};
-
-
-/// Compander Hold 
-static int microburst_sigmadsp_compander_hold_put(struct snd_kcontrol *kcontrol,
-                                                  struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t c_hold_address = MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1HOLD_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t buf[1];
-
-  buf[0] = ucontrol->value.integer.value[0];
-
-  adau1761_block_write(adau, c_hold_address, buf, 4);
-
-  return 0;
-
-};
-
-static int microburst_sigmadsp_compander_hold_get(struct snd_kcontrol *kcontrol,
-                                                  struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t c_hold_address = MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1HOLD_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t hold_value;
-
-  //  buf[0] = SIGMASTUDIOTYPE_INTEGER_CONVERT(ucontrol->value.integer.value[0]);
-  regmap_raw_read(adau->regmap, c_hold_address, &hold_value, 4);
-  hold_value = htonl(hold_value);
-  ucontrol->value.integer.value[0] = hold_value;
-  return 0;
-
-};
-
-static int microburst_sigmadsp_extra_line_input_gain_put(struct snd_kcontrol *kcontrol,
-                                                  struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t extra_line_gain_addr = MOD_LINE_GAIN_GAIN1940ALGNS5_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t buf[1];
-  buf[0] = ucontrol->value.integer.value[0];
-
-  adau1761_block_write(adau, extra_line_gain_addr, buf, 4);
-  return 0;
-}
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_extra_line_input_gain_get(struct snd_kcontrol *kcontrol,
-                                                  struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t extra_line_gain_addr = MOD_LINE_GAIN_GAIN1940ALGNS5_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t line_gain_value;
-
-  //  buf[0] = SIGMASTUDIOTYPE_INTEGER_CONVERT(ucontrol->value.integer.value[0]);
-  regmap_raw_read(adau->regmap, extra_line_gain_addr, &line_gain_value, 4);
-  line_gain_value = htonl(line_gain_value);
-  ucontrol->value.integer.value[0] = line_gain_value;
-  return 0;
-
-};
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_extra_mic_input_gain_put(struct snd_kcontrol *kcontrol,
-                                                struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t extra_mic_gain_addr = MOD_MIC_GAIN_GAIN1940ALGNS4_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t buf[1];
-  buf[0] = ucontrol->value.integer.value[0];
-
-  adau1761_block_write(adau, extra_mic_gain_addr, buf, 4);
-  return 0;
-}
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_extra_mic_input_gain_get(struct snd_kcontrol *kcontrol,
-                                                  struct snd_ctl_elem_value *ucontrol)
-{
-  uint32_t extra_mic_gain_addr = MOD_MIC_GAIN_GAIN1940ALGNS4_ADDR;
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t mic_gain_value;
-
-  regmap_raw_read(adau->regmap, extra_mic_gain_addr, &mic_gain_value, 4);
-  mic_gain_value = htonl(mic_gain_value);
-  ucontrol->value.integer.value[0] = mic_gain_value;
-  return 0;
-
-};
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_compander_input_gain_get(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value;
-
-  regmap_raw_read(adau->regmap, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1ATTENUATION_ADDR, &value, 4);
-  value = htonl(value);
-  ucontrol->value.integer.value[0] = value ; // 20 * log10(value) ! 
-  return 0;
-};
-// Conversion needs to be done in Firmware
-static int microburst_sigmadsp_compander_input_gain_put(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value[1];
-
-  value[0] = ucontrol->value.integer.value[0]; // Convert by  pow( 10.0, (ucontrol->value.integer.value[0] - 90) / 20.0);
-  adau1761_block_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1ATTENUATION_ADDR, value, 4);
-  return 0;
-};
-
 /* static int microburst_sigmadsp_apf_coefficients_put(struct snd_kcontrol *kcontrol, */
 /*                                                     struct snd_ctl_elem_value *ucontrol) */
 /* { */
@@ -2030,91 +1654,34 @@ static int microburst_sigmadsp_compander_curve_put(struct  snd_kcontrol *kcontro
 //   	compressor_array[i] = MICROBURST_SIGMADSP_FIXPT_ONE / (i * 2); // Integer division
 //   }
 
-//   for ( i = expander_index ; i <= 33 ; i ++ )
-//   {
-//   	float tmp = 1.0 - exp( level * i );
-//   	tmp = tmp * compressor_ratio_level;
-//   	tmp = pow(10.0, tmp / 20.0);
-
-//   	tmp = tmp * MICROBURST_SIGMADSP_FIXPT_ONE;
-//   	compressor_array[i + (33 - expander_index)] =  tmp / 1; //Integer division
-//   }
-
-uint32_t *compressor_array = ucontrol->value.integer.value;
-
-adau1761_safeload_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR, compressor_array, 20 );
-adau1761_safeload_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR+5, compressor_array+5, 20 );
-adau1761_safeload_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR+10, compressor_array+10, 20 );
-adau1761_safeload_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR+15, compressor_array+15, 20 );
-adau1761_safeload_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR+20, compressor_array+20, 20 );
-adau1761_safeload_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR+25, compressor_array+25, 20 );
-adau1761_safeload_write(adau, MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR+30, compressor_array+30, 16);
-
-  return 0;	
-};
-
-static int microburst_sigmadsp_compander_curve_get(struct snd_kcontrol *kcontrol,
-	                                               struct snd_ctl_elem_value *ucontrol)
-{
-	return 0;
-};
-
-
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_compander_post_gain_1_get(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value;
+//   for ( i = expander_index ; i <= 33 ; i ++ )
+//   {
+//   	float tmp = 1.0 - exp( level * i );
+//   	tmp = tmp * compressor_ratio_level;
+//   	tmp = pow(10.0, tmp / 20.0);
 
-  regmap_raw_read(adau->regmap, MOD_POST_COMP_GAIN_1_GAIN1940ALGNS1_ADDR, &value, 4);
-  value = htonl(value);
-  ucontrol->value.integer.value[0] = value ; // 20 * log10(value) ! 
-  return 0;
-};
-// Conversion needs to be done in Firmware
-static int microburst_sigmadsp_compander_post_gain_1_put(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
+//   	tmp = tmp * MICROBURST_SIGMADSP_FIXPT_ONE;
+//   	compressor_array[i + (33 - expander_index)] =  tmp / 1; //Integer division
+//   }
 
-  uint32_t value[1];
+uint32_t *compressor_array = ucontrol->value.integer.value;
+	struct adau1761_param_txn txn;
 
-  value[0] = ucontrol->value.integer.value[0]; // Convert by  pow( 10.0, (ucontrol->value.integer.value[0] - 90) / 20.0);
-  adau1761_block_write(adau, MOD_POST_COMP_GAIN_1_GAIN1940ALGNS1_ADDR, value, 4);
-  return 0;
+	/* the 34 word curve goes out as seven back to back safeloads */
+	adau1761_param_begin(&txn, adau);
+	adau1761_param_safeload(&txn,
+		MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG10_ADDR,
+		compressor_array, 34 * 4);
+	return adau1761_param_commit(&txn);
 };
 
-// Conversion needs to be done in Firmware!
-static int microburst_sigmadsp_compander_post_gain_2_get(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
+static int microburst_sigmadsp_compander_curve_get(struct snd_kcontrol *kcontrol,
+	                                               struct snd_ctl_elem_value *ucontrol)
 {
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
-
-  uint32_t value;
-
-  regmap_raw_read(adau->regmap, MOD_POST_COMP_GAIN_2_GAIN1940ALGNS6_ADDR, &value, 4);
-  value = htonl(value);
-  ucontrol->value.integer.value[0] = value ; // 20 * log10(value) ! 
-  return 0;
+	return 0;
 };
-// Conversion needs to be done in Firmware
-static int microburst_sigmadsp_compander_post_gain_2_put(struct snd_kcontrol *kcontrol,
-                                                        struct snd_ctl_elem_value *ucontrol)
-{
-  struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-  struct adau *adau = snd_soc_codec_get_drvdata(codec);
 
-  uint32_t value[1];
 
-  value[0] = ucontrol->value.integer.value[0]; // Convert by  pow( 10.0, (ucontrol->value.integer.value[0] - 90) / 20.0);
-  adau1761_block_write(adau, MOD_POST_COMP_GAIN_2_GAIN1940ALGNS6_ADDR, value, 4);
-  return 0;
-};
 /* tatic int microburst_sigmadsp_echo_cancel_adapt_get(struct snd_kcontrol *kcontrol, */
 /* 	                                                struct snd_ctl_elem_value *ucontrol) */
 /* { */
@@ -2196,42 +1763,6 @@ static int microburst_sigmadsp_compander_post_gain_2_put(struct snd_kcontrol *kc
 /* 	return 0; */
 /* }; */
 
-static int microburst_sigmadsp_eq_comp_bypass_get(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: echo_cancel_get called\n");
-	ucontrol->value.integer.value[0] = kcontrol->private_value;
-	return 0;
-};
-
-static int microburst_sigmadsp_eq_comp_bypass_put(struct snd_kcontrol *kcontrol,
-		struct snd_ctl_elem_value *ucontrol)
-{
-	//printk (KERN_DEBUG "MB-sigmadsp: echo_cancel_put called\n");
-	uint32_t buf[2];
-	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
-	struct adau *adau = snd_soc_codec_get_drvdata(codec);
-	int echo_cancel;
-	uint32_t mux_addr = MOD_MODE_BYPASS_EQ_COMP_ALG0_STAGE0_MONOSWITCHNOSLEW_ADDR;
-	echo_cancel = ucontrol->value.integer.value[0];
-	if (echo_cancel)
-	{
-		buf[0] = MICROBURST_SIGMADSP_FIXPT_ZERO;
-		buf[1] = MICROBURST_SIGMADSP_FIXPT_ONE;
-	}
-	else
-	{
-		buf[0] = MICROBURST_SIGMADSP_FIXPT_ONE;
-		buf[1] = MICROBURST_SIGMADSP_FIXPT_ZERO;
-	}
-
-	//printk (KERN_DEBUG "MB-sigmadsp: echo_cancel setting to %d\n", echo_cancel);
-	adau1761_block_write(adau, mux_addr, buf, 8);
-
-	return 0;
-};
-
-
 static int microburst_sigmadsp_binary_version_get(struct snd_kcontrol *kcontrol,
 	                                               struct snd_ctl_elem_value *ucontrol)
 {
@@ -2420,19 +1951,601 @@ static int microburst_sigmadsp_average_meter_readback_put(struct snd_kcontrol *k
 };
 
 /* Microburst SigmaDSP kcontrols */
+/*
+ * Table driven SigmaDSP parameters
+ *
+ * Each row of adau1761_dsp_params[] describes a control that maps a single
+ * value onto a fixed parameter RAM location, using the addresses from the
+ * SigmaStudio *_IC_1_PARAM.h export, and they all share one get/put pair.
+ *
+ * Every parameter has a shadow copy, read from the DSP once after the
+ * firmware is loaded.  Reads are served from it without touching the bus
+ * and writes of the value already in place are dropped.  While the codec
+ * is suspended the parameter RAM cannot be accessed, so writes only update
+ * the shadow copy and mark it dirty; the dirty parameters are written back
+ * in batches on resume.
+ */
+enum adau1761_dsp_param_type {
+	ADAU1761_DSP_PARAM_RAW,		/* the parameter word itself */
+	ADAU1761_DSP_PARAM_BOOL,	/* 5.23 zero or one */
+	ADAU1761_DSP_PARAM_SWITCH,	/* selects one side of a two way switch */
+	ADAU1761_DSP_PARAM_LEVEL,	/* index into the 64 step level table */
+};
+
+struct adau1761_dsp_param {
+	const char *name;
+	uint32_t addr;
+	enum adau1761_dsp_param_type type;
+	int max;
+	bool safeload;
+};
+
+#define ADAU1761_DSP_PARAM(xname, xaddr, xtype, xmax, xsafeload) \
+	{ .name = xname, .addr = xaddr, .type = ADAU1761_DSP_PARAM_##xtype, \
+	  .max = xmax, .safeload = xsafeload }
+
+static const struct adau1761_dsp_param adau1761_dsp_params[] = {
+	ADAU1761_DSP_PARAM("RX MUTE",
+		MOD_RX_MUTE_MUTENOSLEWALG1MUTE_ADDR, BOOL, 1, true),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP CW Key",
+		MOD_CW_KEY_ISON_ADDR, BOOL, 1, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP CW Key RX Mute",
+		MOD_CW_KEY_RX_MUTE_ISON_ADDR, BOOL, 1, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Monitor Voice CW",
+		MOD_MONITOR_VOICE_CW_ALG0_STAGE0_STEREOSWITCHNOSLEW_ADDR,
+		SWITCH, 1, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP EQ-COMP Bypass",
+		MOD_MODE_BYPASS_EQ_COMP_ALG0_STAGE0_MONOSWITCHNOSLEW_ADDR,
+		SWITCH, 2, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Compander Hold",
+		MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1HOLD_ADDR,
+		RAW, 12000, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Compander Decay",
+		MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1DECAY_ADDR,
+		RAW, 0x7B89, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Compander Input Gain",
+		MOD_COMPANDER_ALG0_STDPEAKINGCOMPRESSORALG1ATTENUATION_ADDR,
+		RAW, 0x00FFFFFF, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Compander Post Gain 1",
+		MOD_POST_COMP_GAIN_1_GAIN1940ALGNS1_ADDR, RAW, 0x07FFFFFF, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Compander Post Gain 2",
+		MOD_POST_COMP_GAIN_2_GAIN1940ALGNS6_ADDR, RAW, 0x07FFFFFF, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP CW Monitor Level",
+		MOD_CW_MONITOR_LEVEL_GAIN1940ALGNS2_ADDR, LEVEL, 63, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Voice Monitor Level",
+		MOD_VOICE_MONITOR_LEVEL_GAIN1940ALGNS8_ADDR, LEVEL, 63, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP CW Monitor Right Pan",
+		MOD_CW_MON_RIGHT_PAN_GAIN1940ALGNS12_ADDR, RAW, 0x07FFFFFF, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP CW Monitor Left Pan",
+		MOD_CW_MON_LEFT_PAN_GAIN1940ALGNS11_ADDR, RAW, 0x07FFFFFF, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Voice Monitor Right Pan",
+		MOD_SB_MON_RIGHT_PAN_GAIN1940ALGNS10_ADDR, RAW, 0x07FFFFFF, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Voice Monitor Left Pan",
+		MOD_SB_MON_LEFT_PAN_GAIN1940ALGNS9_ADDR, RAW, 0x07FFFFFF, false),
+	ADAU1761_DSP_PARAM("Microburst SigmaDSP Sig Gen Level",
+		MOD_SIGGEN_SIG_GEN_LEVEL_GAIN1940ALGNS3_ADDR, LEVEL, 63, false),
+	ADAU1761_DSP_PARAM("Extra Line Input Gain",
+		MOD_LINE_GAIN_GAIN1940ALGNS5_ADDR, RAW, 0x7FFFFFF, false),
+	ADAU1761_DSP_PARAM("Extra Mic Input Gain",
+		MOD_MIC_GAIN_GAIN1940ALGNS4_ADDR, RAW, 0x7FFFFFF, false),
+};
+
+#define ADAU1761_DSP_PARAMS	ARRAY_SIZE(adau1761_dsp_params)
+
+static unsigned int adau1761_dsp_param_size(const struct adau1761_dsp_param *p)
+{
+	return p->type == ADAU1761_DSP_PARAM_SWITCH ? 8 : 4;
+}
+
+static void adau1761_dsp_param_encode(const struct adau1761_dsp_param *p,
+	int val, uint32_t *buf)
+{
+	switch (p->type) {
+	case ADAU1761_DSP_PARAM_BOOL:
+		buf[0] = val ? MICROBURST_SIGMADSP_FIXPT_ONE :
+			MICROBURST_SIGMADSP_FIXPT_ZERO;
+		break;
+	case ADAU1761_DSP_PARAM_SWITCH:
+		buf[0] = val ? MICROBURST_SIGMADSP_FIXPT_ZERO :
+			MICROBURST_SIGMADSP_FIXPT_ONE;
+		buf[1] = val ? MICROBURST_SIGMADSP_FIXPT_ONE :
+			MICROBURST_SIGMADSP_FIXPT_ZERO;
+		break;
+	case ADAU1761_DSP_PARAM_LEVEL:
+		buf[0] = MICROBURST_SIGMADSP_FIXPT_LEVEL_LOOKUP_64_STEP_MINUS_96_TO_ZERO[val];
+		break;
+	default:
+		buf[0] = val;
+		break;
+	}
+}
+
+static int adau1761_dsp_param_decode(const struct adau1761_dsp_param *p,
+	const uint32_t *buf)
+{
+	int i;
+
+	switch (p->type) {
+	case ADAU1761_DSP_PARAM_BOOL:
+		return buf[0] != MICROBURST_SIGMADSP_FIXPT_ZERO;
+	case ADAU1761_DSP_PARAM_SWITCH:
+		return buf[1] != MICROBURST_SIGMADSP_FIXPT_ZERO;
+	case ADAU1761_DSP_PARAM_LEVEL:
+		/* the firmware default need not be one of the steps */
+		for (i = 0; i < p->max; i++)
+			if (buf[0] <= MICROBURST_SIGMADSP_FIXPT_LEVEL_LOOKUP_64_STEP_MINUS_96_TO_ZERO[i])
+				break;
+		return i;
+	default:
+		return buf[0];
+	}
+}
+
+static void adau1761_dsp_param_queue(struct adau1761_param_txn *txn,
+	unsigned int index)
+{
+	const struct adau1761_dsp_param *p = &adau1761_dsp_params[index];
+	uint32_t buf[2];
+
+	adau1761_dsp_param_encode(p, txn->adau->dsp_param_val[index], buf);
+	if (p->safeload)
+		adau1761_param_safeload(txn, p->addr, buf,
+			adau1761_dsp_param_size(p));
+	else
+		adau1761_param_block(txn, p->addr, buf,
+			adau1761_dsp_param_size(p));
+}
+
+/* Commit the queued parameters and mark start..end-1 clean */
+static int adau1761_dsp_param_flush(struct adau1761_param_txn *txn,
+	unsigned int start, unsigned int end)
+{
+	struct adau *adau = txn->adau;
+	int ret;
+
+	ret = adau1761_param_commit(txn);
+	if (ret)
+		return ret;
+
+	for (; start < end; start++)
+		__clear_bit(start, adau->dsp_param_dirty);
+	adau1761_param_begin(txn, adau);
+
+	return 0;
+}
+
+/* Write back the parameters that changed while the DSP was unreachable */
+static int adau1761_dsp_param_sync(struct snd_soc_codec *codec)
+{
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	struct adau1761_param_txn txn;
+	unsigned int start = 0;
+	unsigned int i;
+	int ret = 0;
+
+	if (!adau->dsp_param_val)
+		return 0;
+
+	mutex_lock(&adau->dsp_param_lock);
+	adau1761_param_begin(&txn, adau);
+	for (i = 0; i < ADAU1761_DSP_PARAMS && !ret; i++) {
+		if (!test_bit(i, adau->dsp_param_dirty))
+			continue;
+		/* a parameter adds at most two writes to the transaction */
+		if (txn.count + 2 > ADAU1761_PARAM_TXN_MAX) {
+			ret = adau1761_dsp_param_flush(&txn, start, i);
+			start = i;
+		}
+		adau1761_dsp_param_queue(&txn, i);
+	}
+	if (!ret)
+		ret = adau1761_dsp_param_flush(&txn, start, ADAU1761_DSP_PARAMS);
+	mutex_unlock(&adau->dsp_param_lock);
+
+	if (ret)
+		dev_err(codec->dev, "Failed to restore DSP parameters: %d\n", ret);
+	return ret;
+}
+
+static int adau1761_dsp_param_info(struct snd_kcontrol *kcontrol,
+	struct snd_ctl_elem_info *uinfo)
+{
+	const struct adau1761_dsp_param *p =
+		&adau1761_dsp_params[kcontrol->private_value];
+
+	if (p->max == 1)
+		uinfo->type = SNDRV_CTL_ELEM_TYPE_BOOLEAN;
+	else
+		uinfo->type = SNDRV_CTL_ELEM_TYPE_INTEGER;
+	uinfo->count = 1;
+	uinfo->value.integer.min = 0;
+	uinfo->value.integer.max = p->max;
+	return 0;
+}
+
+static int adau1761_dsp_param_get(struct snd_kcontrol *kcontrol,
+	struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+
+	ucontrol->value.integer.value[0] =
+		adau->dsp_param_val[kcontrol->private_value];
+	return 0;
+}
+
+static int adau1761_dsp_param_put(struct snd_kcontrol *kcontrol,
+	struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	unsigned int i = kcontrol->private_value;
+	const struct adau1761_dsp_param *p = &adau1761_dsp_params[i];
+	int val = ucontrol->value.integer.value[0];
+	struct adau1761_param_txn txn;
+	int changed;
+	int ret;
+
+	if (val < 0 || val > p->max)
+		return -EINVAL;
+
+	mutex_lock(&adau->dsp_param_lock);
+	changed = adau->dsp_param_val[i] != val;
+	if (!changed && !test_bit(i, adau->dsp_param_dirty)) {
+		ret = 0;
+		goto out;
+	}
+
+	adau->dsp_param_val[i] = val;
+	__set_bit(i, adau->dsp_param_dirty);
+	ret = changed;
+	if (codec->dapm.bias_level == SND_SOC_BIAS_OFF)
+		goto out;
+
+	adau1761_param_begin(&txn, adau);
+	adau1761_dsp_param_queue(&txn, i);
+	ret = adau1761_dsp_param_flush(&txn, i, i + 1);
+	if (!ret)
+		ret = changed;
+out:
+	mutex_unlock(&adau->dsp_param_lock);
+	return ret;
+}
+
+/* Fill the shadow copies from the freshly loaded firmware, add the controls */
+static int adau1761_dsp_param_add_controls(struct snd_soc_codec *codec)
+{
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	const struct adau1761_dsp_param *p;
+	struct snd_kcontrol_new kcontrol = {
+		.iface = SNDRV_CTL_ELEM_IFACE_MIXER,
+		.info = adau1761_dsp_param_info,
+		.get = adau1761_dsp_param_get,
+		.put = adau1761_dsp_param_put,
+	};
+	uint32_t buf[2];
+	unsigned int i;
+	int ret;
+
+	adau->dsp_param_val = devm_kzalloc(codec->dev,
+		ADAU1761_DSP_PARAMS * sizeof(*adau->dsp_param_val), GFP_KERNEL);
+	adau->dsp_param_dirty = devm_kzalloc(codec->dev,
+		BITS_TO_LONGS(ADAU1761_DSP_PARAMS) * sizeof(long), GFP_KERNEL);
+	if (!adau->dsp_param_val || !adau->dsp_param_dirty)
+		return -ENOMEM;
+
+	for (i = 0; i < ADAU1761_DSP_PARAMS; i++) {
+		p = &adau1761_dsp_params[i];
+
+		buf[0] = buf[1] = 0;
+		ret = regmap_raw_read(adau->regmap, p->addr, buf,
+			adau1761_dsp_param_size(p));
+		if (ret)
+			dev_warn(codec->dev, "Failed to read %s: %d\n",
+				p->name, ret);
+		buf[0] = ntohl(buf[0]);
+		buf[1] = ntohl(buf[1]);
+		adau->dsp_param_val[i] = adau1761_dsp_param_decode(p, buf);
+
+		kcontrol.name = p->name;
+		kcontrol.private_value = i;
+		ret = snd_soc_add_controls(codec, &kcontrol, 1);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * SigmaDSP level meter sampler
+ *
+ * While "Microburst SigmaDSP Meter Rate" is non-zero, all meter readbacks
+ * are sampled at that rate and published together in the read-only
+ * "Microburst SigmaDSP Meters" control as
+ *
+ *	{ sequence, seconds, microseconds, meter 0, meter 1, ... }
+ *
+ * with the sample time taken from the monotonic clock and split in two so
+ * that it fits the control's long values, and the meters in
+ * adau1761_meter_addrs[] order.  A value change event
+ * is sent for each sample, so a GUI can wait for them on the control
+ * device rather than polling one I2C readback per meter.
+ *
+ * Readbacks at most ADAU1761_METER_GAP words apart are read as one block,
+ * and on I2C all blocks are fetched by a single combined transfer.
+ */
+static const uint32_t adau1761_meter_addrs[] = {
+	MOD_COMP_LEVEL_PEAK_IN_READBACKALGSIGMA2003_ADDR,
+	MOD_COMP_LEVEL_PEAK_OUT_READBACKALGSIGMA2005_ADDR,
+	MOD_MIC_LEVEL_AVG_READBACKALGSIGMA2002_ADDR,
+	MOD_MIC_LEVEL_PEAK_READBACKALGSIGMA2001_ADDR,
+};
+
+#define ADAU1761_METERS		ARRAY_SIZE(adau1761_meter_addrs)
+#define ADAU1761_METER_HDR	3	/* sequence, seconds, microseconds */
+#define ADAU1761_METER_GAP	1
+#define ADAU1761_METER_MAX_RATE	50
+
+struct adau1761_meter_run {
+	uint32_t addr;
+	unsigned int words;
+	unsigned int offset;	/* into adau1761_meter.raw */
+};
+
+struct adau1761_meter {
+	struct snd_soc_codec *codec;
+	struct delayed_work work;
+	struct snd_kcontrol *kctl;
+	struct mutex rate_lock;
+	unsigned int rate;
+
+	unsigned int num_runs;
+	struct adau1761_meter_run runs[ADAU1761_METERS];
+	unsigned int offset[ADAU1761_METERS];
+	__be32 raw[ADAU1761_METERS * (ADAU1761_METER_GAP + 1)];
+
+	/* the published sample */
+	spinlock_t lock;
+	u32 seq;
+	ktime_t time;
+	uint32_t val[ADAU1761_METERS];
+};
+
+static void adau1761_meter_init_runs(struct adau1761_meter *meter)
+{
+	struct adau1761_meter_run *run = NULL;
+	unsigned int words = 0;
+	uint32_t addr;
+	unsigned int i;
+
+	for (i = 0; i < ADAU1761_METERS; i++) {
+		addr = adau1761_meter_addrs[i];
+		if (!run || addr < run->addr + run->words ||
+		    addr - (run->addr + run->words) > ADAU1761_METER_GAP) {
+			run = &meter->runs[meter->num_runs++];
+			run->addr = addr;
+			run->words = 0;
+			run->offset = words;
+		}
+		words += addr + 1 - (run->addr + run->words);
+		run->words = addr + 1 - run->addr;
+		meter->offset[i] = words - 1;
+	}
+}
+
+static int adau1761_meter_read(struct adau1761_meter *meter)
+{
+	struct snd_soc_codec *codec = meter->codec;
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	struct i2c_msg msgs[2 * ADAU1761_METERS];
+	u8 addr[ADAU1761_METERS][2];
+	struct adau1761_meter_run *run;
+	struct i2c_client *client;
+	unsigned int i;
+	int ret;
+
+	if (adau->control_type != SND_SOC_I2C) {
+		for (i = 0; i < meter->num_runs; i++) {
+			run = &meter->runs[i];
+			ret = regmap_raw_read(adau->regmap, run->addr,
+				&meter->raw[run->offset], run->words * 4);
+			if (ret)
+				return ret;
+		}
+		return 0;
+	}
+
+	client = to_i2c_client(codec->dev);
+	for (i = 0; i < meter->num_runs; i++) {
+		run = &meter->runs[i];
+		addr[i][0] = run->addr >> 8;
+		addr[i][1] = run->addr & 0xff;
+		msgs[2 * i].addr = client->addr;
+		msgs[2 * i].flags = 0;
+		msgs[2 * i].len = 2;
+		msgs[2 * i].buf = addr[i];
+		msgs[2 * i + 1].addr = client->addr;
+		msgs[2 * i + 1].flags = I2C_M_RD;
+		msgs[2 * i + 1].len = run->words * 4;
+		msgs[2 * i + 1].buf = (u8 *)&meter->raw[run->offset];
+	}
+
+	ret = i2c_transfer(client->adapter, msgs, 2 * meter->num_runs);
+	if (ret < 0)
+		return ret;
+	if (ret != 2 * meter->num_runs)
+		return -EIO;
+
+	return 0;
+}
+
+static void adau1761_meter_work(struct work_struct *work)
+{
+	struct adau1761_meter *meter =
+		container_of(work, struct adau1761_meter, work.work);
+	struct snd_soc_codec *codec = meter->codec;
+	unsigned int rate;
+	unsigned int i;
+	int ret;
+
+	ret = adau1761_meter_read(meter);
+	if (ret) {
+		dev_dbg(codec->dev, "Failed to read meters: %d\n", ret);
+	} else {
+		spin_lock_irq(&meter->lock);
+		for (i = 0; i < ADAU1761_METERS; i++)
+			meter->val[i] = be32_to_cpu(meter->raw[meter->offset[i]]);
+		meter->seq++;
+		meter->time = ktime_get();
+		spin_unlock_irq(&meter->lock);
+
+		snd_ctl_notify(codec->card->snd_card, SNDRV_CTL_EVENT_MASK_VALUE,
+			&meter->kctl->id);
+	}
+
+	rate = ACCESS_ONCE(meter->rate);
+	if (rate)
+		schedule_delayed_work(&meter->work,
+			max(msecs_to_jiffies(1000 / rate), 1UL));
+}
+
+static void adau1761_meter_start(struct adau1761_meter *meter)
+{
+	if (meter && meter->rate)
+		schedule_delayed_work(&meter->work, 0);
+}
+
+static void adau1761_meter_stop(struct adau1761_meter *meter)
+{
+	if (meter)
+		cancel_delayed_work_sync(&meter->work);
+}
+
+static int adau1761_meter_info(struct snd_kcontrol *kcontrol,
+	struct snd_ctl_elem_info *uinfo)
+{
+	uinfo->type = SNDRV_CTL_ELEM_TYPE_INTEGER;
+	uinfo->count = ADAU1761_METER_HDR + ADAU1761_METERS;
+	uinfo->value.integer.min = INT_MIN;
+	uinfo->value.integer.max = INT_MAX;
+	return 0;
+}
+
+static int adau1761_meter_get(struct snd_kcontrol *kcontrol,
+	struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	struct adau1761_meter *meter = ACCESS_ONCE(adau->meter);
+	struct timespec ts;
+	unsigned int i;
+
+	if (!meter)
+		return -ENODEV;
+
+	spin_lock_irq(&meter->lock);
+	ts = ktime_to_timespec(meter->time);
+	ucontrol->value.integer.value[0] = meter->seq;
+	ucontrol->value.integer.value[1] = ts.tv_sec;
+	ucontrol->value.integer.value[2] = ts.tv_nsec / NSEC_PER_USEC;
+	for (i = 0; i < ADAU1761_METERS; i++)
+		ucontrol->value.integer.value[ADAU1761_METER_HDR + i] =
+			meter->val[i];
+	spin_unlock_irq(&meter->lock);
+
+	return 0;
+}
+
+static int adau1761_meter_rate_get(struct snd_kcontrol *kcontrol,
+	struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	struct adau1761_meter *meter = ACCESS_ONCE(adau->meter);
+
+	if (!meter)
+		return -ENODEV;
+
+	ucontrol->value.integer.value[0] = meter->rate;
+	return 0;
+}
+
+static int adau1761_meter_rate_put(struct snd_kcontrol *kcontrol,
+	struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_codec *codec = snd_kcontrol_chip(kcontrol);
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	struct adau1761_meter *meter = ACCESS_ONCE(adau->meter);
+	unsigned int rate = ucontrol->value.integer.value[0];
+	unsigned int old;
+
+	if (!meter)
+		return -ENODEV;
+	if (rate > ADAU1761_METER_MAX_RATE)
+		return -EINVAL;
+
+	mutex_lock(&meter->rate_lock);
+	/* the codec is going away, do not start the sampler again */
+	if (adau->meter != meter) {
+		mutex_unlock(&meter->rate_lock);
+		return -ENODEV;
+	}
+	old = meter->rate;
+	meter->rate = rate;
+	if (!rate)
+		adau1761_meter_stop(meter);
+	else if (!old && codec->dapm.bias_level != SND_SOC_BIAS_OFF)
+		adau1761_meter_start(meter);
+	mutex_unlock(&meter->rate_lock);
+
+	return old != rate;
+}
+
+static const struct snd_kcontrol_new adau1761_meter_controls[] = {
+	{
+		.iface = SNDRV_CTL_ELEM_IFACE_MIXER,
+		.name = "Microburst SigmaDSP Meters",
+		.access = SNDRV_CTL_ELEM_ACCESS_READ |
+			SNDRV_CTL_ELEM_ACCESS_VOLATILE,
+		.info = adau1761_meter_info,
+		.get = adau1761_meter_get,
+	},
+	SOC_SINGLE_INT_EXT("Microburst SigmaDSP Meter Rate",
+		ADAU1761_METER_MAX_RATE, adau1761_meter_rate_get,
+		adau1761_meter_rate_put),
+};
+
+static int adau1761_meter_add_controls(struct snd_soc_codec *codec)
+{
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	struct adau1761_meter *meter;
+	int ret;
+
+	meter = devm_kzalloc(codec->dev, sizeof(*meter), GFP_KERNEL);
+	if (!meter)
+		return -ENOMEM;
+
+	meter->codec = codec;
+	INIT_DELAYED_WORK(&meter->work, adau1761_meter_work);
+	mutex_init(&meter->rate_lock);
+	spin_lock_init(&meter->lock);
+	adau1761_meter_init_runs(meter);
+
+	meter->kctl = snd_soc_cnew(&adau1761_meter_controls[0], codec, NULL,
+		codec->name_prefix);
+	ret = snd_ctl_add(codec->card->snd_card, meter->kctl);
+	if (ret)
+		return ret;
+
+	adau->meter = meter;
+
+	return snd_soc_add_controls(codec, &adau1761_meter_controls[1], 1);
+}
+
 static const DECLARE_TLV_DB_MINMAX(adau1761_input_gain, 0, 24);
 
 static const struct snd_kcontrol_new microburst_sigmadsp_controls[] = {
-    		SOC_SINGLE_BOOL_EXT("RX MUTE", 0, microburst_sigmadsp_rx_mute_get,
-				microburst_sigmadsp_rx_mute_set),
-		SOC_SINGLE_BOOL_EXT("Microburst SigmaDSP CW Key", 0, microburst_sigmadsp_cw_key_get,
-				microburst_sigmadsp_cw_key_put),
-        SOC_SINGLE_BOOL_EXT("Microburst SigmaDSP CW Key RX Mute", 0, microburst_sigmadsp_cw_key_rx_mute_get,
-                            microburst_sigmadsp_cw_key_rx_mute_put),
-		SOC_SINGLE_BOOL_EXT("Microburst SigmaDSP Monitor Voice CW", 1, microburst_sigmadsp_monitor_voice_cw_get,
-				microburst_sigmadsp_monitor_voice_cw_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP EQ-COMP Bypass", 2, microburst_sigmadsp_eq_comp_bypass_get,
-			microburst_sigmadsp_eq_comp_bypass_put),
                 //		SOC_SINGLE_INT_EXT("Microburst SigmaDSP VOX Enable", 2, microburst_sigmadsp_vox_enable_get,
                 //			microburst_sigmadsp_vox_enable_put),
 		SOC_SINGLE_BOOL_EXT("Microburst SigmaDSP Compander", 1, microburst_sigmadsp_compander_get,
@@ -2443,16 +2556,6 @@ static const struct snd_kcontrol_new microburst_sigmadsp_controls[] = {
 			microburst_sigmadsp_compander_curve_put),
                 //		SOC_SINGLE_INT_EXT("Microburst SigmaDSP APF Coef", 0x07FFFFFF, microburst_sigmadsp_apf_coefficients_get,
                 //                 microburst_sigmadsp_apf_coefficients_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Compander Hold", 12000, microburst_sigmadsp_compander_hold_get,
-			microburst_sigmadsp_compander_hold_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Compander Decay", 0x7B89, microburst_sigmadsp_compander_decay_get,
-			microburst_sigmadsp_compander_decay_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Compander Input Gain", 0x00FFFFFF, microburst_sigmadsp_compander_input_gain_get, 
-			microburst_sigmadsp_compander_input_gain_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Compander Post Gain 1", 0x07FFFFFF, microburst_sigmadsp_compander_post_gain_1_get,
-			microburst_sigmadsp_compander_post_gain_1_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Compander Post Gain 2", 0x07FFFFFF, microburst_sigmadsp_compander_post_gain_2_get,
-			microburst_sigmadsp_compander_post_gain_2_put),
         /*		SOC_SINGLE_BOOL_EXT("Microburst SigmaDSP TX EQ", 0, microburst_sigmadsp_tx_eq_get,
 				microburst_sigmadsp_tx_eq_put),
 		SOC_SINGLE_BOOL_EXT("Microburst SigmaDSP RX EQ", 0, microburst_sigmadsp_rx_eq_get,
@@ -2467,20 +2570,6 @@ static const struct snd_kcontrol_new microburst_sigmadsp_controls[] = {
 				microburst_sigmadsp_input_source_put),
 		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Sig Gen Select", 4, microburst_sigmadsp_sig_gen_select_get,
 				microburst_sigmadsp_sig_gen_select_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP CW Monitor Level", 63, microburst_sigmadsp_cw_monitor_level_get,
-				microburst_sigmadsp_cw_monitor_level_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Voice Monitor Level", 63, microburst_sigmadsp_voice_monitor_level_get,
-				microburst_sigmadsp_voice_monitor_level_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP CW Monitor Right Pan", 0x07FFFFFF, microburst_sigmadsp_cw_monitor_right_pan_get,
-			microburst_sigmadsp_cw_monitor_right_pan_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP CW Monitor Left Pan", 0x07FFFFFF, microburst_sigmadsp_cw_monitor_left_pan_get,
-			microburst_sigmadsp_cw_monitor_left_pan_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Voice Monitor Right Pan", 0x07FFFFFF, microburst_sigmadsp_voice_monitor_right_pan_get,
-			microburst_sigmadsp_voice_monitor_right_pan_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Voice Monitor Left Pan", 0x07FFFFFF, microburst_sigmadsp_voice_monitor_left_pan_get,
-			microburst_sigmadsp_voice_monitor_left_pan_put),
-		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Sig Gen Level", 63, microburst_sigmadsp_sig_gen_level_get,
-				microburst_sigmadsp_sig_gen_level_put),
 		SOC_SINGLE_INT_EXT("Microburst SigmaDSP CW Sidetone", 10000, microburst_sigmadsp_cw_sidetone_get,
 				microburst_sigmadsp_cw_sidetone_put),
 		SOC_SINGLE_INT_EXT("Microburst SigmaDSP TX Filter Bandwidth", 2, microburst_sigmadsp_tx_filter_bw_get,
@@ -2527,10 +2616,6 @@ static const struct snd_kcontrol_new microburst_sigmadsp_controls[] = {
 			    microburst_sigmadsp_compressor_meter_readback_input_put),
 		SOC_SINGLE_INT_EXT("Microburst SigmaDSP Comp Meter Out Readback", 0x008000000, microburst_sigmadsp_compressor_meter_readback_output_get,
 			    microburst_sigmadsp_compressor_meter_readback_output_put),
-		SOC_SINGLE_INT_EXT("Extra Line Input Gain", 0x7FFFFFF, microburst_sigmadsp_extra_line_input_gain_get, 
-			microburst_sigmadsp_extra_line_input_gain_put),
-		SOC_SINGLE_INT_EXT("Extra Mic Input Gain", 0x7FFFFFF, microburst_sigmadsp_extra_mic_input_gain_get, 
-			microburst_sigmadsp_extra_mic_input_gain_put),
 		SOC_SINGLE_INT_EXT("Codec Binary Version", 0xFFFFFF, microburst_sigmadsp_binary_version_get,
 			microburst_sigmadsp_binary_version_put),
 		SOC_SINGLE_INT_EXT("Codec Module Version", 0xFFFFFF, microburst_sigmadsp_module_version_get,
@@ -3188,6 +3273,10 @@ static int adau1761_probe(struct snd_soc_codec *codec)
 		else {
 			ret = snd_soc_add_controls(codec, microburst_sigmadsp_controls, ARRAY_SIZE(microburst_sigmadsp_controls));
 			//printk("MB-codecdsp: adding kcontrols for dsp module\n");
+			if (!ret)
+				ret = adau1761_dsp_param_add_controls(codec);
+			if (!ret)
+				ret = adau1761_meter_add_controls(codec);
 
 		if (ret)
 			return ret;
@@ -3196,11 +3285,51 @@ static int adau1761_probe(struct snd_soc_codec *codec)
 	return 0;
 }
 
+static int adau1761_remove(struct snd_soc_codec *codec)
+{
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	struct adau1761_meter *meter = adau->meter;
+
+	/* the controls outlive the codec, their handlers check for NULL */
+	if (meter) {
+		mutex_lock(&meter->rate_lock);
+		adau->meter = NULL;
+		mutex_unlock(&meter->rate_lock);
+		adau1761_meter_stop(meter);
+	}
+
+	return adau17x1_remove(codec);
+}
+
+static int adau1761_suspend(struct snd_soc_codec *codec, pm_message_t state)
+{
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+
+	adau1761_meter_stop(adau->meter);
+
+	return adau17x1_suspend(codec, state);
+}
+
+static int adau1761_resume(struct snd_soc_codec *codec)
+{
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
+	int ret;
+
+	ret = adau17x1_resume(codec);
+	if (ret)
+		return ret;
+
+	ret = adau1761_dsp_param_sync(codec);
+	adau1761_meter_start(adau->meter);
+
+	return ret;
+}
+
 static struct snd_soc_codec_driver adau1761_codec_driver = {
 	.probe			= adau1761_probe,
-	.remove			= adau17x1_remove,
-	.suspend		= adau17x1_suspend,
-	.resume			= adau17x1_resume,
+	.remove			= adau1761_remove,
+	.suspend		= adau1761_suspend,
+	.resume			= adau1761_resume,
 	.set_bias_level		= adau1761_set_bias_level,
 
 	.controls		= adau1761_controls,
@@ -754,18 +754,30 @@ bool adau17x1_volatile_register(struct device *dev, unsigned int reg)
 }
 EXPORT_SYMBOL_GPL(adau17x1_volatile_register);
 
+static const struct sigma_ram adau17x1_sigma_ram[] = {
+	{ .start = 0x0000, .words = 1024, .width = 4 },	/* parameter RAM */
+	{ .start = 0x0800, .words = 1024, .width = 5 },	/* program RAM */
+};
+
 int adau17x1_load_firmware(struct snd_soc_codec *codec, const char *firmware)
 {
+	struct adau *adau = snd_soc_codec_get_drvdata(codec);
 	int ret;
 	int dspsr;
 
+	if (!adau->sigma) {
+		adau->sigma = sigma_dsp_init(codec->dev, adau->regmap,
+			adau17x1_sigma_ram, ARRAY_SIZE(adau17x1_sigma_ram));
+		if (!adau->sigma)
+			return -ENOMEM;
+	}
+
 	dspsr = snd_soc_read(codec, ADAU17X1_DSP_SAMPLING_RATE);
 
 	snd_soc_write(codec, ADAU17X1_DSP_ENABLE, 1);
 	snd_soc_write(codec, ADAU17X1_DSP_SAMPLING_RATE, 0xf);
 
-	ret = process_sigma_firmware_regmap(codec->dev, codec->control_data,
-		firmware);
+	ret = sigma_dsp_load(adau->sigma, firmware);
 	if (ret) {
 		snd_soc_write(codec, ADAU17X1_DSP_ENABLE, 0);
 		return ret;
@@ -878,6 +890,8 @@ int __devinit adau17x1_bus_probe(struct device *dev, struct regmap *regmap,
 	}
 
 	adau->regmap = regmap;
+	mutex_init(&adau->safeload_lock);
+	mutex_init(&adau->dsp_param_lock);
 
 	dev_set_drvdata(dev, adau);
 	adau->control_type = control_type;
@@ -899,6 +913,7 @@ void adau17x1_bus_remove(struct device *dev)
 {
 	struct adau *adau = dev_get_drvdata(dev);
 
+	sigma_dsp_free(adau->sigma);
 	regmap_exit(adau->regmap);
 	kfree(adau);
 }
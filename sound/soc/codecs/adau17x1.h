@@ -2,6 +2,8 @@
 #define __ADAU17X1_H__
 
 #include <linux/regmap.h>
+#include <linux/mutex.h>
+#include <linux/ktime.h>
 #include <sound/adau17x1.h>
 
 enum adau17x1_type {
@@ -41,6 +43,9 @@ extern const struct snd_soc_dai_ops adau17x1_dai_ops;
 
 int adau17x1_load_firmware(struct snd_soc_codec *codec, const char *firmware);
 
+struct sigma_dsp;
+struct adau1761_meter;
+
 struct adau {
 	unsigned int sysclk;
 	unsigned int sysclk_div;
@@ -63,6 +68,22 @@ struct adau {
 	bool dsp_capture_bypass;
 
 	struct regmap *regmap;
+
+	/* serializes use of the SigmaDSP safeload slots */
+	struct mutex safeload_lock;
+	/* when the last triggered safeload has certainly run */
+	ktime_t safeload_done;
+
+	/* shadow copies of the table driven SigmaDSP parameters */
+	struct mutex dsp_param_lock;
+	int *dsp_param_val;
+	unsigned long *dsp_param_dirty;
+
+	/* parsed firmware and shadow of the DSP RAMs */
+	struct sigma_dsp *sigma;
+
+	/* SigmaDSP level meter sampler */
+	struct adau1761_meter *meter;
 };
 
 #define ADAU17X1_CLOCK_CONTROL		0x4000
@@ -6,13 +6,17 @@
  * Licensed under the GPL-2 or later.
  */
 
+#include <linux/bitmap.h>
 #include <linux/crc32.h>
 #include <linux/delay.h>
 #include <linux/firmware.h>
 #include <linux/kernel.h>
 #include <linux/i2c.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
 #include <linux/regmap.h>
 #include <linux/module.h>
+#include <linux/slab.h>
 
 #include "sigma.h"
 
@@ -120,37 +124,22 @@ process_sigma_actions(struct sigma_firmware *ssfw)
 	return 0;
 }
 
-static int _process_sigma_firmware(struct device *dev,
-	struct sigma_firmware *ssfw, const char *name)
+static int sigma_firmware_verify(struct device *dev,
+	const struct firmware *fw)
 {
-	int ret;
 	struct sigma_firmware_header *ssfw_head;
-	const struct firmware *fw;
 	u32 crc;
 
-	pr_debug("%s: loading firmware %s\n", __func__, name);
-
-	/* first load the blob */
-	ret = request_firmware(&fw, name, dev);
-	if (ret) {
-		pr_debug("%s: request_firmware() failed with %i\n", __func__, ret);
-		return ret;
-	}
-	ssfw->fw = fw;
-
-	/* then verify the header */
-	ret = -EINVAL;
-
 	/* Reject too small or unreasonable large files */
 	if (fw->size < sizeof(*ssfw_head) || fw->size > 0x100000) {
 		dev_err(dev, "Failed to load firmware: Invalid size\n");
-		goto done;
+		return -EINVAL;
 	}
 
 	ssfw_head = (void *)fw->data;
 	if (memcmp(ssfw_head->magic, SIGMA_MAGIC, ARRAY_SIZE(ssfw_head->magic))) {
 		dev_err(dev, "Failed to load firmware: Invalid magic\n");
-		goto done;
+		return -EINVAL;
 	}
 
 	crc = crc32(0, fw->data + sizeof(*ssfw_head),
@@ -159,10 +148,34 @@ static int _process_sigma_firmware(struct device *dev,
 	if (crc != le32_to_cpu(ssfw_head->crc)) {
 		dev_err(dev, "Failed to load firmware: Wrong crc checksum:" \
 			" expected %x got %x\n", le32_to_cpu(ssfw_head->crc), crc);
-		goto done;
+		return -EINVAL;
 	}
 
-	ssfw->pos = sizeof(*ssfw_head);
+	return 0;
+}
+
+static int _process_sigma_firmware(struct device *dev,
+	struct sigma_firmware *ssfw, const char *name)
+{
+	int ret;
+	const struct firmware *fw;
+
+	pr_debug("%s: loading firmware %s\n", __func__, name);
+
+	/* first load the blob */
+	ret = request_firmware(&fw, name, dev);
+	if (ret) {
+		pr_debug("%s: request_firmware() failed with %i\n", __func__, ret);
+		return ret;
+	}
+	ssfw->fw = fw;
+
+	/* then verify the header */
+	ret = sigma_firmware_verify(dev, fw);
+	if (ret)
+		goto done;
+
+	ssfw->pos = sizeof(struct sigma_firmware_header);
 
 	/* finally process all of the actions */
 	ret = process_sigma_actions(ssfw);
@@ -198,4 +211,413 @@ int process_sigma_firmware_regmap(struct device *dev, struct regmap *regmap,
 }
 EXPORT_SYMBOL(process_sigma_firmware_regmap);
 
+/*
+ * Cached SigmaDSP programs
+ *
+ * A sigma_dsp parses and checks each firmware file only the first time it
+ * is loaded, and keeps its actions with writes that continue each other in
+ * one of the DSP RAMs merged into single bursts.  It also remembers a crc32
+ * of the last chunk written to each page of those RAMs, so a program that
+ * is loaded again, or one sharing code or coefficients with the program in
+ * place, only has the pages that differ downloaded.  Anything else writing
+ * to the RAMs must call sigma_dsp_invalidate_range().
+ */
+#define SIGMA_PAGE_WORDS	32
+
+struct sigma_block {
+	u8 instr;
+	unsigned int addr;
+	size_t len;		/* payload bytes, or the delay in us */
+	const struct sigma_ram *ram;
+	const u8 *data;
+};
+
+struct sigma_program {
+	struct list_head list;
+	const char *name;
+	unsigned int num_blocks;
+	struct sigma_block *blocks;
+	u8 *data;
+};
+
+struct sigma_dsp {
+	struct device *dev;
+	struct regmap *regmap;
+	const struct sigma_ram *ram;
+	unsigned int num_ram;
+
+	struct mutex lock;
+	struct list_head programs;
+
+	unsigned int num_pages;
+	u32 *shadow;
+	unsigned long *shadow_valid;
+};
+
+static const struct sigma_ram *sigma_dsp_find_ram(struct sigma_dsp *sdsp,
+	unsigned int addr, size_t len)
+{
+	const struct sigma_ram *ram;
+	unsigned int i;
+
+	for (i = 0; i < sdsp->num_ram; i++) {
+		ram = &sdsp->ram[i];
+		if (addr < ram->start || len % ram->width)
+			continue;
+		if (addr - ram->start + len / ram->width <= ram->words)
+			return ram;
+	}
+
+	return NULL;
+}
+
+static unsigned int sigma_dsp_page(struct sigma_dsp *sdsp,
+	const struct sigma_ram *ram, unsigned int addr)
+{
+	unsigned int page = (addr - ram->start) / SIGMA_PAGE_WORDS;
+	const struct sigma_ram *r;
+
+	for (r = sdsp->ram; r != ram; r++)
+		page += DIV_ROUND_UP(r->words, SIGMA_PAGE_WORDS);
+
+	return page;
+}
+
+/* Forget what the shadow knows about the pages covering addr..addr+words-1 */
+void sigma_dsp_invalidate_range(struct sigma_dsp *sdsp, unsigned int addr,
+	unsigned int words)
+{
+	const struct sigma_ram *ram;
+	unsigned int start, end, page, last;
+	unsigned int i;
+
+	if (!sdsp || !words)
+		return;
+
+	for (i = 0; i < sdsp->num_ram; i++) {
+		ram = &sdsp->ram[i];
+		start = max(addr, ram->start);
+		end = min(addr + words, ram->start + ram->words);
+		if (start >= end)
+			continue;
+
+		last = sigma_dsp_page(sdsp, ram, end - 1);
+		for (page = sigma_dsp_page(sdsp, ram, start); page <= last; page++)
+			clear_bit(page, sdsp->shadow_valid);
+	}
+}
+EXPORT_SYMBOL(sigma_dsp_invalidate_range);
+
+/* Return the action at *pos and step past it, or NULL at the end of fw */
+static struct sigma_action *sigma_next_action(const struct firmware *fw,
+	size_t *pos)
+{
+	struct sigma_action *sa;
+	size_t size;
+
+	if (*pos + sizeof(*sa) > fw->size)
+		return NULL;
+
+	sa = (struct sigma_action *)(fw->data + *pos);
+	size = sigma_action_size(sa);
+	if (size > UINT_MAX - *pos || *pos + size > fw->size)
+		return NULL;
+
+	*pos += size;
+	return sa;
+}
+
+static void sigma_program_free(struct sigma_program *prog)
+{
+	kfree(prog->blocks);
+	kfree(prog->data);
+	kfree(prog->name);
+	kfree(prog);
+}
+
+static struct sigma_program *sigma_program_parse(struct sigma_dsp *sdsp,
+	const char *name)
+{
+	const struct sigma_ram *ram;
+	const struct firmware *fw;
+	struct sigma_program *prog;
+	struct sigma_action *sa;
+	struct sigma_block *b;
+	unsigned int count;
+	unsigned int addr;
+	size_t pos, len;
+	u8 *data;
+	int ret;
+
+	ret = request_firmware(&fw, name, sdsp->dev);
+	if (ret)
+		return ERR_PTR(ret);
+
+	ret = sigma_firmware_verify(sdsp->dev, fw);
+	if (ret)
+		goto err_release;
+
+	count = 0;
+	pos = sizeof(struct sigma_firmware_header);
+	while (sigma_next_action(fw, &pos))
+		count++;
+
+	ret = -ENOMEM;
+	prog = kzalloc(sizeof(*prog), GFP_KERNEL);
+	if (!prog)
+		goto err_release;
+	prog->name = kstrdup(name, GFP_KERNEL);
+	prog->blocks = kcalloc(count, sizeof(*prog->blocks), GFP_KERNEL);
+	/* the payloads never add up to more than the file */
+	prog->data = kmalloc(fw->size, GFP_KERNEL);
+	if (!prog->name || !prog->blocks || !prog->data)
+		goto err_free;
+
+	ret = -EINVAL;
+	data = prog->data;
+	b = NULL;
+	pos = sizeof(struct sigma_firmware_header);
+	while ((sa = sigma_next_action(fw, &pos))) {
+		len = sigma_action_len(sa);
+
+		switch (sa->instr) {
+		case SIGMA_ACTION_WRITEXBYTES:
+		case SIGMA_ACTION_WRITESINGLE:
+		case SIGMA_ACTION_WRITESAFELOAD:
+			if (len < 2)
+				goto err_free;
+			len -= 2;
+			addr = be16_to_cpu(sa->addr);
+			ram = NULL;
+			if (sa->instr != SIGMA_ACTION_WRITESAFELOAD)
+				ram = sigma_dsp_find_ram(sdsp, addr, len);
+
+			memcpy(data, sa->payload, len);
+			if (ram && b && b->ram == ram &&
+			    b->addr + b->len / ram->width == addr) {
+				/* continues the previous write, one burst */
+				b->len += len;
+			} else {
+				b = &prog->blocks[prog->num_blocks++];
+				b->instr = SIGMA_ACTION_WRITEXBYTES;
+				b->addr = addr;
+				b->len = len;
+				b->ram = ram;
+				b->data = data;
+			}
+			data += len;
+			break;
+		case SIGMA_ACTION_DELAY:
+			b = &prog->blocks[prog->num_blocks++];
+			b->instr = SIGMA_ACTION_DELAY;
+			b->len = len;
+			b->ram = NULL;
+			break;
+		case SIGMA_ACTION_END:
+			goto done;
+		default:
+			goto err_free;
+		}
+	}
+
+	if (pos != fw->size)
+		goto err_free;
+
+done:
+	release_firmware(fw);
+
+	dev_dbg(sdsp->dev, "%s: %u actions in %u blocks\n", name, count,
+		prog->num_blocks);
+
+	return prog;
+
+err_free:
+	sigma_program_free(prog);
+err_release:
+	release_firmware(fw);
+	return ERR_PTR(ret);
+}
+
+static int sigma_dsp_write_run(struct sigma_dsp *sdsp,
+	const struct sigma_block *b, unsigned int start, unsigned int end)
+{
+	unsigned int width = b->ram->width;
+
+	if (start == end)
+		return 0;
+
+	return regmap_raw_write(sdsp->regmap, start,
+		b->data + (start - b->addr) * width, (end - start) * width);
+}
+
+/* Write a RAM block, leaving out the pages the shadow says are in place */
+static int sigma_dsp_write_ram(struct sigma_dsp *sdsp,
+	const struct sigma_block *b)
+{
+	const struct sigma_ram *ram = b->ram;
+	unsigned int end = b->addr + b->len / ram->width;
+	unsigned int addr = b->addr;
+	unsigned int run = addr;
+	unsigned int next, page, words;
+	u32 crc;
+	int ret;
+
+	while (addr < end) {
+		next = ram->start + rounddown(addr - ram->start, SIGMA_PAGE_WORDS)
+			+ SIGMA_PAGE_WORDS;
+		next = min(next, end);
+		words = next - addr;
+
+		/* seeded with the extent, so partial pages only match themselves */
+		crc = crc32(addr ^ (words << 16),
+			b->data + (addr - b->addr) * ram->width,
+			words * ram->width);
+
+		page = sigma_dsp_page(sdsp, ram, addr);
+		if (test_bit(page, sdsp->shadow_valid) &&
+		    sdsp->shadow[page] == crc) {
+			ret = sigma_dsp_write_run(sdsp, b, run, addr);
+			if (ret)
+				return ret;
+			run = next;
+		} else {
+			sdsp->shadow[page] = crc;
+			set_bit(page, sdsp->shadow_valid);
+		}
+
+		addr = next;
+	}
+
+	return sigma_dsp_write_run(sdsp, b, run, end);
+}
+
+static void sigma_delay(size_t us)
+{
+	if (us < 20)
+		udelay(us);
+	else
+		usleep_range(us, us + us / 4);
+}
+
+static int sigma_program_download(struct sigma_dsp *sdsp,
+	const struct sigma_program *prog)
+{
+	const struct sigma_block *b;
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < prog->num_blocks && !ret; i++) {
+		b = &prog->blocks[i];
+
+		if (b->instr == SIGMA_ACTION_DELAY) {
+			sigma_delay(b->len);
+		} else if (b->ram) {
+			ret = sigma_dsp_write_ram(sdsp, b);
+		} else {
+			/* the length in bytes bounds the one in words */
+			sigma_dsp_invalidate_range(sdsp, b->addr, b->len);
+			ret = regmap_raw_write(sdsp->regmap, b->addr, b->data,
+				b->len);
+		}
+	}
+
+	/* what made it to the DSP is unknown now */
+	if (ret)
+		bitmap_zero(sdsp->shadow_valid, sdsp->num_pages);
+
+	return ret;
+}
+
+/**
+ * sigma_dsp_load - download a SigmaStudio firmware file
+ * @sdsp: the DSP
+ * @name: firmware file name
+ *
+ * The file is requested and parsed the first time it is loaded on @sdsp
+ * and reused afterwards.  Only the RAM pages that differ from what was
+ * last written there are downloaded.
+ */
+int sigma_dsp_load(struct sigma_dsp *sdsp, const char *name)
+{
+	struct sigma_program *prog;
+	int ret;
+
+	mutex_lock(&sdsp->lock);
+
+	list_for_each_entry(prog, &sdsp->programs, list)
+		if (!strcmp(prog->name, name))
+			goto download;
+
+	prog = sigma_program_parse(sdsp, name);
+	if (IS_ERR(prog)) {
+		ret = PTR_ERR(prog);
+		goto out;
+	}
+	list_add(&prog->list, &sdsp->programs);
+
+download:
+	ret = sigma_program_download(sdsp, prog);
+out:
+	mutex_unlock(&sdsp->lock);
+
+	return ret;
+}
+EXPORT_SYMBOL(sigma_dsp_load);
+
+void sigma_dsp_free(struct sigma_dsp *sdsp)
+{
+	struct sigma_program *prog, *tmp;
+
+	if (!sdsp)
+		return;
+
+	list_for_each_entry_safe(prog, tmp, &sdsp->programs, list)
+		sigma_program_free(prog);
+	kfree(sdsp->shadow);
+	kfree(sdsp->shadow_valid);
+	kfree(sdsp);
+}
+EXPORT_SYMBOL(sigma_dsp_free);
+
+/**
+ * sigma_dsp_init - set up program caching for a SigmaDSP
+ * @dev: the device, used to request firmware
+ * @regmap: regmap of the device, for I2C or SPI
+ * @ram: the word addressed RAMs of the DSP, which are shadowed
+ * @num_ram: number of entries in @ram
+ *
+ * Returns NULL when out of memory.
+ */
+struct sigma_dsp *sigma_dsp_init(struct device *dev, struct regmap *regmap,
+	const struct sigma_ram *ram, unsigned int num_ram)
+{
+	struct sigma_dsp *sdsp;
+	unsigned int i;
+
+	sdsp = kzalloc(sizeof(*sdsp), GFP_KERNEL);
+	if (!sdsp)
+		return NULL;
+
+	sdsp->dev = dev;
+	sdsp->regmap = regmap;
+	sdsp->ram = ram;
+	sdsp->num_ram = num_ram;
+	mutex_init(&sdsp->lock);
+	INIT_LIST_HEAD(&sdsp->programs);
+
+	for (i = 0; i < num_ram; i++)
+		sdsp->num_pages += DIV_ROUND_UP(ram[i].words, SIGMA_PAGE_WORDS);
+
+	sdsp->shadow = kcalloc(sdsp->num_pages, sizeof(u32), GFP_KERNEL);
+	sdsp->shadow_valid = kcalloc(BITS_TO_LONGS(sdsp->num_pages),
+			sizeof(long), GFP_KERNEL);
+	if (!sdsp->shadow || !sdsp->shadow_valid) {
+		sigma_dsp_free(sdsp);
+		return NULL;
+	}
+
+	return sdsp;
+}
+EXPORT_SYMBOL(sigma_dsp_init);
+
 MODULE_LICENSE("GPL");
@@ -52,4 +52,21 @@ extern int process_sigma_firmware(struct i2c_client *client, const char *name);
 extern int process_sigma_firmware_regmap(struct device *dev,
 		struct regmap *regmap, const char *name);
 
+/* A word addressed RAM of the DSP, e.g. program or parameter RAM */
+struct sigma_ram {
+	unsigned int start;
+	unsigned int words;
+	unsigned int width;	/* bytes per word */
+};
+
+struct sigma_dsp;
+
+extern struct sigma_dsp *sigma_dsp_init(struct device *dev,
+		struct regmap *regmap, const struct sigma_ram *ram,
+		unsigned int num_ram);
+extern void sigma_dsp_free(struct sigma_dsp *sdsp);
+extern int sigma_dsp_load(struct sigma_dsp *sdsp, const char *name);
+extern void sigma_dsp_invalidate_range(struct sigma_dsp *sdsp,
+		unsigned int addr, unsigned int words);
+
 #endif
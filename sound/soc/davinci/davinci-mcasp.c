@@ -590,6 +590,61 @@ static int davinci_config_channel_size(struct davinci_audio_dev *dev,
 	return 0;
 }
 
+/*
+ * With TDM the slot size may be wider than the sample, e.g. S16_LE in the
+ * 32 bit slots of a codec running BCLK = 64 * fs.  The sample stays left
+ * justified in the slot; capture data is rotated back down to bit 0.
+ */
+static void davinci_config_slot_size(struct davinci_audio_dev *dev,
+				     int sample_bits)
+{
+	u32 fmt;
+
+	if (dev->slot_width <= sample_bits)
+		return;
+
+	fmt = (dev->slot_width >> 1) - 1;
+	mcasp_mod_bits(dev->base + DAVINCI_MCASP_RXFMT_REG,
+					RXSSZ(fmt), RXSSZ(0x0F));
+	mcasp_mod_bits(dev->base + DAVINCI_MCASP_TXFMT_REG,
+					TXSSZ(fmt), TXSSZ(0x0F));
+	mcasp_mod_bits(dev->base + DAVINCI_MCASP_RXFMT_REG,
+			RXROT((dev->slot_width - sample_bits) >> 2), RXROT(7));
+}
+
+/* number of serializers moving data for this stream */
+static int davinci_mcasp_serializers(struct davinci_audio_dev *dev, int stream)
+{
+	u8 mode = (stream == SNDRV_PCM_STREAM_PLAYBACK) ? TX_MODE : RX_MODE;
+	int i, n = 0;
+
+	for (i = 0; i < dev->num_serializer; i++)
+		if (dev->serial_dir[i] == mode)
+			n++;
+
+	return n;
+}
+
+/* TDM slots carrying data for this stream */
+static u32 davinci_mcasp_slot_mask(struct davinci_audio_dev *dev, int stream)
+{
+	if (dev->tdm_mask[stream])
+		return dev->tdm_mask[stream];
+	if (dev->tdm_slots > 31)
+		return 0xffffffff;
+	return (1 << dev->tdm_slots) - 1;
+}
+
+/*
+ * Samples are interleaved slot by slot, and within a slot serializer by
+ * serializer, which is the order the McASP data port consumes them in.
+ */
+static int davinci_mcasp_channels(struct davinci_audio_dev *dev, int stream)
+{
+	return hweight32(davinci_mcasp_slot_mask(dev, stream)) *
+		davinci_mcasp_serializers(dev, stream);
+}
+
 static void davinci_hw_common_param(struct davinci_audio_dev *dev, int stream)
 {
 	int i;
@@ -649,12 +704,7 @@ static void davinci_hw_common_param(struct davinci_audio_dev *dev, int stream)
 
 static void davinci_hw_param(struct davinci_audio_dev *dev, int stream)
 {
-	int i, active_slots;
-	u32 mask = 0;
-
-	active_slots = (dev->tdm_slots > 31) ? 32 : dev->tdm_slots;
-	for (i = 0; i < active_slots; i++)
-		mask |= (1 << i);
+	u32 mask = davinci_mcasp_slot_mask(dev, stream);
 
 	mcasp_clr_bits(dev->base + DAVINCI_MCASP_ACLKXCTL_REG, TX_ASYNC);
 
@@ -666,7 +716,7 @@ static void davinci_hw_param(struct davinci_audio_dev *dev, int stream)
 		mcasp_set_reg(dev->base + DAVINCI_MCASP_TXTDM_REG, mask);
 		mcasp_set_bits(dev->base + DAVINCI_MCASP_TXFMT_REG, TXORD);
 
-		if ((dev->tdm_slots >= 2) || (dev->tdm_slots <= 32))
+		if ((dev->tdm_slots >= 2) && (dev->tdm_slots <= 32))
 			mcasp_mod_bits(dev->base + DAVINCI_MCASP_TXFMCTL_REG,
 					FSXMOD(dev->tdm_slots), FSXMOD(0x1FF));
 		else
@@ -682,7 +732,7 @@ static void davinci_hw_param(struct davinci_audio_dev *dev, int stream)
 				AHCLKRE);
 		mcasp_set_reg(dev->base + DAVINCI_MCASP_RXTDM_REG, mask);
 
-		if ((dev->tdm_slots >= 2) || (dev->tdm_slots <= 32))
+		if ((dev->tdm_slots >= 2) && (dev->tdm_slots <= 32))
 			mcasp_mod_bits(dev->base + DAVINCI_MCASP_RXFMCTL_REG,
 					FSRMOD(dev->tdm_slots), FSRMOD(0x1FF));
 		else
@@ -735,7 +785,16 @@ static int davinci_mcasp_hw_params(struct snd_pcm_substream *substream,
 	struct davinci_pcm_dma_params *dma_params =
 					&dev->dma_params[substream->stream];
 	int word_length;
-	u8 fifo_level;
+	unsigned int fifo_level;
+
+	if (dev->op_mode != DAVINCI_MCASP_DIT_MODE &&
+	    params_channels(params) !=
+			davinci_mcasp_channels(dev, substream->stream)) {
+		printk(KERN_ERR "davinci-mcasp: %u channels, TDM setup has %d\n",
+			params_channels(params),
+			davinci_mcasp_channels(dev, substream->stream));
+		return -EINVAL;
+	}
 
 	davinci_hw_common_param(dev, substream->stream);
 	if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
@@ -774,8 +833,8 @@ static int davinci_mcasp_hw_params(struct snd_pcm_substream *substream,
 	else
 		dma_params->acnt = dma_params->data_type;
 
-	dma_params->fifo_level = fifo_level;
 	davinci_config_channel_size(dev, word_length);
+	davinci_config_slot_size(dev, snd_pcm_format_width(params_format(params)));
 
 	return 0;
 }
@@ -818,12 +877,88 @@ static int davinci_mcasp_trigger(struct snd_pcm_substream *substream,
 	return ret;
 }
 
+/*
+ * Each DMA event has to feed every active serializer: with the FIFO that
+ * is numevt words per serializer, without it one word each.
+ */
+static unsigned int davinci_mcasp_fifo_level(struct davinci_audio_dev *dev,
+					     int stream)
+{
+	unsigned int numevt = (stream == SNDRV_PCM_STREAM_PLAYBACK) ?
+			      dev->txnumevt : dev->rxnumevt;
+	int serializers = davinci_mcasp_serializers(dev, stream);
+
+	if (numevt)
+		return numevt * serializers;
+	return (serializers > 1) ? serializers : 0;
+}
+
 static int davinci_mcasp_startup(struct snd_pcm_substream *substream,
 				 struct snd_soc_dai *dai)
 {
 	struct davinci_audio_dev *dev = snd_soc_dai_get_drvdata(dai);
+	int channels;
 
 	snd_soc_dai_set_dma_data(dai, substream, dev->dma_params);
+	/* known before the PCM is opened, which constrains periods to it */
+	dev->dma_params[substream->stream].fifo_level =
+			davinci_mcasp_fifo_level(dev, substream->stream);
+
+	if (dev->op_mode == DAVINCI_MCASP_DIT_MODE)
+		return 0;
+
+	/* a TDM frame is one sample per active slot and serializer */
+	channels = davinci_mcasp_channels(dev, substream->stream);
+	if (!channels)
+		return 0;
+
+	return snd_pcm_hw_constraint_minmax(substream->runtime,
+			SNDRV_PCM_HW_PARAM_CHANNELS, channels, channels);
+}
+
+/*
+ * @slots sets the frame length of both directions, @tx_mask and @rx_mask
+ * the slots carrying data (applied to every serializer of the direction).
+ * @slot_width, when wider than the sample, sets the slot size.  Called
+ * once by the machine driver, before the streams are opened.
+ */
+static int davinci_mcasp_set_tdm_slot(struct snd_soc_dai *dai,
+				      unsigned int tx_mask,
+				      unsigned int rx_mask,
+				      int slots, int slot_width)
+{
+	struct davinci_audio_dev *dev = snd_soc_dai_get_drvdata(dai);
+	u32 valid;
+
+	if (dev->op_mode == DAVINCI_MCASP_DIT_MODE)
+		return -EINVAL;
+
+	if (slots < 2 || slots > 32)
+		return -EINVAL;
+
+	switch (slot_width) {
+	case 0:
+	case 8:
+	case 12:
+	case 16:
+	case 20:
+	case 24:
+	case 28:
+	case 32:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	valid = (slots == 32) ? 0xffffffff : (1 << slots) - 1;
+	if ((tx_mask & ~valid) || (rx_mask & ~valid))
+		return -EINVAL;
+
+	dev->tdm_slots = slots;
+	dev->tdm_mask[SNDRV_PCM_STREAM_PLAYBACK] = tx_mask;
+	dev->tdm_mask[SNDRV_PCM_STREAM_CAPTURE] = rx_mask;
+	dev->slot_width = slot_width;
+
 	return 0;
 }
 
@@ -832,6 +967,7 @@ static struct snd_soc_dai_ops davinci_mcasp_dai_ops = {
 	.trigger	= davinci_mcasp_trigger,
 	.hw_params	= davinci_mcasp_hw_params,
 	.set_fmt	= davinci_mcasp_set_dai_fmt,
+	.set_tdm_slot	= davinci_mcasp_set_tdm_slot,
 
 };
 
@@ -839,16 +975,16 @@ static struct snd_soc_dai_driver davinci_mcasp_dai[] = {
 	{
 		.name		= "davinci-mcasp.0",
 		.playback	= {
-			.channels_min	= 2,
-			.channels_max 	= 2,
+			.channels_min	= 1,
+			.channels_max 	= DAVINCI_MCASP_MAX_CHANNELS,
 			.rates 		= DAVINCI_MCASP_RATES,
 			.formats 	= SNDRV_PCM_FMTBIT_S8 |
 						SNDRV_PCM_FMTBIT_S16_LE |
 						SNDRV_PCM_FMTBIT_S32_LE,
 		},
 		.capture 	= {
-			.channels_min 	= 2,
-			.channels_max 	= 2,
+			.channels_min 	= 1,
+			.channels_max 	= DAVINCI_MCASP_MAX_CHANNELS,
 			.rates 		= DAVINCI_MCASP_RATES,
 			.formats	= SNDRV_PCM_FMTBIT_S8 |
 						SNDRV_PCM_FMTBIT_S16_LE |
@@ -860,16 +996,16 @@ static struct snd_soc_dai_driver davinci_mcasp_dai[] = {
   {
 		.name		= "davinci-mcasp.2",
 		.playback	= {
-			.channels_min	= 2,
-			.channels_max 	= 2,
+			.channels_min	= 1,
+			.channels_max 	= DAVINCI_MCASP_MAX_CHANNELS,
 			.rates 		= DAVINCI_MCASP_RATES,
 			.formats 	= SNDRV_PCM_FMTBIT_S8 |
       SNDRV_PCM_FMTBIT_S16_LE |
       SNDRV_PCM_FMTBIT_S32_LE,
 		},
 		.capture 	= {
-			.channels_min 	= 2,
-			.channels_max 	= 2,
+			.channels_min 	= 1,
+			.channels_max 	= DAVINCI_MCASP_MAX_CHANNELS,
 			.rates 		= DAVINCI_MCASP_RATES,
 			.formats	= SNDRV_PCM_FMTBIT_S8 |
       SNDRV_PCM_FMTBIT_S16_LE |
@@ -937,6 +1073,7 @@ static int davinci_mcasp_probe(struct platform_device *pdev)
 	dma_data = &dev->dma_params[SNDRV_PCM_STREAM_PLAYBACK];
 	dma_data->asp_chan_q = pdata->asp_chan_q;
 	dma_data->ram_chan_q = pdata->ram_chan_q;
+	dma_data->sram_size = pdata->sram_size_playback;
 	if (cpu_is_ti81xx())
 		dma_data->dma_addr = (dma_addr_t) (pdata->tx_dma_offset);
         else
@@ -956,6 +1093,7 @@ static int davinci_mcasp_probe(struct platform_device *pdev)
 	dma_data = &dev->dma_params[SNDRV_PCM_STREAM_CAPTURE];
 	dma_data->asp_chan_q = pdata->asp_chan_q;
 	dma_data->ram_chan_q = pdata->ram_chan_q;
+	dma_data->sram_size = pdata->sram_size_capture;
 	if (cpu_is_ti81xx())
 		dma_data->dma_addr = (dma_addr_t) (pdata->rx_dma_offset);
 	else
@@ -29,6 +29,7 @@
 #include "davinci-pcm.h"
 
 #define DAVINCI_MCASP_RATES	SNDRV_PCM_RATE_8000_96000
+#define DAVINCI_MCASP_MAX_CHANNELS	32
 #define DAVINCI_MCASP_I2S_DAI	0
 #define DAVINCI_MCASP_DIT_DAI	1
 
@@ -52,6 +53,8 @@ struct davinci_audio_dev {
 
 	/* McASP specific data */
 	int	tdm_slots;
+	u32	tdm_mask[2];	/* active slots per stream, 0 = all */
+	int	slot_width;	/* bits per slot, 0 = sample width */
 	u8	op_mode;
 	u8	num_serializer;
 	u8	*serial_dir;
@@ -16,11 +16,18 @@
 #include <linux/slab.h>
 #include <linux/dma-mapping.h>
 #include <linux/kernel.h>
+#include <linux/hrtimer.h>
+#include <linux/list.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/mutex.h>
+#include <linux/mm.h>
 
 #include <sound/core.h>
 #include <sound/pcm.h>
 #include <sound/pcm_params.h>
 #include <sound/soc.h>
+#include <sound/davinci-pcm-shm.h>
 
 #include <asm/dma.h>
 
@@ -29,11 +36,36 @@
 #include <mach/sram.h>
 #else
 #include <asm/hardware/edma.h>
+#include <plat/sram.h>
+
+/* ping/pong buffers come from OCMC RAM */
+#define sram_alloc	ti81xx_ocmc_alloc
+#define sram_free	ti81xx_ocmc_free
 #endif
 
 
 #include "davinci-pcm.h"
 
+/*
+ * Low-latency mode: the EDMA completion interrupt is raised only every
+ * irq_periods periods, and an hrtimer samples the DMA position into a
+ * cache that the pointer callback returns without locking or MMIO.  The
+ * timer also signals the elapsed periods.  SRAM ping/pong is not used.
+ *
+ * The timer fires once per period, half a period after each boundary, so
+ * a stream costs rate / period_size timer interrupts plus
+ * rate / (period_size * irq_periods) DMA interrupts per second.  That is
+ * the period interrupt rate of normal mode plus the DMA share, and the
+ * pointer is never more than one period stale.
+ */
+static int low_latency;
+module_param(low_latency, bool, 0644);
+MODULE_PARM_DESC(low_latency, "hrtimer driven pointer, fewer DMA interrupts");
+
+static int irq_periods = 4;
+module_param(irq_periods, int, 0644);
+MODULE_PARM_DESC(irq_periods, "periods per DMA interrupt in low-latency mode");
+
 #ifdef DEBUG
 static void print_buf_info(int slot, char *name)
 {
@@ -64,8 +96,8 @@ static struct snd_pcm_hardware pcm_hardware_playback = {
 		  SNDRV_PCM_RATE_KNOT),
 	.rate_min = 8000,
 	.rate_max = 96000,
-	.channels_min = 2,
-	.channels_max = 2,
+	.channels_min = 1,
+	.channels_max = 32,	/* McASP TDM */
 	.buffer_bytes_max = 128 * 1024,
 	.period_bytes_min = 32,
 	.period_bytes_max = 8 * 1024,
@@ -86,8 +118,8 @@ static struct snd_pcm_hardware pcm_hardware_capture = {
 		  SNDRV_PCM_RATE_KNOT),
 	.rate_min = 8000,
 	.rate_max = 96000,
-	.channels_min = 2,
-	.channels_max = 2,
+	.channels_min = 1,
+	.channels_max = 32,	/* McASP TDM */
 	.buffer_bytes_max = 128 * 1024,
 	.period_bytes_min = 32,
 	.period_bytes_max = 8 * 1024,
@@ -143,8 +175,146 @@ struct davinci_runtime_data {
 	int ram_link2;
 	struct edmacc_param asp_params;
 	struct edmacc_param ram_params;
+
+	struct snd_pcm_substream *substream;
+	struct list_head node;		/* on davinci_pcm_list */
+
+	/* buffer shared with a remote core, see davinci_pcm_register_shm() */
+	struct davinci_pcm_shm_ops *shm;
+	struct snd_dma_buffer shm_buf;
+
+	/* low-latency mode */
+	bool lowlat;
+	unsigned int irq_periods;	/* periods per DMA interrupt */
+	struct hrtimer timer;
+	ktime_t tick;
+	int timer_running;
+	unsigned int cached_pos;	/* bytes, sampled by the hrtimer */
+	unsigned int last_period;
+
+	/* statistics, see the davinci-pcm/latency debugfs file */
+	unsigned int dma_irqs;
+	unsigned int timer_ticks;
+	unsigned int timer_elapsed;
 };
 
+/* open substreams, for the latency report */
+static LIST_HEAD(davinci_pcm_list);
+static DEFINE_SPINLOCK(davinci_pcm_list_lock);
+
+static struct davinci_pcm_shm_ops *davinci_pcm_shm;
+static unsigned int davinci_pcm_shm_users;	/* buffers not yet freed */
+static DEFINE_MUTEX(davinci_pcm_shm_mutex);
+
+/**
+ * davinci_pcm_register_shm - allocate PCM buffers from a remote core's memory
+ * @ops: buffer provider
+ *
+ * Streams configured from now on get their buffer from @ops, and @ops is
+ * told of each elapsed period; see <sound/davinci-pcm-shm.h>.  Only one
+ * provider can be registered.
+ */
+int davinci_pcm_register_shm(struct davinci_pcm_shm_ops *ops)
+{
+	int ret = 0;
+
+	mutex_lock(&davinci_pcm_shm_mutex);
+	if (davinci_pcm_shm)
+		ret = -EBUSY;
+	else
+		davinci_pcm_shm = ops;
+	mutex_unlock(&davinci_pcm_shm_mutex);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(davinci_pcm_register_shm);
+
+/**
+ * davinci_pcm_unregister_shm - stop using a buffer provider
+ * @ops: buffer provider
+ *
+ * Fails with -EBUSY, leaving @ops registered, while a stream still has a
+ * buffer from it: EDMA may be running on that buffer, so the memory must
+ * stay valid until the stream's hw_free.
+ */
+int davinci_pcm_unregister_shm(struct davinci_pcm_shm_ops *ops)
+{
+	int ret = 0;
+
+	mutex_lock(&davinci_pcm_shm_mutex);
+	if (davinci_pcm_shm == ops) {
+		if (davinci_pcm_shm_users)
+			ret = -EBUSY;
+		else
+			davinci_pcm_shm = NULL;
+	}
+	mutex_unlock(&davinci_pcm_shm_mutex);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(davinci_pcm_unregister_shm);
+
+static int davinci_pcm_shm_alloc(struct snd_pcm_substream *substream,
+				 size_t size)
+{
+	struct davinci_runtime_data *prtd = substream->runtime->private_data;
+	struct snd_dma_buffer *buf = &prtd->shm_buf;
+	struct davinci_pcm_shm_ops *ops;
+	int ret = -ENODEV;
+
+	mutex_lock(&davinci_pcm_shm_mutex);
+	ops = davinci_pcm_shm;
+	if (!ops || !try_module_get(ops->owner))
+		goto out;
+
+	buf->area = ops->alloc(substream->pcm->device, substream->stream,
+			       size, &buf->addr);
+	if (!buf->area) {
+		module_put(ops->owner);
+		ret = -ENOMEM;
+		goto out;
+	}
+	buf->dev = substream->dma_buffer.dev;
+	buf->bytes = size;
+	buf->private_data = NULL;
+
+	snd_pcm_set_runtime_buffer(substream, buf);
+	prtd->shm = ops;
+	davinci_pcm_shm_users++;
+	ret = 0;
+out:
+	mutex_unlock(&davinci_pcm_shm_mutex);
+	return ret;
+}
+
+static void davinci_pcm_shm_free(struct snd_pcm_substream *substream)
+{
+	struct davinci_runtime_data *prtd = substream->runtime->private_data;
+	struct davinci_pcm_shm_ops *ops = prtd->shm;
+
+	snd_pcm_set_runtime_buffer(substream, NULL);
+	mutex_lock(&davinci_pcm_shm_mutex);
+	ops->free(substream->pcm->device, substream->stream,
+		  prtd->shm_buf.area, prtd->shm_buf.bytes);
+	prtd->shm = NULL;
+	davinci_pcm_shm_users--;
+	mutex_unlock(&davinci_pcm_shm_mutex);
+	module_put(ops->owner);
+}
+
+static void davinci_pcm_shm_elapsed(struct davinci_runtime_data *prtd,
+				    unsigned int pos)
+{
+	struct snd_pcm_substream *substream = prtd->substream;
+
+	if (prtd->shm->period_elapsed)
+		prtd->shm->period_elapsed(substream->pcm->device,
+					  substream->stream, pos);
+}
+
+static snd_pcm_uframes_t
+davinci_pcm_pointer(struct snd_pcm_substream *substream);
+
 /*
  * Not used with ping/pong
  */
@@ -166,6 +336,8 @@ static void davinci_pcm_enqueue_dma(struct snd_pcm_substream *substream)
 
 	period_size = snd_pcm_lib_period_bytes(substream);
 	dma_offset = prtd->period * period_size;
+	/* one transfer, and so one interrupt, spans irq_periods periods */
+	period_size *= prtd->irq_periods;
 	dma_pos = runtime->dma_addr + dma_offset;
 	fifo_level = prtd->params->fifo_level;
 
@@ -206,7 +378,7 @@ static void davinci_pcm_enqueue_dma(struct snd_pcm_substream *substream)
 		edma_set_transfer_params(link, acnt, fifo_level, count,
 							fifo_level, ABSYNC);
 
-	prtd->period++;
+	prtd->period += prtd->irq_periods;
 	if (unlikely(prtd->period >= runtime->periods))
 		prtd->period = 0;
 }
@@ -222,6 +394,7 @@ static void davinci_pcm_dma_irq(unsigned link, u16 ch_status, void *data)
 	if (unlikely(ch_status != DMA_COMPLETE))
 		return;
 
+	prtd->dma_irqs++;
 	if (snd_pcm_running(substream)) {
 		if (prtd->ram_channel < 0) {
 			/* No ping/pong must fix up link dma data*/
@@ -229,23 +402,67 @@ static void davinci_pcm_dma_irq(unsigned link, u16 ch_status, void *data)
 			davinci_pcm_enqueue_dma(substream);
 			spin_unlock(&prtd->lock);
 		}
+		/* in low-latency mode the hrtimer reports the periods */
+		if (!prtd->lowlat) {
+			snd_pcm_period_elapsed(substream);
+			if (prtd->shm)
+				davinci_pcm_shm_elapsed(prtd,
+					frames_to_bytes(substream->runtime,
+						davinci_pcm_pointer(substream)));
+		}
+	}
+}
+
+static enum hrtimer_restart davinci_pcm_lowlat_tick(struct hrtimer *timer)
+{
+	struct davinci_runtime_data *prtd =
+		container_of(timer, struct davinci_runtime_data, timer);
+	struct snd_pcm_substream *substream = prtd->substream;
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	dma_addr_t src, dst;
+	unsigned int pos, period;
+
+	if (!prtd->timer_running)
+		return HRTIMER_NORESTART;
+
+	edma_get_position(prtd->asp_channel, &src, &dst);
+	if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
+		pos = src - runtime->dma_addr;
+	else
+		pos = dst - runtime->dma_addr;
+	/* the channel may be between a transfer and its reload */
+	if (pos >= runtime->dma_bytes)
+		pos = 0;
+	ACCESS_ONCE(prtd->cached_pos) = pos;
+	prtd->timer_ticks++;
+
+	period = pos / snd_pcm_lib_period_bytes(substream);
+	if (period != prtd->last_period) {
+		prtd->last_period = period;
+		prtd->timer_elapsed++;
 		snd_pcm_period_elapsed(substream);
+		if (prtd->shm)
+			davinci_pcm_shm_elapsed(prtd, pos);
+		/* the stream may have been stopped by an xrun */
+		if (!prtd->timer_running)
+			return HRTIMER_NORESTART;
 	}
+
+	hrtimer_forward_now(timer, prtd->tick);
+	return HRTIMER_RESTART;
 }
 
 static int allocate_sram(struct snd_pcm_substream *substream, unsigned size,
 		struct snd_pcm_hardware *ppcm)
 {
 	struct snd_dma_buffer *buf = &substream->dma_buffer;
-#if !defined(CONFIG_ARCH_TI81XX)	/* No SRAM support on TI81xx */
 	struct snd_dma_buffer *iram_dma = NULL;
 	dma_addr_t iram_phys = 0;
 	void *iram_virt = NULL;
-#endif
+
 	if (buf->private_data || !size)
 		return 0;
 
-#if !defined(CONFIG_ARCH_TI81XX)	/* No SRAM support on TI81xx */
 	ppcm->period_bytes_max = size;
 	iram_virt = sram_alloc(size, &iram_phys);
 	if (!iram_virt)
@@ -264,9 +481,6 @@ exit2:
 		sram_free(iram_virt, size);
 exit1:
 	return -ENOMEM;
-#else
-	return 0;
-#endif
 }
 
 /*
@@ -500,7 +714,7 @@ static int davinci_pcm_dma_request(struct snd_pcm_substream *substream)
 		goto exit2;
 
 	iram_dma = (struct snd_dma_buffer *)substream->dma_buffer.private_data;
-	if (iram_dma) {
+	if (iram_dma && !prtd->lowlat) {
 		if (request_ping_pong(substream, prtd, iram_dma) == 0)
 			return 0;
 		printk(KERN_WARNING "%s: dma channel allocation failed,"
@@ -541,11 +755,24 @@ static int davinci_pcm_trigger(struct snd_pcm_substream *substream, int cmd)
 	case SNDRV_PCM_TRIGGER_RESUME:
 	case SNDRV_PCM_TRIGGER_PAUSE_RELEASE:
 		edma_resume(prtd->asp_channel);
+		if (prtd->lowlat) {
+			prtd->timer_running = 1;
+			/* sample mid-period, away from the boundaries */
+			hrtimer_start(&prtd->timer,
+				      ktime_add_ns(prtd->tick,
+					ktime_to_ns(prtd->tick) >> 1),
+				      HRTIMER_MODE_REL);
+		}
 		break;
 	case SNDRV_PCM_TRIGGER_STOP:
 	case SNDRV_PCM_TRIGGER_SUSPEND:
 	case SNDRV_PCM_TRIGGER_PAUSE_PUSH:
 		edma_pause(prtd->asp_channel);
+		if (prtd->lowlat) {
+			/* the callback may be running us; it won't rearm */
+			prtd->timer_running = 0;
+			hrtimer_try_to_cancel(&prtd->timer);
+		}
 		break;
 	default:
 		ret = -EINVAL;
@@ -583,6 +810,27 @@ static int davinci_pcm_prepare(struct snd_pcm_substream *substream)
 		edma_start(prtd->asp_channel);
 		return 0;
 	}
+
+	if (prtd->lowlat) {
+		struct snd_pcm_runtime *runtime = substream->runtime;
+		struct davinci_pcm_dma_params *params = prtd->params;
+		unsigned int count;
+
+		/* a transfer is limited to 64k EDMA B or C counts */
+		count = snd_pcm_lib_period_bytes(substream) *
+			prtd->irq_periods / params->data_type;
+		if (params->fifo_level)
+			count /= params->fifo_level;
+		if (count > 0xffff)
+			return -EINVAL;
+
+		/* sample the position once per period */
+		prtd->tick = ns_to_ktime(div_u64((u64)runtime->period_size *
+						 NSEC_PER_SEC, runtime->rate));
+		prtd->cached_pos = 0;
+		prtd->last_period = 0;
+	}
+
 	prtd->period = 0;
 	davinci_pcm_enqueue_dma(substream);
 
@@ -604,6 +852,13 @@ davinci_pcm_pointer(struct snd_pcm_substream *substream)
 	int asp_count;
 	dma_addr_t asp_src, asp_dst;
 
+	if (prtd->lowlat) {
+		offset = bytes_to_frames(runtime, ACCESS_ONCE(prtd->cached_pos));
+		if (offset >= runtime->buffer_size)
+			offset = 0;
+		return offset;
+	}
+
 	spin_lock(&prtd->lock);
 	if (prtd->ram_channel >= 0) {
 		int ram_count;
@@ -654,6 +909,39 @@ davinci_pcm_pointer(struct snd_pcm_substream *substream)
 	return offset;
 }
 
+/*
+ * A period (half a period with ping/pong) must be a whole number of DMA
+ * events.  The event size depends on the sample format, so the step is
+ * only applied once the format has been narrowed down to one.
+ */
+static int davinci_pcm_rule_period_bytes(struct snd_pcm_hw_params *params,
+					 struct snd_pcm_hw_rule *rule)
+{
+	struct davinci_runtime_data *prtd = rule->private;
+	struct snd_interval *bits = hw_param_interval(params,
+					SNDRV_PCM_HW_PARAM_SAMPLE_BITS);
+	struct snd_interval *bytes = hw_param_interval(params,
+					SNDRV_PCM_HW_PARAM_PERIOD_BYTES);
+	struct snd_interval t;
+	unsigned int event_bytes;
+
+	if (!snd_interval_single(bits))
+		return 0;
+
+	event_bytes = (snd_interval_value(bits) / 8) *
+		      (prtd->params->fifo_level ?: 1);
+	if (prtd->ram_channel >= 0)
+		event_bytes <<= 1;
+	if (!event_bytes)
+		return 0;
+
+	memset(&t, 0, sizeof(t));
+	t.min = roundup(bytes->min + bytes->openmin, event_bytes);
+	t.max = rounddown(bytes->max - bytes->openmax, event_bytes);
+	t.integer = 1;
+	return snd_interval_refine(bytes, &t);
+}
+
 static int davinci_pcm_open(struct snd_pcm_substream *substream)
 {
 	struct snd_pcm_runtime *runtime = substream->runtime;
@@ -671,7 +959,8 @@ static int davinci_pcm_open(struct snd_pcm_substream *substream)
 
 	ppcm = (substream->stream == SNDRV_PCM_STREAM_PLAYBACK) ?
 			&pcm_hardware_playback : &pcm_hardware_capture;
-	allocate_sram(substream, params->sram_size, ppcm);
+	if (!low_latency)
+		allocate_sram(substream, params->sram_size, ppcm);
 	snd_soc_set_runtime_hwparams(substream, ppcm);
 	/* ensure that buffer size is a multiple of period size */
         ret = snd_pcm_hw_constraint_integer(runtime,
@@ -679,11 +968,24 @@ static int davinci_pcm_open(struct snd_pcm_substream *substream)
         if (ret < 0)
           return ret;
 
+	/* and, in low-latency mode, of the periods per DMA interrupt */
+	if (low_latency && irq_periods > 1) {
+		ret = snd_pcm_hw_constraint_step(runtime, 0,
+				SNDRV_PCM_HW_PARAM_PERIODS, irq_periods);
+		if (ret < 0)
+			return ret;
+	}
+
 	prtd = kzalloc(sizeof(struct davinci_runtime_data), GFP_KERNEL);
 	if (prtd == NULL)
 		return -ENOMEM;
 
 	spin_lock_init(&prtd->lock);
+	prtd->substream = substream;
+	prtd->lowlat = low_latency;
+	prtd->irq_periods = (low_latency && irq_periods > 1) ? irq_periods : 1;
+	hrtimer_init(&prtd->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	prtd->timer.function = davinci_pcm_lowlat_tick;
 	prtd->params = params;
 	prtd->asp_channel = -1;
 	prtd->asp_link[0] = prtd->asp_link[1] = -1;
@@ -691,15 +993,28 @@ static int davinci_pcm_open(struct snd_pcm_substream *substream)
 	prtd->ram_link = -1;
 	prtd->ram_link2 = -1;
 
+	ret = snd_pcm_hw_rule_add(runtime, 0, SNDRV_PCM_HW_PARAM_PERIOD_BYTES,
+				  davinci_pcm_rule_period_bytes, prtd,
+				  SNDRV_PCM_HW_PARAM_SAMPLE_BITS, -1);
+	if (ret < 0) {
+		kfree(prtd);
+		return ret;
+	}
+
 	runtime->private_data = prtd;
 
 	ret = davinci_pcm_dma_request(substream);
 	if (ret) {
 		printk(KERN_ERR "davinci_pcm: Failed to get dma channels\n");
 		kfree(prtd);
+		return ret;
 	}
 
-	return ret;
+	spin_lock_irq(&davinci_pcm_list_lock);
+	list_add_tail(&prtd->node, &davinci_pcm_list);
+	spin_unlock_irq(&davinci_pcm_list_lock);
+
+	return 0;
 }
 
 static int davinci_pcm_close(struct snd_pcm_substream *substream)
@@ -707,6 +1022,13 @@ static int davinci_pcm_close(struct snd_pcm_substream *substream)
 	struct snd_pcm_runtime *runtime = substream->runtime;
 	struct davinci_runtime_data *prtd = runtime->private_data;
 
+	spin_lock_irq(&davinci_pcm_list_lock);
+	list_del(&prtd->node);
+	spin_unlock_irq(&davinci_pcm_list_lock);
+
+	prtd->timer_running = 0;
+	hrtimer_cancel(&prtd->timer);
+
 	if (prtd->ram_channel >= 0)
 		edma_stop(prtd->ram_channel);
 	if (prtd->asp_channel >= 0)
@@ -739,12 +1061,48 @@ static int davinci_pcm_close(struct snd_pcm_substream *substream)
 static int davinci_pcm_hw_params(struct snd_pcm_substream *substream,
 				 struct snd_pcm_hw_params *hw_params)
 {
+	struct davinci_runtime_data *prtd = substream->runtime->private_data;
+	struct davinci_pcm_dma_params *params = prtd->params;
+	unsigned int event_bytes;
+
+	/*
+	 * The DAI has set up the words moved per DMA event; a period (half a
+	 * period with ping/pong) must be a whole number of events or the EDMA
+	 * counts would drift off the TDM frame.  davinci_pcm_rule_period_bytes
+	 * keeps other sizes out of refine; this catches DAIs that only set up
+	 * their event size in hw_params.
+	 */
+	event_bytes = params->data_type * (params->fifo_level ?: 1);
+	if (prtd->ram_channel >= 0)
+		event_bytes <<= 1;
+	if (event_bytes && params_period_bytes(hw_params) % event_bytes) {
+		printk(KERN_ERR "davinci_pcm: period of %u bytes is not a "
+			"multiple of %u\n", params_period_bytes(hw_params),
+			event_bytes);
+		return -EINVAL;
+	}
+
+	/* prefer a buffer the remote core can work on in place */
+	if (prtd->shm)
+		davinci_pcm_shm_free(substream);
+	else
+		snd_pcm_lib_free_pages(substream);
+	if (davinci_pcm_shm_alloc(substream,
+				  params_buffer_bytes(hw_params)) == 0)
+		return 1;
+
 	return snd_pcm_lib_malloc_pages(substream,
 					params_buffer_bytes(hw_params));
 }
 
 static int davinci_pcm_hw_free(struct snd_pcm_substream *substream)
 {
+	struct davinci_runtime_data *prtd = substream->runtime->private_data;
+
+	if (prtd->shm) {
+		davinci_pcm_shm_free(substream);
+		return 0;
+	}
 	return snd_pcm_lib_free_pages(substream);
 }
 
@@ -752,6 +1110,15 @@ static int davinci_pcm_mmap(struct snd_pcm_substream *substream,
 			    struct vm_area_struct *vma)
 {
 	struct snd_pcm_runtime *runtime = substream->runtime;
+	struct davinci_runtime_data *prtd = runtime->private_data;
+
+	if (prtd->shm) {
+		vma->vm_page_prot = pgprot_writecombine(vma->vm_page_prot);
+		return remap_pfn_range(vma, vma->vm_start,
+				       runtime->dma_addr >> PAGE_SHIFT,
+				       vma->vm_end - vma->vm_start,
+				       vma->vm_page_prot);
+	}
 
 	return dma_mmap_writecombine(substream->pcm->card->dev, vma,
 				     runtime->dma_area,
@@ -814,10 +1181,8 @@ static void davinci_pcm_free(struct snd_pcm *pcm)
 		buf->area = NULL;
 		iram_dma = buf->private_data;
 		if (iram_dma) {
-#if !defined(CONFIG_ARCH_TI81XX)	/* No SRAM support on TI81xx */
 			sram_free(iram_dma->area, iram_dma->bytes);
 			kfree(iram_dma);
-#endif
 		}
 	}
 }
@@ -870,6 +1235,120 @@ static int __devexit davinci_soc_platform_remove(struct platform_device *pdev)
 	return 0;
 }
 
+#ifdef CONFIG_DEBUG_FS
+/*
+ * Buffered delay of each open stream, in frames and microseconds: for
+ * playback what the application has queued ahead of the DMA, for capture
+ * what the DMA has filled that the application has not read yet.  For an
+ * application looping capture back to playback, the sum of the two on
+ * one PCM is the McASP in->out delay it adds.
+ */
+static long davinci_pcm_delay(struct snd_pcm_substream *substream)
+{
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	snd_pcm_sframes_t delay;
+
+	if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
+		delay = runtime->control->appl_ptr - runtime->status->hw_ptr;
+	else
+		delay = runtime->status->hw_ptr - runtime->control->appl_ptr;
+	if (delay < 0)
+		delay += runtime->boundary;
+	return delay;
+}
+
+static unsigned int davinci_pcm_frames_to_us(struct snd_pcm_runtime *runtime,
+					     long frames)
+{
+	if (!runtime->rate)
+		return 0;
+	return div_u64((u64)frames * USEC_PER_SEC, runtime->rate);
+}
+
+static int davinci_pcm_latency_show(struct seq_file *s, void *unused)
+{
+	struct davinci_runtime_data *prtd, *cap;
+	struct snd_pcm_substream *substream;
+	struct snd_pcm_runtime *runtime;
+	unsigned int us;
+	long delay;
+
+	spin_lock_irq(&davinci_pcm_list_lock);
+	list_for_each_entry(prtd, &davinci_pcm_list, node) {
+		substream = prtd->substream;
+		runtime = substream->runtime;
+		delay = davinci_pcm_delay(substream);
+		seq_printf(s, "pcmC%dD%d%c: %s period %lu frames, "
+			   "%u periods/irq, irqs %u, ticks %u, timer periods %u, "
+			   "delay %ld frames (%u us)\n",
+			   substream->pcm->card->number, substream->pcm->device,
+			   substream->stream == SNDRV_PCM_STREAM_PLAYBACK ?
+			   'p' : 'c', prtd->lowlat ? "low-latency" : "normal",
+			   runtime->period_size, prtd->irq_periods,
+			   prtd->dma_irqs, prtd->timer_ticks,
+			   prtd->timer_elapsed, delay,
+			   davinci_pcm_frames_to_us(runtime, delay));
+	}
+
+	list_for_each_entry(prtd, &davinci_pcm_list, node) {
+		substream = prtd->substream;
+		if (substream->stream != SNDRV_PCM_STREAM_PLAYBACK)
+			continue;
+		list_for_each_entry(cap, &davinci_pcm_list, node) {
+			if (cap->substream->pcm != substream->pcm ||
+			    cap->substream->stream != SNDRV_PCM_STREAM_CAPTURE)
+				continue;
+			us = davinci_pcm_frames_to_us(substream->runtime,
+					davinci_pcm_delay(substream)) +
+			     davinci_pcm_frames_to_us(cap->substream->runtime,
+					davinci_pcm_delay(cap->substream));
+			seq_printf(s, "pcmC%dD%d: in->out %u us\n",
+				   substream->pcm->card->number,
+				   substream->pcm->device, us);
+		}
+	}
+	spin_unlock_irq(&davinci_pcm_list_lock);
+
+	return 0;
+}
+
+static int davinci_pcm_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, davinci_pcm_latency_show, inode->i_private);
+}
+
+static const struct file_operations davinci_pcm_latency_fops = {
+	.open		= davinci_pcm_latency_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static struct dentry *davinci_pcm_debugfs;
+
+static void davinci_pcm_debugfs_init(void)
+{
+	davinci_pcm_debugfs = debugfs_create_dir("davinci-pcm", NULL);
+	if (IS_ERR_OR_NULL(davinci_pcm_debugfs))
+		return;
+	debugfs_create_file("latency", S_IRUGO, davinci_pcm_debugfs, NULL,
+			    &davinci_pcm_latency_fops);
+}
+
+static void davinci_pcm_debugfs_exit(void)
+{
+	debugfs_remove_recursive(davinci_pcm_debugfs);
+}
+#else
+static inline void davinci_pcm_debugfs_init(void)
+{
+}
+
+static inline void davinci_pcm_debugfs_exit(void)
+{
+}
+#endif
+
 static struct platform_driver davinci_pcm_driver = {
 	.driver = {
 			.name = "davinci-pcm-audio",
@@ -882,6 +1361,7 @@ static struct platform_driver davinci_pcm_driver = {
 
 static int __init snd_davinci_pcm_init(void)
 {
+	davinci_pcm_debugfs_init();
 	return platform_driver_register(&davinci_pcm_driver);
 }
 module_init(snd_davinci_pcm_init);
@@ -889,6 +1369,7 @@ module_init(snd_davinci_pcm_init);
 static void __exit snd_davinci_pcm_exit(void)
 {
 	platform_driver_unregister(&davinci_pcm_driver);
+	davinci_pcm_debugfs_exit();
 }
 module_exit(snd_davinci_pcm_exit);
 
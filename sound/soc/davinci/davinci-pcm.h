@@ -30,7 +30,7 @@ struct davinci_pcm_dma_params {
 	enum dma_event_q ram_chan_q;	/* event queue number for RAM channel */
 	unsigned char data_type;	/* xfer data type */
 	unsigned char convert_mono_stereo;
-	unsigned int fifo_level;
+	unsigned int fifo_level;	/* words per DMA event, 0 = one */
 };
 
 #endif
@@ -54,6 +54,17 @@
 #define CODEC_AUDIO_FORMAT (SND_SOC_DAIFMT_LEFT_J | SND_SOC_DAIFMT_NB_NF | SND_SOC_DAIFMT_CBM_CFM)
 #define CPU_AUDIO_FORMAT (SND_SOC_DAIFMT_I2S | SND_SOC_DAIFMT_NB_NF | SND_SOC_DAIFMT_CBM_CFM)
 
+/*
+ * Number of TDM slots on the codec serial port, 0 for plain I2S.  With 4
+ * or 8 slots all codec paths (RX audio, TX mic, sidetone, monitor) share
+ * one multichannel stream on each McASP.
+ */
+static int tdm_slots;
+module_param(tdm_slots, int, 0444);
+MODULE_PARM_DESC(tdm_slots, "codec TDM slots (0 = I2S, 4 or 8)");
+
+#define MICROBURST_SLOT_WIDTH	32
+
 static int microburst_hw_params(struct snd_pcm_substream *substream,
 			 struct snd_pcm_hw_params *params)
 {
@@ -100,10 +111,17 @@ static int microburst_hw_params(struct snd_pcm_substream *substream,
 	if (ret < 0)
 		return ret;
 
-	/* set TDM slot configuration */
-        //	ret = snd_soc_dai_set_tdm_slot(codec_dai, 0x03, 0x03, 2, 32);
-        // 		return ret;
-
+	/*
+	 * set TDM slot configuration; set_fmt above rewrites the codec
+	 * serial port, so this has to follow it.  The McASP side is set
+	 * up in evm_adau1761_init() so its channel count is known at open.
+	 */
+	if (tdm_slots) {
+		ret = snd_soc_dai_set_tdm_slot(codec_dai, 0x03, 0x03,
+				tdm_slots, MICROBURST_SLOT_WIDTH);
+		if (ret < 0)
+			return ret;
+	}
 
 	return 0;
 }
@@ -149,7 +167,17 @@ static int evm_adau1761_init(struct snd_soc_pcm_runtime *rtd)
 {
 	struct snd_soc_codec *codec = rtd->codec;
 	struct snd_soc_dapm_context *dapm = &codec->dapm;
+	unsigned int mask;
+	int ret;
 
+	/* McASP frame: every slot of the codec TDM frame is a channel */
+	if (tdm_slots) {
+		mask = (1 << tdm_slots) - 1;
+		ret = snd_soc_dai_set_tdm_slot(rtd->cpu_dai, mask, mask,
+				tdm_slots, MICROBURST_SLOT_WIDTH);
+		if (ret < 0)
+			return ret;
+	}
 
 	/* Add davinci-evm specific widgets */
 //	snd_soc_dapm_new_controls(dapm, microburst_dapm_widgets, ARRAY_SIZE(microburst_dapm_widgets));
@@ -117,6 +117,27 @@ typedef Void (*IMessageQTransport_ErrFxn) (IMessageQTransport_Reason reason,
                                            UArg                info);
 
 
+/*!
+ *  @brief  Control command putting several messages to the remote processor
+ *          with a single notification.  cmdArg points to an
+ *          #IMessageQTransport_Batch.  Either all messages are put or none
+ *          is.  Transports that do not support it return
+ *          MessageQ_E_INVALIDARG and the messages must be put one by one;
+ *          any other failure must be reported with a different status.
+ */
+#define IMessageQTransport_Cmd_PUTBATCH     (1u)
+
+/*!
+ *  @brief  Argument of #IMessageQTransport_Cmd_PUTBATCH
+ */
+typedef struct IMessageQTransport_Batch_tag {
+    Ptr *              msgs;
+    /*!< Messages to be put, in order */
+    UInt               count;
+    /*!< Number of messages */
+} IMessageQTransport_Batch;
+
+
 /* =============================================================================
  *  Function pointer types for heap operations
  * =============================================================================
@@ -198,6 +198,24 @@ extern "C" {
 #define CMD_MESSAGEQ_UNBLOCK                _IOWR(IPCCMDBASE,\
                                             MESSAGEQ_BASE_CMD + 19u,\
                                             MessageQDrv_CmdArgs)
+/*!
+ *  @brief  Command for MessageQ_putBatch
+ */
+#define CMD_MESSAGEQ_PUTBATCH               _IOWR(IPCCMDBASE,\
+                                            MESSAGEQ_BASE_CMD + 20u,\
+                                            MessageQDrv_CmdArgs)
+/*!
+ *  @brief  Command for MessageQ_getBatch
+ */
+#define CMD_MESSAGEQ_GETBATCH               _IOWR(IPCCMDBASE,\
+                                            MESSAGEQ_BASE_CMD + 21u,\
+                                            MessageQDrv_CmdArgs)
+/*!
+ *  @brief  Command for MessageQ_getStats
+ */
+#define CMD_MESSAGEQ_GETSTATS               _IOWR(IPCCMDBASE,\
+                                            MESSAGEQ_BASE_CMD + 22u,\
+                                            MessageQDrv_CmdArgs)
 
 /*  ----------------------------------------------------------------------------
  *  Command arguments for MessageQ
@@ -227,6 +245,7 @@ typedef struct MessageQDrv_CmdArgs_Tag {
             MessageQ_Params     * params;
             UInt32                nameLen;
             MessageQ_QueueId      queueId;
+            UInt32                rxRing;
         } create;
 
         struct {
@@ -295,6 +314,25 @@ typedef struct MessageQDrv_CmdArgs_Tag {
         struct {
             Ptr                   handle;
         } unblock;
+
+        struct {
+            MessageQ_QueueId      queueId;
+            SharedRegion_SRPtr  * msgSrPtrs;
+            UInt                  count;
+            UInt                  numPut;
+        } putBatch;
+
+        struct {
+            Ptr                   handle;
+            UInt                  timeout;
+            SharedRegion_SRPtr  * msgSrPtrs;
+            UInt                  max;
+            UInt                  numGot;
+        } getBatch;
+
+        struct {
+            MessageQ_Stats      * stats;
+        } getStats;
     } args;
 
     Int32 apiStatus;
@@ -106,6 +106,10 @@ typedef struct NotifyDriverShm_Params_tag {
     /*!< Local interrupt ID for interrupt line for incoming interrupts */
     UInt32    remoteIntId;
     /*!< Remote interrupt ID for interrupt line for outgoing interrupts */
+    Bool      holdBack;
+    /*!< Whether a send with waitClear holds its payload back instead of
+     *   waiting while the previous event is still pending
+     */
 } NotifyDriverShm_Params;
 
 
@@ -238,6 +238,70 @@ typedef struct NotifyDrv_EventPacket_tag {
     /*!< Indicates whether this is an exit packet */
 } NotifyDrv_EventPacket ;
 
+/*!
+ *  @brief  Page offset at which a process maps its event ring through the
+ *          Notify driver.  It lies above 4 GB, out of the range of the
+ *          physical memory the driver otherwise maps.
+ */
+#define NotifyDrv_EVENTRING_PGOFF     0x100000u
+
+/*!
+ *  @brief  Number of packets in an event ring, sized so that a
+ *          #NotifyDrv_EventRing fills exactly one 4 KB page.
+ */
+#define NotifyDrv_EVENTRING_SLOTS     204u
+
+/*!
+ *  @brief  Orders event ring slot accesses against index updates.
+ */
+#if defined (__KERNEL__)
+#define NotifyDrv_ringBarrier()       smp_mb ()
+#else
+#define NotifyDrv_ringBarrier()       __sync_synchronize ()
+#endif
+
+/*!
+ *  @brief  Structure of an event packet delivered through the event ring.
+ */
+typedef struct NotifyDrv_RingPacket_tag {
+    UInt16              procId;
+    /*!< Processor identifier */
+    UInt16              lineId;
+    /*!< Line identifier */
+    UInt32              eventId;
+    /*!< Event number used for the registration */
+    UInt32              data;
+    /*!< Data associated with event. */
+    Notify_FnNotifyCbck func;
+    /*!< User callback function. */
+    Ptr                 param;
+    /*!< User callback argument. */
+} NotifyDrv_RingPacket;
+
+/*!
+ *  @brief  Per-process event ring, a page of kernel memory the process maps
+ *          at #NotifyDrv_EVENTRING_PGOFF.
+ *
+ *  Events are appended to the ring while no packet is waiting on the
+ *  process's kernel list, and the process takes all of them with no system
+ *  call.  When the ring is full, and for the exit packet, packets are
+ *  queued on the list as before and read with read(); @c listPut and
+ *  @c listGot tell the process when that is needed.  The driver file
+ *  becomes readable in poll() whenever either holds a packet.
+ */
+typedef struct NotifyDrv_EventRing_tag {
+    volatile UInt32      head;
+    /*!< Free running index of the next packet to be read */
+    volatile UInt32      tail;
+    /*!< Free running index of the next packet to be written */
+    volatile UInt32      listPut;
+    /*!< Number of packets queued on the list instead of the ring */
+    volatile UInt32      listGot;
+    /*!< Number of packets read off the list */
+    NotifyDrv_RingPacket slot [NotifyDrv_EVENTRING_SLOTS];
+    /*!< Event packets */
+} NotifyDrv_EventRing;
+
 /*  ----------------------------------------------------------------------------
  *  Command arguments for Notify
  *  ----------------------------------------------------------------------------
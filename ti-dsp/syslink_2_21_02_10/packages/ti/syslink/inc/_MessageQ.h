@@ -96,6 +96,65 @@ extern "C" {
 #define MessageQ_TRACESHIFT      (UInt) 12
 
 
+/*!
+ *  @brief  Number of message slots in a queue's receive ring.
+ *
+ *  Sized so that a #MessageQ_RxRing fills exactly one 4 KB page.
+ */
+#define MessageQ_RXRING_SLOTS    1020u
+
+/*!
+ *  @brief  Orders receive ring slot accesses against index updates.
+ */
+#if defined (__KERNEL__)
+#define MessageQ_rxRingBarrier() smp_mb ()
+#else
+#define MessageQ_rxRingBarrier() __sync_synchronize ()
+#endif
+
+/*!
+ *  @brief  Receive ring of a message queue created from user-space.
+ *
+ *  The ring is a page of kernel memory which the process owning the
+ *  queue maps next to its SharedRegions.  The kernel-side MessageQ_put
+ *  appends normal priority messages to it for as long as no message is
+ *  held in the queue's lists, so that the reader can take them with no
+ *  system call; it only enters the kernel to block, or when the lists
+ *  hold messages that must come first.  Every field is written by one
+ *  side only: @c tail and @c listPut by the writer, @c head and
+ *  @c listGot by the reader.
+ */
+typedef struct MessageQ_RxRing_tag {
+    volatile UInt32 head;
+    /*!< Free running index of the next slot to be read */
+    volatile UInt32 tail;
+    /*!< Free running index of the next slot to be written */
+    volatile UInt32 listPut;
+    /*!< Number of messages put on the queue's lists instead of the ring */
+    volatile UInt32 listGot;
+    /*!< Number of messages taken off the queue's lists */
+    volatile UInt32 slot [MessageQ_RXRING_SLOTS];
+    /*!< SharedRegion_SRPtr of each queued message */
+} MessageQ_RxRing;
+
+/*!
+ *  @brief  Largest number of messages moved by one batch call from
+ *          user-space.
+ */
+#define MessageQ_BATCH_MAX       64u
+
+/*!
+ *  @brief  Counters of the messages sent to remote processors.
+ *
+ *  They are updated under the system gate and are meant for tuning only.
+ */
+typedef struct MessageQ_Stats_tag {
+    UInt32 msgsSent;
+    /*!< Messages handed to a transport */
+    UInt32 doorbells;
+    /*!< Notifications the transports sent to remote processors for them */
+} MessageQ_Stats;
+
 /*!
  *  @brief  Structure defining config parameters for the MessageQ Buf module.
  */
@@ -201,6 +260,37 @@ Void  MessageQ_unregisterTransport (UInt16 procId, UInt priority);
 
 Void MessageQ_setState(MessageQ_Handle handle, Int state);
 
+/*
+ *  User-space fast path support
+ */
+/* Attach a receive ring to a queue; must be called before it is used. */
+Void MessageQ_setRxRing (MessageQ_Handle handle, MessageQ_RxRing * ring);
+
+/* Returns the receive ring of a local queue, or NULL. */
+MessageQ_RxRing * MessageQ_getRxRing (UInt16 queueIndex);
+
+/*
+ *  Batch support
+ */
+/* Place messages onto a queue, raising one notification where possible. */
+Int MessageQ_putBatch (MessageQ_QueueId   queueId,
+                       MessageQ_Msg     * msgs,
+                       UInt               count,
+                       UInt             * numPut);
+
+/* Get up to max messages, waiting up to timeout for the first one only. */
+Int MessageQ_getBatch (MessageQ_Handle    handle,
+                       MessageQ_Msg     * msgs,
+                       UInt               max,
+                       UInt               timeout,
+                       UInt             * numGot);
+
+/* Returns the remote send counters. */
+Void MessageQ_getStats (MessageQ_Stats * stats);
+
+/* Counts a notification sent to a remote processor, called by transports. */
+Void MessageQ_countDoorbell (Void);
+
 #if defined (__cplusplus)
 }
 #endif /* defined (__cplusplus) */
@@ -94,6 +94,44 @@ typedef struct NotifyDriverShm_ProcCtrl_tag {
     /*!< Event Enabled mask */
 } NotifyDriverShm_ProcCtrl ;
 
+/*!
+ *  @brief  Number of payloads a driver instance holds back while the remote
+ *          processor has not yet taken the previous instance of their event.
+ */
+#define NotifyDriverShm_PENDING_SLOTS   32u
+
+/*!
+ *  @brief  Number of polls of a busy event entry before a sender that
+ *          cannot queue starts sleeping between polls.
+ */
+#define NotifyDriverShm_SPIN_COUNT      1000u
+
+/*!
+ *  @brief  Number of polls, one millisecond apart, that deleting an
+ *          instance waits for its held back payloads to be sent.
+ */
+#define NotifyDriverShm_DRAIN_POLLS     100u
+
+/*!
+ *  @brief  Counters of a driver instance, see NotifyDriverShm_getStats.
+ */
+typedef struct NotifyDriverShm_Stats_tag {
+    UInt32 sent;
+    /*!< Events raised on the remote processor */
+    UInt32 queued;
+    /*!< Payloads queued because their event was still pending */
+    UInt32 maxQueued;
+    /*!< Highest number of payloads queued at once */
+    UInt32 waits;
+    /*!< Sends that found the queue full and had to wait */
+    UInt32 spins;
+    /*!< Polls spent by those sends */
+    UInt32 sleeps;
+    /*!< Sleeps of at least one millisecond spent by those sends */
+    UInt32 maxSleeps;
+    /*!< Most sleeps spent by one of those sends */
+} NotifyDriverShm_Stats;
+
 
 /* =============================================================================
  *  APIs
@@ -130,6 +168,11 @@ Void  NotifyDriverShm_enableEvent (NotifyDriverShm_Handle handle,
 Void  NotifyDriverShm_setNotifyHandle (NotifyDriverShm_Handle handle,
                                        Ptr                 driverHanlde);
 
+/* Function to get the counters of the driver for a processor and line. */
+Int NotifyDriverShm_getStats (UInt16                  procId,
+                              UInt16                  lineId,
+                              NotifyDriverShm_Stats * stats);
+
 
 #if defined (__cplusplus)
 }
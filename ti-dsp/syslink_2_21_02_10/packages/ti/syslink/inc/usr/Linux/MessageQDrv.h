@@ -81,6 +81,12 @@ Int MessageQDrv_close (Void);
 /* Function to invoke the APIs through ioctl. */
 Int MessageQDrv_ioctl (UInt32 cmd, Ptr args);
 
+/* Function to map the receive ring of a local queue. */
+Ptr MessageQDrv_map (UInt16 queueIndex, UInt32 size);
+
+/* Function to unmap a receive ring. */
+Void MessageQDrv_unmap (Ptr addr, UInt32 size);
+
 
 #if defined (__cplusplus)
 }
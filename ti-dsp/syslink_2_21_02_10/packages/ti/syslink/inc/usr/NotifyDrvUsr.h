@@ -81,6 +81,12 @@ Int NotifyDrvUsr_close (Bool deleteThread);
 /* Function to invoke the APIs through ioctl. */
 Int NotifyDrvUsr_ioctl (UInt32 cmd, Ptr args);
 
+/* Function to get the descriptor to poll for events of this process. */
+Int NotifyDrvUsr_getFd (Void);
+
+/* Function to run the callbacks of all pending events of this process. */
+Int NotifyDrvUsr_dispatchEvents (Void);
+
 
 #if defined (__cplusplus)
 }
@@ -75,6 +75,7 @@
 #include <ti/syslink/inc/Bitops.h>
 #include <ti/syslink/inc/knl/NotifySetupProxy.h>
 #include <ti/syslink/inc/knl/TransportSetupProxy.h>
+#include <ti/syslink/inc/knl/PcmShm.h>
 
 /*  ----------------------------------- SysLink utils Headers   */
 #include <ti/syslink/utils/Gate.h>
@@ -560,6 +561,9 @@ Int Ipc_attach (UInt16 remoteProcId)
                 key = Gate_enterSystem ();
                 ipc->isAttached++;
                 Gate_leaveSystem (key);
+
+                /* Offer the audio buffers once the heaps are usable */
+                PcmShm_attach (remoteProcId);
             }
         }
     }
@@ -654,6 +658,11 @@ Int Ipc_detach (UInt16 remoteProcId)
                 }
             }
 
+            /* the PCM streams must let go of their shared buffers first */
+            if (status >= 0) {
+                status = PcmShm_detach (remoteProcId);
+            }
+
             if (status >= 0) {
                 if (   ipc->entry.setupMessageQ
                     && MessageQ_SetupTransportProxy_isRegistered (remoteProcId)) {
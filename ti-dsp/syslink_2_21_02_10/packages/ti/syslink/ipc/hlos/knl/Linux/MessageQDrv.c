@@ -66,6 +66,7 @@
 #include <asm/uaccess.h>
 #include <linux/pid.h>
 #include <linux/sched.h>
+#include <linux/mutex.h>
 
 /* Standard headers */
 #include <ti/syslink/Std.h>
@@ -114,6 +115,12 @@ EXPORT_SYMBOL(MessageQ_registerTransport);
 EXPORT_SYMBOL(MessageQ_unregisterTransport);
 EXPORT_SYMBOL(MessageQ_setReplyQueue);
 EXPORT_SYMBOL(MessageQ_getQueueId);
+EXPORT_SYMBOL(MessageQ_setRxRing);
+EXPORT_SYMBOL(MessageQ_getRxRing);
+EXPORT_SYMBOL(MessageQ_putBatch);
+EXPORT_SYMBOL(MessageQ_getBatch);
+EXPORT_SYMBOL(MessageQ_getStats);
+EXPORT_SYMBOL(MessageQ_countDoorbell);
 
 /* MessageQDrv functions */
 EXPORT_SYMBOL(MessageQDrv_registerDriver);
@@ -136,10 +143,12 @@ extern "C" {
 
 typedef struct {
     ResTrack_Handle     resTrack;
+    struct mutex        ringLock;   /* queue delete and untrack vs mmap */
 } MessageQDrv_ModuleObject;
 
 typedef struct {
     Ptr         handle;
+    UInt16      queueIndex;
 } MessageQDrv_CreateRes;
 
 typedef struct {
@@ -172,11 +181,18 @@ static long MessageQDrv_ioctl (struct file *  filp,
                                unsigned int   cmd,
                                unsigned long  args);
 
+/*!
+ *  @brief  Linux driver function to map a queue's receive ring.
+ */
+static int MessageQDrv_mmap (struct file * filp, struct vm_area_struct * vma);
+
 static Void MessageQDrv_setup(Void);
 static Void MessageQDrv_destroy(Void);
 static Void MessageQDrv_releaseResources(Osal_Pid pid);
 static Bool MessageQDrv_resCmpFxn(Void *ptrA, Void *ptrB);
+static Bool MessageQDrv_resIndexCmpFxn(Void *ptrA, Void *ptrB);
 static Int  MessageQDrv_cmd_delete(MessageQ_Handle *handlePtr);
+static UInt32 MessageQDrv_attachRxRing(MessageQ_Handle handle);
 
 #if defined (SYSLINK_MULTIPLE_MODULES)
 /*!
@@ -207,6 +223,7 @@ static struct file_operations MessageQDrv_driverOps = {
     open:    MessageQDrv_open,
     release: MessageQDrv_close,
     unlocked_ioctl:   MessageQDrv_ioctl,
+    mmap:    MessageQDrv_mmap,
 } ;
 
 
@@ -329,6 +346,52 @@ static int MessageQDrv_close(struct inode *inode, struct file *filp)
     return(0);
 }
 
+/*
+ *  ======== MessageQDrv_mmap ========
+ *  Maps the receive ring of the queue whose index is given as the page
+ *  offset; only the process that created the queue may map it.  The
+ *  mapping holds a reference on the page, so it stays valid even if the
+ *  queue is deleted before it is unmapped.
+ */
+static int MessageQDrv_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+    MessageQDrv_Resource res;
+    MessageQ_RxRing *ring;
+    struct page *page = NULL;
+    Osal_Pid pid;
+    int ret;
+
+    if ((vma->vm_end - vma->vm_start) != PAGE_SIZE) {
+        return -EINVAL;
+    }
+
+    pid = pid_nr(filp->f_owner.pid);
+    res.cmd = CMD_MESSAGEQ_CREATE;
+    res.args.create.queueIndex = (UInt16)vma->vm_pgoff;
+
+    /* a queue still tracked under the lock is alive and not yet freed */
+    mutex_lock(&MessageQDrv_state.ringLock);
+    if (ResTrack_find(MessageQDrv_state.resTrack, pid, (List_Elem *)&res,
+            MessageQDrv_resIndexCmpFxn) == ResTrack_S_SUCCESS) {
+        ring = MessageQ_getRxRing((UInt16)vma->vm_pgoff);
+        if (ring != NULL) {
+            page = virt_to_page(ring);
+            get_page(page);
+        }
+    }
+    mutex_unlock(&MessageQDrv_state.ringLock);
+
+    if (page == NULL) {
+        return -ENXIO;
+    }
+
+    /* vm_insert_page takes its own reference for the mapping */
+    ret = vm_insert_page(vma, vma->vm_start, page);
+    put_page(page);
+
+    return ret;
+}
+
 /*
  *  ======== MessageQDrv_ioctl ========
  *
@@ -385,6 +448,106 @@ static long MessageQDrv_ioctl(struct file *filp, unsigned int cmd,
         }
         break;
 
+        case CMD_MESSAGEQ_PUTBATCH:
+        {
+            MessageQ_Msg        msgs [MessageQ_BATCH_MAX];
+            SharedRegion_SRPtr  msgSrPtrs [MessageQ_BATCH_MAX];
+            UInt                count = cargs.args.putBatch.count;
+            UInt                i;
+
+            cargs.args.putBatch.numPut = 0u;
+
+            if ((count == 0u) || (count > MessageQ_BATCH_MAX)) {
+                status = MessageQ_E_INVALIDARG;
+            }
+            else if (copy_from_user (msgSrPtrs,
+                                     cargs.args.putBatch.msgSrPtrs,
+                                     count * sizeof (SharedRegion_SRPtr))) {
+                status = MessageQ_E_OSFAILURE;
+                osStatus = -EFAULT;
+            }
+            else {
+                /* reject the whole batch if any pointer is bad */
+                for (i = 0u; i < count; i++) {
+                    msgs [i] = SharedRegion_getPtr (msgSrPtrs [i]);
+                    if (msgs [i] == NULL) {
+                        status = MessageQ_E_INVALIDMSG;
+                        GT_setFailureReason (curTrace,
+                                             GT_4CLASS,
+                                             "MessageQDrv_ioctl",
+                                             status,
+                                             "invalid SRPtr in batch");
+                        break;
+                    }
+                }
+                if (status >= 0) {
+                    status = MessageQ_putBatch (cargs.args.putBatch.queueId,
+                                                msgs,
+                                                count,
+                                                &cargs.args.putBatch.numPut);
+                }
+            }
+        }
+        break;
+
+        case CMD_MESSAGEQ_GETBATCH:
+        {
+            MessageQ_Msg        msgs [MessageQ_BATCH_MAX];
+            SharedRegion_SRPtr  msgSrPtrs [MessageQ_BATCH_MAX];
+            UInt                max = cargs.args.getBatch.max;
+            UInt                numGot = 0u;
+            UInt                i;
+            UInt16              index;
+
+            if ((max == 0u) || (max > MessageQ_BATCH_MAX)) {
+                status = MessageQ_E_INVALIDARG;
+            }
+            else {
+                status = MessageQ_getBatch (cargs.args.getBatch.handle,
+                                            msgs,
+                                            max,
+                                            cargs.args.getBatch.timeout,
+                                            &numGot);
+                if (status == -ERESTARTSYS) {
+                    osStatus = status;
+                }
+            }
+
+            for (i = 0u; i < numGot; i++) {
+                index = SharedRegion_getId (msgs [i]);
+                msgSrPtrs [i] = SharedRegion_getSRPtr (msgs [i], index);
+            }
+
+            if (   (numGot > 0u)
+                && copy_to_user (cargs.args.getBatch.msgSrPtrs,
+                                 msgSrPtrs,
+                                 numGot * sizeof (SharedRegion_SRPtr))) {
+                /* The messages cannot be handed over, give them back. */
+                for (i = 0u; i < numGot; i++) {
+                    MessageQ_free (msgs [i]);
+                }
+                numGot = 0u;
+                status = MessageQ_E_OSFAILURE;
+                osStatus = -EFAULT;
+            }
+
+            cargs.args.getBatch.numGot = numGot;
+        }
+        break;
+
+        case CMD_MESSAGEQ_GETSTATS:
+        {
+            MessageQ_Stats stats;
+
+            MessageQ_getStats (&stats);
+
+            ret = copy_to_user (cargs.args.getStats.stats,
+                                &stats,
+                                sizeof (MessageQ_Stats));
+            GT_assert (curTrace, (ret == 0));
+        }
+        break;
+
         case CMD_MESSAGEQ_COUNT:
         {
             cargs.args.count.count = MessageQ_count (cargs.args.count.handle);
@@ -515,6 +678,8 @@ static long MessageQDrv_ioctl(struct file *filp, unsigned int cmd,
 
                 res->cmd = cmd;
                 res->args.create.handle = cargs.args.create.handle;
+                res->args.create.queueIndex = (UInt16)MessageQ_getQueueId(
+                        cargs.args.create.handle);
 
                 rstat = ResTrack_push(MessageQDrv_state.resTrack, pid,
                         (List_Elem *)res);
@@ -530,6 +695,13 @@ static long MessageQDrv_ioctl(struct file *filp, unsigned int cmd,
                 }
             }
 
+            /* let the process receive without entering the kernel */
+            cargs.args.create.rxRing = 0;
+            if (status == MessageQ_S_SUCCESS) {
+                cargs.args.create.rxRing = MessageQDrv_attachRxRing(
+                        cargs.args.create.handle);
+            }
+
             /* don't need the name anymore */
             if (name != NULL) {
                 Memory_free(NULL, name, cargs.args.create.nameLen);
@@ -553,14 +725,19 @@ static long MessageQDrv_ioctl(struct file *filp, unsigned int cmd,
             res.args.create.handle = cargs.args.deleteMessageQ.handle;
 
             /* common code for delete command */
+            mutex_lock(&MessageQDrv_state.ringLock);
             status = MessageQDrv_cmd_delete((MessageQ_Handle *)
                     &cargs.args.deleteMessageQ.handle);
 
             /* untrack the resource */
+            elem = NULL;
             if (status == MessageQ_S_SUCCESS) {
                 ResTrack_remove(MessageQDrv_state.resTrack, pid,
                         (List_Elem *)(&res), MessageQDrv_resCmpFxn, &elem);
+            }
+            mutex_unlock(&MessageQDrv_state.ringLock);
 
+            if (status == MessageQ_S_SUCCESS) {
                 GT_assert(curTrace, (elem != NULL));
                 Memory_free(NULL, elem, sizeof(MessageQDrv_Resource));
             }
@@ -760,6 +937,8 @@ static long MessageQDrv_ioctl(struct file *filp, unsigned int cmd,
  */
 static Void MessageQDrv_setup(Void)
 {
+    mutex_init(&MessageQDrv_state.ringLock);
+
     /* create a resource tracker instance */
     MessageQDrv_state.resTrack = ResTrack_create(NULL);
 
@@ -816,8 +995,10 @@ static Void MessageQDrv_releaseResources(Osal_Pid pid)
             case CMD_MESSAGEQ_CREATE:
                 MessageQ_setState((MessageQ_Handle)(res->args.create.handle),
                         MessageQ_State_TERMINATED);
+                mutex_lock(&MessageQDrv_state.ringLock);
                 MessageQDrv_cmd_delete((MessageQ_Handle *)
                         &(res->args.create.handle));
+                mutex_unlock(&MessageQDrv_state.ringLock);
                 break;
 
             default:
@@ -871,12 +1052,33 @@ leave:
     return(found);
 }
 
+/*
+ *  ======== MessageQDrv_resIndexCmpFxn ========
+ *  Matches the queue created with the reference's queue index.
+ */
+static Bool MessageQDrv_resIndexCmpFxn(Void *ptrA, Void *ptrB)
+{
+    MessageQDrv_Resource *resA;
+    MessageQDrv_Resource *resB;
+
+    resA = (MessageQDrv_Resource *)ptrA;
+    resB = (MessageQDrv_Resource *)ptrB;
+
+    return((resB->cmd == CMD_MESSAGEQ_CREATE)
+            && (resA->args.create.queueIndex == resB->args.create.queueIndex));
+}
+
 /*
  *  ======== MessageQDrv_cmd_delete ========
+ *  Called with ringLock held, so that the ring is not mapped while it
+ *  is being freed.
  */
 static Int MessageQDrv_cmd_delete(MessageQ_Handle *handlePtr)
 {
     Int status;
+    MessageQ_RxRing *ring;
+
+    ring = MessageQ_getRxRing((UInt16)MessageQ_getQueueId(*handlePtr));
 
     /* invoke the module api */
     status = MessageQ_delete(handlePtr);
@@ -886,10 +1088,37 @@ static Int MessageQDrv_cmd_delete(MessageQ_Handle *handlePtr)
         GT_setFailureReason(curTrace, GT_4CLASS, "MessageQDrv_ioctl",
                 status, "MessageQ_delete failed");
     }
+    else if (ring != NULL) {
+        /* user mappings keep their own reference on the page */
+        __free_page(virt_to_page(ring));
+    }
 
     return(status);
 }
 
+/*
+ *  ======== MessageQDrv_attachRxRing ========
+ *  Gives a queue created for user-space a receive ring, see
+ *  MessageQ_RxRing.  Without one the queue works as before.
+ */
+static UInt32 MessageQDrv_attachRxRing(MessageQ_Handle handle)
+{
+    struct page *page;
+
+    BUILD_BUG_ON(sizeof(MessageQ_RxRing) > PAGE_SIZE);
+
+    page = alloc_page(GFP_KERNEL | __GFP_ZERO);
+    if (page == NULL) {
+        GT_setFailureReason(curTrace, GT_4CLASS, "MessageQDrv_attachRxRing",
+                MessageQ_E_MEMORY, "out of memory, no receive ring");
+        return(0);
+    }
+
+    MessageQ_setRxRing(handle, (MessageQ_RxRing *)page_address(page));
+
+    return(1);
+}
+
 
 /** ============================================================================
  *  Functions required for multiple .ko modules configuration
@@ -82,6 +82,8 @@
 #include <asm/uaccess.h>
 #include <asm/pgtable.h>
 #include <linux/pid.h>
+#include <linux/poll.h>
+#include <linux/wait.h>
 
 /* Module headers */
 #include <ti/ipc/Notify.h>
@@ -176,6 +178,12 @@ typedef struct NotifyDrv_EventState_tag {
     /*!< Semphore for waiting on event. */
     OsalSemaphore_Handle   terSemHandle;
     /*!< Termination synchronization semaphore. */
+    NotifyDrv_EventRing *  ring;
+    /*!< Event ring in use, set once the process has mapped ringMem. */
+    NotifyDrv_EventRing *  ringMem;
+    /*!< Page allocated for the event ring, NULL if none. */
+    wait_queue_head_t      readQueue;
+    /*!< Woken whenever a packet is queued, for poll. */
 } NotifyDrv_EventState;
 
 /*!
@@ -248,6 +256,9 @@ static int NotifyDrv_read (struct file *  filp,
 /* Linux driver function to map memory regions to user space. */
 static int NotifyDrv_mmap (struct file * filp, struct vm_area_struct * vma);
 
+/* Linux driver function to wait for events along with other files. */
+static unsigned int NotifyDrv_poll (struct file * filp, poll_table * wait);
+
 /* Linux driver function to invoke the APIs through ioctl. */
 static long NotifyDrv_ioctl (struct file *     filp,
                              unsigned int      cmd,
@@ -311,6 +322,7 @@ static struct file_operations NotifyDrv_driverOps = {
     release:  NotifyDrv_close,
     read:     NotifyDrv_read,
     mmap:     NotifyDrv_mmap,
+    poll:     NotifyDrv_poll,
 } ;
 
 #if defined (SYSLINK_MULTIPLE_MODULES)
@@ -373,6 +385,9 @@ static Int _NotifyDrv_addBufByPid (UInt16             procId,
                                    Notify_FnNotifyCbck cbFxn,
                                    Ptr                param);
 
+/* Returns the event state index of the process owning a file. */
+static UInt32 _NotifyDrv_findByFile (struct file * filp);
+
 /* Module setup function. */
 static Void _NotifyDrv_setup (Void);
 
@@ -549,6 +564,10 @@ NotifyDrv_read (struct file * filp, char * dst, size_t size, loff_t *offset)
                               List_get (NotifyDrv_state.eventState [i].bufList);
                     /*  Let the check remain at run-time. */
                     if (uBuf != NULL) {
+                        if (NotifyDrv_state.eventState [i].ring != NULL) {
+                            NotifyDrv_state.eventState [i].ring->listGot++;
+                        }
+
                         retVal = copy_to_user ((Ptr) dst,
                                                uBuf,
                                                sizeof (NotifyDrv_EventPacket));
@@ -626,6 +645,50 @@ static
 int
 NotifyDrv_mmap (struct file * filp, struct vm_area_struct * vma)
 {
+    NotifyDrv_EventRing * ring = NULL;
+    List_Elem *           elem = NULL;
+    IArg                  key;
+    UInt32                i;
+
+    /* The event ring of the calling process */
+    if (vma->vm_pgoff == NotifyDrv_EVENTRING_PGOFF) {
+        if ((vma->vm_end - vma->vm_start) != PAGE_SIZE) {
+            return -EINVAL;
+        }
+
+        key = IGateProvider_enter (NotifyDrv_state.gateHandle);
+        i = _NotifyDrv_findByFile (filp);
+        /* Only the attached process itself, not a forked child. */
+        if (   (i < MAX_PROCESSES)
+            && (NotifyDrv_state.eventState [i].pid
+                                    == (UInt32) task_tgid_nr (current))) {
+            ring = NotifyDrv_state.eventState [i].ringMem;
+        }
+        if (ring != NULL) {
+            /* The mapping keeps its own reference on the page. */
+            if (vm_insert_page (vma, vma->vm_start, virt_to_page (ring))) {
+                ring = NULL;
+            }
+            else if (NotifyDrv_state.eventState [i].ring == NULL) {
+                /* Events are put on the ring from now on, behind the
+                 * packets already on the list.
+                 */
+                ring->listGot = 0u;
+                ring->listPut = 0u;
+                while ((elem = List_next (
+                                  NotifyDrv_state.eventState [i].bufList,
+                                  elem)) != NULL) {
+                    ring->listPut++;
+                }
+                NotifyDrv_ringBarrier ();
+                NotifyDrv_state.eventState [i].ring = ring;
+            }
+        }
+        IGateProvider_leave (NotifyDrv_state.gateHandle, key);
+
+        return (ring != NULL) ? 0 : -ENXIO;
+    }
+
 #ifdef CONFIG_MMU
     vma->vm_page_prot = pgprot_noncached (vma->vm_page_prot);
 #endif
@@ -641,6 +704,52 @@ NotifyDrv_mmap (struct file * filp, struct vm_area_struct * vma)
 }
 
 
+/*!
+ *  @brief  Linux driver function to wait for events along with other files.
+ *
+ *          The file is readable while the calling process has packets on its
+ *          event ring or on its list, and reports an error once the process
+ *          is no longer attached.
+ *
+ *  @param  filp    File structure pointer.
+ *  @param  wait    Poll table of the caller.
+ *
+ *  @sa     NotifyDrv_read
+ */
+static
+unsigned int
+NotifyDrv_poll (struct file * filp, poll_table * wait)
+{
+    unsigned int          mask = 0;
+    NotifyDrv_EventRing * ring;
+    IArg                  key;
+    UInt32                i;
+
+    key = IGateProvider_enter (NotifyDrv_state.gateHandle);
+    i = _NotifyDrv_findByFile (filp);
+    if (i < MAX_PROCESSES) {
+        poll_wait (filp, &NotifyDrv_state.eventState [i].readQueue, wait);
+
+        ring = NotifyDrv_state.eventState [i].ring;
+        if (ring != NULL) {
+            if (   (ring->head != ring->tail)
+                || (ring->listPut != ring->listGot)) {
+                mask = POLLIN | POLLRDNORM;
+            }
+        }
+        else if (List_empty (NotifyDrv_state.eventState [i].bufList) == FALSE) {
+            mask = POLLIN | POLLRDNORM;
+        }
+    }
+    else {
+        mask = POLLERR;
+    }
+    IGateProvider_leave (NotifyDrv_state.gateHandle, key);
+
+    return mask;
+}
+
+
 /*!
  *  @brief      Linux driver function to invoke the APIs through ioctl.
  *
@@ -1632,7 +1741,10 @@ _NotifyDrv_addBufByPid (UInt16             procId,
     Int32                   status = 0;
     Bool                    flag   = FALSE;
     Bool                    isExit = FALSE;
+    Bool                    ringed = FALSE;
     NotifyDrv_EventPacket * uBuf   = NULL;
+    NotifyDrv_EventRing *   ring   = NULL;
+    NotifyDrv_RingPacket *  slot;
     IArg                    key;
     UInt32                  i;
 
@@ -1667,8 +1779,38 @@ _NotifyDrv_addBufByPid (UInt16             procId,
                 break;
             }
         }
+
+        /* Append the event to the process's ring unless packets queued on
+         * its list must be read first.  The exit packet always goes through
+         * the list, so that it is acknowledged from read().
+         */
+        if ((flag == TRUE) && (eventId != (UInt32) -1)) {
+            ring = NotifyDrv_state.eventState [i].ring;
+            if (   (ring != NULL)
+                && (ring->listPut == ring->listGot)
+                && ((ring->tail - ring->head) < NotifyDrv_EVENTRING_SLOTS)) {
+                slot = &ring->slot [ring->tail % NotifyDrv_EVENTRING_SLOTS];
+                slot->procId  = procId;
+                slot->lineId  = lineId;
+                slot->eventId = eventId;
+                slot->data    = data;
+                slot->func    = cbFxn;
+                slot->param   = param;
+                NotifyDrv_ringBarrier ();
+                ring->tail++;
+                ringed = TRUE;
+
+                wake_up_interruptible (
+                                &NotifyDrv_state.eventState [i].readQueue);
+            }
+        }
         IGateProvider_leave (NotifyDrv_state.gateHandle, key);
 
+        if (ringed == TRUE) {
+            GT_1trace (curTrace, GT_LEAVE, "_NotifyDrv_addBufByPid", status);
+            return status;
+        }
+
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (flag != TRUE) {
             /*! @retval Notify_E_NOTFOUND Could not find a registered handler
@@ -1715,8 +1857,17 @@ _NotifyDrv_addBufByPid (UInt16             procId,
                     isExit = TRUE;
                 }
 
+                key = IGateProvider_enter (NotifyDrv_state.gateHandle);
                 List_put (NotifyDrv_state.eventState [i].bufList,
                           &(uBuf->element));
+                ring = NotifyDrv_state.eventState [i].ring;
+                if (ring != NULL) {
+                    NotifyDrv_ringBarrier ();
+                    ring->listPut++;
+                }
+                wake_up_interruptible (
+                                &NotifyDrv_state.eventState [i].readQueue);
+                IGateProvider_leave (NotifyDrv_state.gateHandle, key);
 
                 /* Post the semphore */
                 OsalSemaphore_post(NotifyDrv_state.eventState[i].semHandle);
@@ -1741,6 +1892,30 @@ _NotifyDrv_addBufByPid (UInt16             procId,
 }
 
 
+/*!
+ *  @brief      Returns the event state index of the process owning a file,
+ *              or MAX_PROCESSES if it is not attached.  Must be called with
+ *              the module gate held.
+ *
+ *  @param      filp    File structure pointer.
+ */
+static
+UInt32
+_NotifyDrv_findByFile (struct file * filp)
+{
+    UInt32 pid = (UInt32) pid_nr (filp->f_owner.pid);
+    UInt32 i;
+
+    for (i = 0 ; i < MAX_PROCESSES ; i++) {
+        if (NotifyDrv_state.eventState [i].pid == pid) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+
 /*!
  *  @brief  Module setup function.
  *
@@ -1796,6 +1971,10 @@ _NotifyDrv_setup (Void)
                     NotifyDrv_state.eventState [i].bufList = NULL;
                     NotifyDrv_state.eventState [i].pid = -1;
                     NotifyDrv_state.eventState [i].refCount = 0;
+                    NotifyDrv_state.eventState [i].ring = NULL;
+                    NotifyDrv_state.eventState [i].ringMem = NULL;
+                    init_waitqueue_head (
+                                    &NotifyDrv_state.eventState [i].readQueue);
                 }
 
                 /* create a resource tracker instance */
@@ -1918,6 +2097,7 @@ NotifyDrv_attach (UInt32 pid)
 
     OsalSemaphore_Handle semHandle;
     OsalSemaphore_Handle terSemHandle;
+    struct page *        ringPage;
 
     GT_1trace (curTrace, GT_ENTER, "NotifyDrv_attach", pid);
     Error_init (&eb);
@@ -1982,9 +2162,22 @@ NotifyDrv_attach (UInt32 pid)
                 }
                 else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+                    /* The event ring is optional, without it the process
+                     * reads one packet at a time.  It is only used once
+                     * the process has mapped it, see NotifyDrv_mmap.
+                     */
+                    BUILD_BUG_ON (sizeof (NotifyDrv_EventRing) > PAGE_SIZE);
+                    ringPage = alloc_page (GFP_KERNEL | __GFP_ZERO);
+
                     /* Search for an available slot for user process. */
                     for (i = 0 ; i < MAX_PROCESSES ; i++) {
                         if (NotifyDrv_state.eventState [i].pid == -1) {
+                            NotifyDrv_state.eventState [i].ring = NULL;
+                            NotifyDrv_state.eventState [i].ringMem =
+                                      (ringPage != NULL) ?
+                                      (NotifyDrv_EventRing *)
+                                                page_address (ringPage) :
+                                      NULL;
                             NotifyDrv_state.eventState [i].semHandle =
                                                                 semHandle;
                             NotifyDrv_state.eventState [i].terSemHandle =
@@ -2021,6 +2214,9 @@ NotifyDrv_attach (UInt32 pid)
                         if (terSemHandle != NULL) {
                             OsalSemaphore_delete (&terSemHandle);
                         }
+                        if (ringPage != NULL) {
+                            __free_page (ringPage);
+                        }
                     }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
                 }
@@ -2058,6 +2254,7 @@ NotifyDrv_detach (UInt32 pid)
     IArg                 key;
     OsalSemaphore_Handle semHandle;
     OsalSemaphore_Handle terSemHandle;
+    NotifyDrv_EventRing *ring      = NULL;
 
     GT_1trace (curTrace, GT_ENTER, "NotifyDrv_detach", pid);
 
@@ -2118,9 +2315,16 @@ NotifyDrv_detach (UInt32 pid)
             semHandle = NotifyDrv_state.eventState [i].semHandle;
             terSemHandle = NotifyDrv_state.eventState [i].terSemHandle;
 
+            ring = NotifyDrv_state.eventState [i].ringMem;
+
             NotifyDrv_state.eventState [i].bufList = NULL;
             NotifyDrv_state.eventState [i].semHandle = NULL;
             NotifyDrv_state.eventState [i].terSemHandle = NULL;
+            NotifyDrv_state.eventState [i].ring = NULL;
+            NotifyDrv_state.eventState [i].ringMem = NULL;
+
+            /* Let pollers see that the process is gone. */
+            wake_up_interruptible (&NotifyDrv_state.eventState [i].readQueue);
 
             IGateProvider_leave (NotifyDrv_state.gateHandle, key);
         }
@@ -2144,6 +2348,11 @@ NotifyDrv_detach (UInt32 pid)
             /* Last client being unregistered with Notify module. */
             List_delete (&bufList);
 
+            /* User mappings keep their own reference on the page. */
+            if (ring != NULL) {
+                __free_page (virt_to_page (ring));
+            }
+
             /* Remove/delete the semphore */
             tmpStatus = OsalSemaphore_delete (&semHandle);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
@@ -0,0 +1,308 @@
+/*
+ *  @file   PcmShm.c
+ *
+ *  @brief      Allocates the DaVinci McASP PCM buffers from a SharedRegion
+ *              heap, so that the DSP can process the periods in place, and
+ *              forwards every elapsed period to it as a Notify event.
+ *
+ *
+ *
+ *  ============================================================================
+ *
+ *  Copyright (c) 2008-2012, Texas Instruments Incorporated
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *  
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  Contact information for paper mail:
+ *  Texas Instruments
+ *  Post Office Box 655303
+ *  Dallas, Texas 75265
+ *  Contact information: 
+ *  http://www-k.ext.ti.com/sc/technical-support/product-information-centers.htm?
+ *  DCMP=TIHomeTracking&HQS=Other+OT+home_d_contact
+ *  ============================================================================
+ *  
+ */
+
+
+
+/* Linux headers */
+#include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/mm.h>
+#include <sound/davinci-pcm-shm.h>
+
+/* Standard headers */
+#include <ti/syslink/Std.h>
+
+/* Utilities & OSAL headers */
+#include <ti/syslink/utils/Trace.h>
+#include <ti/syslink/utils/Memory.h>
+#include <ti/syslink/utils/_Memory.h>
+
+/* Module level headers */
+#include <ti/ipc/Ipc.h>
+#include <ti/ipc/MultiProc.h>
+#include <ti/ipc/Notify.h>
+#include <ti/ipc/SharedRegion.h>
+#include <ti/syslink/inc/knl/PcmShm.h>
+
+
+/* =============================================================================
+ *  Module parameters
+ * =============================================================================
+ */
+/*
+ *  SharedRegion the buffers are allocated from; it must have a heap and
+ *  must not be cached on the host, as EDMA accesses it directly.
+ */
+static ushort pcmShmRegionId = 1;
+module_param (pcmShmRegionId, ushort, S_IRUGO);
+MODULE_PARM_DESC (pcmShmRegionId, "SharedRegion for McASP PCM buffers");
+
+/* Notify line and event raised on the DSP for each elapsed period */
+static ushort pcmShmLineId = 0;
+module_param (pcmShmLineId, ushort, S_IRUGO);
+MODULE_PARM_DESC (pcmShmLineId, "Notify line for McASP period events");
+
+static uint pcmShmEventId = 10;
+module_param (pcmShmEventId, uint, S_IRUGO);
+MODULE_PARM_DESC (pcmShmEventId, "Notify event for McASP period events");
+
+
+/* =============================================================================
+ *  Macros and types
+ * =============================================================================
+ */
+/*
+ *  Event payload: PCM device in bits 31..28, capture in bit 27, DMA byte
+ *  position in the buffer in bits 26..0.
+ */
+#define PcmShm_PAYLOAD(device, stream, pos)                                   \
+            (  (((UInt32) (device) & 0xFu) << 28u)                            \
+             | (((UInt32) (stream) & 0x1u) << 27u)                            \
+             | ((UInt32) (pos) & 0x07FFFFFFu))
+
+/* Streams are indexed by the 4 bit device and 1 bit direction above */
+#define PcmShm_MAXDEVICES   16u
+
+typedef struct PcmShm_Buffer_Tag {
+    Ptr             buf;
+    /*!< CPU address, NULL if the stream has no buffer from us */
+    IHeap_Handle    heap;
+    /*!< Heap it came from, the region's heap is gone after Ipc_detach */
+    SizeT           size;
+    /*!< Allocated size, whole pages */
+} PcmShm_Buffer;
+
+typedef struct PcmShm_ModuleObject_Tag {
+    UInt16          remoteProcId;
+    /*!< Slave the buffers are shared with, MultiProc_INVALIDID if none */
+    Bool            registered;
+    /*!< TRUE when registered with davinci-pcm */
+    PcmShm_Buffer   buffers [PcmShm_MAXDEVICES][2];
+    /*!< Buffers handed out, by device and stream */
+} PcmShm_ModuleObject;
+
+
+/* =============================================================================
+ *  Globals
+ * =============================================================================
+ */
+static PcmShm_ModuleObject PcmShm_state = {
+    .remoteProcId = MultiProc_INVALIDID,
+    .registered   = FALSE,
+};
+
+
+/* =============================================================================
+ *  davinci-pcm buffer provider
+ * =============================================================================
+ */
+static Ptr
+PcmShm_alloc (Int device, Int stream, SizeT size, dma_addr_t * phys)
+{
+    PcmShm_Buffer * entry;
+    IHeap_Handle    heap;
+    Ptr             buf;
+
+    GT_3trace (curTrace, GT_ENTER, "PcmShm_alloc", device, stream, size);
+
+    if ((UInt) device >= PcmShm_MAXDEVICES || (UInt) stream > 1u) {
+        return NULL;
+    }
+    entry = &PcmShm_state.buffers [device][stream];
+
+    if (SharedRegion_isCacheEnabled (pcmShmRegionId)) {
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "PcmShm_alloc",
+                             SharedRegion_E_FAIL,
+                             "SharedRegion is cached, not sharing PCM buffer");
+        return NULL;
+    }
+
+    heap = (IHeap_Handle) SharedRegion_getHeap (pcmShmRegionId);
+    if (heap == NULL) {
+        return NULL;
+    }
+
+    /*
+     *  Page aligned and a whole number of pages, so that ALSA can map it
+     *  to user space without exposing the neighbouring allocations.
+     */
+    size = PAGE_ALIGN (size);
+    buf = Memory_alloc (heap, size, PAGE_SIZE, NULL);
+    if (buf != NULL) {
+        *phys = (dma_addr_t) Memory_translate (buf, Memory_XltFlags_Virt2Phys);
+        entry->buf  = buf;
+        entry->heap = heap;
+        entry->size = size;
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "PcmShm_alloc", buf);
+
+    return buf;
+}
+
+static Void
+PcmShm_free (Int device, Int stream, Ptr buf, SizeT size)
+{
+    PcmShm_Buffer * entry;
+
+    GT_4trace (curTrace, GT_ENTER, "PcmShm_free", device, stream, buf, size);
+
+    if ((UInt) device < PcmShm_MAXDEVICES && (UInt) stream <= 1u) {
+        entry = &PcmShm_state.buffers [device][stream];
+        if (entry->buf == buf) {
+            Memory_free (entry->heap, buf, entry->size);
+            entry->buf = NULL;
+        }
+    }
+
+    GT_0trace (curTrace, GT_LEAVE, "PcmShm_free");
+}
+
+static Void
+PcmShm_periodElapsed (Int device, Int stream, UInt pos)
+{
+    UInt16 remoteProcId = PcmShm_state.remoteProcId;
+
+    if (remoteProcId == MultiProc_INVALIDID) {
+        return;
+    }
+
+    /*
+     *  Runs in interrupt context: do not wait for the DSP to take the
+     *  previous event, it only needs the latest position.
+     */
+    Notify_sendEvent (remoteProcId,
+                      pcmShmLineId,
+                      pcmShmEventId,
+                      PcmShm_PAYLOAD (device, stream, pos),
+                      FALSE);
+}
+
+static struct davinci_pcm_shm_ops PcmShm_ops = {
+    .owner          = THIS_MODULE,
+    .alloc          = PcmShm_alloc,
+    .free           = PcmShm_free,
+    .period_elapsed = PcmShm_periodElapsed,
+};
+
+
+/* =============================================================================
+ *  APIs
+ * =============================================================================
+ */
+/*
+ *  The audio driver is optional, so it is looked up at run time instead of
+ *  making syslink depend on it; it has to be loaded before the DSP is
+ *  attached.
+ */
+Void
+PcmShm_attach (UInt16 remoteProcId)
+{
+    typeof (davinci_pcm_register_shm) * reg;
+
+    GT_1trace (curTrace, GT_ENTER, "PcmShm_attach", remoteProcId);
+
+    if (   (remoteProcId == MultiProc_getId ("DSP"))
+        && (PcmShm_state.registered == FALSE)) {
+        reg = symbol_get (davinci_pcm_register_shm);
+        if (reg != NULL) {
+            PcmShm_state.remoteProcId = remoteProcId;
+            if (reg (&PcmShm_ops) == 0) {
+                PcmShm_state.registered = TRUE;
+            }
+            else {
+                PcmShm_state.remoteProcId = MultiProc_INVALIDID;
+            }
+            symbol_put (davinci_pcm_register_shm);
+        }
+    }
+
+    GT_0trace (curTrace, GT_LEAVE, "PcmShm_attach");
+}
+
+/*
+ *  Fails with Ipc_E_NOTREADY while a stream still has a buffer in the
+ *  region, as EDMA may be running on it; the caller retries the detach
+ *  once the audio streams are closed.
+ */
+Int
+PcmShm_detach (UInt16 remoteProcId)
+{
+    Int status = Ipc_S_SUCCESS;
+    typeof (davinci_pcm_unregister_shm) * unreg;
+
+    GT_1trace (curTrace, GT_ENTER, "PcmShm_detach", remoteProcId);
+
+    if (   (remoteProcId == PcmShm_state.remoteProcId)
+        && (PcmShm_state.registered == TRUE)) {
+        unreg = symbol_get (davinci_pcm_unregister_shm);
+        if (unreg != NULL) {
+            if (unreg (&PcmShm_ops) < 0) {
+                status = Ipc_E_NOTREADY;
+                GT_setFailureReason (curTrace,
+                                     GT_4CLASS,
+                                     "PcmShm_detach",
+                                     status,
+                                     "PCM streams still use shared buffers");
+            }
+            symbol_put (davinci_pcm_unregister_shm);
+        }
+        if (status >= 0) {
+            PcmShm_state.registered = FALSE;
+            PcmShm_state.remoteProcId = MultiProc_INVALIDID;
+        }
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "PcmShm_detach", status);
+
+    return status;
+}
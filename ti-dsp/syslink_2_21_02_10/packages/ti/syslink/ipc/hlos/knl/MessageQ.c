@@ -50,6 +50,7 @@
 /* Standard headers */
 #if defined(SYSLINK_BUILDOS_LINUX)
 #include <linux/string.h>
+#include <asm/system.h>
 #else
 #include <string.h>
 #endif
@@ -135,6 +136,8 @@ typedef struct MessageQ_ModuleObject {
     /*!< sequence number                    */
     IGateProvider_Handle resGate;
     /*!< Resource gate */
+    MessageQ_Stats      stats;
+    /*!< Remote send counters */
 } MessageQ_ModuleObject;
 
 /*!
@@ -157,6 +160,10 @@ typedef struct MessageQ_Object_tag {
     /* Whether MessageQ is unblocked */
     Int                     state;
     /* internal state of object */
+    MessageQ_RxRing *       rxRing;
+    /* Receive ring shared with the user-space reader, or NULL */
+    UInt32                  rxTail;
+    /* Kernel copy of rxRing->tail, which user-space can overwrite */
 } MessageQ_Object;
 
 
@@ -208,6 +215,13 @@ UInt16 _MessageQ_grow (MessageQ_Object * obj);
 /* This is a helper function to initialize a message. */
 static Void MessageQ_msgInit (MessageQ_Msg msg);
 
+/* Takes the next message off a queue's lists and receive ring. */
+static inline MessageQ_Msg _MessageQ_getNext (MessageQ_Object * obj);
+
+/* Number of messages in a queue's receive ring from the given head. */
+static inline UInt32 _MessageQ_rxRingPending (MessageQ_Object * obj,
+                                              UInt32            head);
+
 
 /* =============================================================================
  * APIS
@@ -798,6 +812,8 @@ MessageQ_delete (MessageQ_Handle * handlePtr)
     IArg              key;
     IArg              resKey;
     MessageQ_Msg      tempMsg;
+    UInt32            head;
+    UInt32            pending;
 
     GT_1trace (curTrace, GT_ENTER, "MessageQ_delete", handlePtr);
 
@@ -907,6 +923,29 @@ MessageQ_delete (MessageQ_Handle * handlePtr)
         /* Free the list */
         List_destruct (&obj->highList);
 
+        /* Remove all the messages left in the receive ring */
+        if (   (obj->rxRing != NULL)
+            && (obj->state != MessageQ_State_TERMINATED)) {
+            head    = obj->rxRing->head;
+            pending = _MessageQ_rxRingPending (obj, head);
+            MessageQ_rxRingBarrier ();
+            while (pending > 0u) {
+                tempMsg = (MessageQ_MsgHeader *) SharedRegion_getPtr (
+                    obj->rxRing->slot [head % MessageQ_RXRING_SLOTS]);
+                head++;
+                pending--;
+                if (EXPECT_FALSE (tempMsg == NULL)) {
+                    /* Overwritten from user-space, nothing to free. */
+                    continue;
+                }
+                tmpStatus = MessageQ_free (tempMsg);
+                if (EXPECT_FALSE ((tmpStatus < 0) && (status >= 0))) {
+                    status = tmpStatus;
+                }
+            }
+            obj->rxRing->head = head;
+        }
+
         if (EXPECT_TRUE (obj->synchronizer != NULL)) {
             if (EXPECT_TRUE (obj->params.synchronizer == NULL)) {
                 tmpStatus = OsalSemaphore_delete (&obj->synchronizer);
@@ -1120,45 +1159,40 @@ MessageQ_get (MessageQ_Handle handle, MessageQ_Msg * msg, UInt timeout)
          * List_get is internally protected.
          */
 
-        /* First try to get from highList. */
-        *msg = (MessageQ_Msg) List_get ((List_Handle) &obj->highList);
+        *msg = _MessageQ_getNext (obj);
         while (*msg == NULL) {
-            *msg = (MessageQ_Msg) List_get ((List_Handle) &obj->normalList);
-            if (*msg == NULL) {
-                /*
-                 *  Block until notified.  If pend times-out, no message
-                 *  should be returned to the caller
-                 */
-                status = OsalSemaphore_pend (obj->synchronizer, timeout);
-                if (EXPECT_FALSE (    (status == OSALSEMAPHORE_E_TIMEOUT)
-                                  ||  (status == OSALSEMAPHORE_E_WAITNONE))) {
-                    *msg = NULL;
-                    status = MessageQ_E_TIMEOUT;
-                    /* Do not set failure reason since this is a runtime error*/
-                    break;
-                }
-                else if (EXPECT_TRUE (  (status >= 0)
-                                     && (status != -ERESTARTSYS))) {
-                    if (obj->unblocked) {
-                        /* *(msg) may be NULL */
-                        status = MessageQ_E_UNBLOCKED;
-                        break;
-                    }
-                    else {
-                        *msg = (MessageQ_Msg)
-                                    List_get ((List_Handle) &obj->highList);
-                        status = MessageQ_S_SUCCESS;
-                    }
-                }
-                else if (status == -ERESTARTSYS) {
-                    /* leave status as -ERESTARTSYS */
+            /*
+             *  Block until notified.  If pend times-out, no message
+             *  should be returned to the caller
+             */
+            status = OsalSemaphore_pend (obj->synchronizer, timeout);
+            if (EXPECT_FALSE (    (status == OSALSEMAPHORE_E_TIMEOUT)
+                              ||  (status == OSALSEMAPHORE_E_WAITNONE))) {
+                *msg = NULL;
+                status = MessageQ_E_TIMEOUT;
+                /* Do not set failure reason since this is a runtime error*/
+                break;
+            }
+            else if (EXPECT_TRUE (  (status >= 0)
+                                 && (status != -ERESTARTSYS))) {
+                if (obj->unblocked) {
+                    /* *(msg) may be NULL */
+                    status = MessageQ_E_UNBLOCKED;
                     break;
                 }
                 else {
-                    status = MessageQ_E_FAIL;
-                    break;
+                    *msg = _MessageQ_getNext (obj);
+                    status = MessageQ_S_SUCCESS;
                 }
             }
+            else if (status == -ERESTARTSYS) {
+                /* leave status as -ERESTARTSYS */
+                break;
+            }
+            else {
+                status = MessageQ_E_FAIL;
+                break;
+            }
         }
 
         if (   (status >= 0)
@@ -1225,6 +1259,10 @@ MessageQ_count (MessageQ_Handle handle)
             count++;
         }
 
+        if (obj->rxRing != NULL) {
+            count += _MessageQ_rxRingPending (obj, obj->rxRing->head);
+        }
+
         Gate_leaveSystem (key);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
     }
@@ -1475,6 +1513,9 @@ Int MessageQ_put (MessageQ_QueueId queueId,
     UInt                      priority;
     UInt16                    flags;
     IArg                      key;
+    MessageQ_RxRing *         ring      = NULL;
+    Bool                      ringed    = FALSE;
+    UInt16                    index     = SharedRegion_INVALIDREGIONID;
 
     GT_2trace (curTrace, GT_ENTER, "MessageQ_put", queueId, msg);
 
@@ -1566,6 +1607,11 @@ Int MessageQ_put (MessageQ_QueueId queueId,
 
                     /* put msg to remote processor using transport */
                     status = IMessageQTransport_put (transport, msg);
+                    if (EXPECT_TRUE (status >= 0)) {
+                        key = Gate_enterSystem ();
+                        MessageQ_module->stats.msgsSent++;
+                        Gate_leaveSystem (key);
+                    }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
                     if (EXPECT_FALSE (status < 0)) {
                         /* Transport returns MessageQ status code, so no
@@ -1625,8 +1671,29 @@ Int MessageQ_put (MessageQ_QueueId queueId,
                                      "MessageQ_Object is NULL failed!");
             }
             else {
+                ring = obj->rxRing;
+                if (ring != NULL) {
+                    index = SharedRegion_getId (msg);
+                }
 
-                if (EXPECT_FALSE (   (msg->flags & MessageQ_PRIORITYMASK)
+                if (   (ring != NULL)
+                    && (index != SharedRegion_INVALIDREGIONID)
+                    && (   (msg->flags & MessageQ_PRIORITYMASK)
+                        == MessageQ_NORMALPRI)
+                    && (ring->listPut == ring->listGot)
+                    && (obj->rxTail - ring->head < MessageQ_RXRING_SLOTS)) {
+                    /* Nothing is ahead of it, let the reader take it
+                     * straight from user-space.
+                     */
+                    ring->slot [obj->rxTail % MessageQ_RXRING_SLOTS] =
+                                        SharedRegion_getSRPtr (msg, index);
+                    MessageQ_rxRingBarrier ();
+                    obj->rxTail++;
+                    ring->tail = obj->rxTail;
+                    ringed = TRUE;
+                    status = MessageQ_S_SUCCESS;
+                }
+                else if (EXPECT_FALSE (   (msg->flags & MessageQ_PRIORITYMASK)
                               == MessageQ_URGENTPRI)) {
                     /* Send to the front of the list. */
                     List_putHead ((List_Handle) &obj->highList,
@@ -1650,6 +1717,12 @@ Int MessageQ_put (MessageQ_QueueId queueId,
                     }
                 }
 
+                /* Make the user-space reader come in for listed ones. */
+                if ((ring != NULL) && (ringed == FALSE)) {
+                    MessageQ_rxRingBarrier ();
+                    ring->listPut++;
+                }
+
                 /* Notify the reader. */
                 if (EXPECT_TRUE (obj->synchronizer != NULL)) {
                     status = OsalSemaphore_post (obj->synchronizer);
@@ -1695,6 +1768,189 @@ leave:
 }
 
 
+/* Place messages onto a queue, raising one notification where possible. */
+Int
+MessageQ_putBatch (MessageQ_QueueId   queueId,
+                   MessageQ_Msg     * msgs,
+                   UInt               count,
+                   UInt             * numPut)
+{
+    Int                       status    = MessageQ_S_SUCCESS;
+    UInt16                    dstProcId = (MessageQ_QueueIndex)(queueId >> 16);
+    IMessageQTransport_Handle transport = NULL;
+    IMessageQTransport_Batch  batch;
+    Bool                      oneByOne  = TRUE;
+    UInt                      priority;
+    UInt                      i;
+    IArg                      key;
+
+    GT_4trace (curTrace, GT_ENTER, "MessageQ_putBatch",
+               queueId, msgs, count, numPut);
+
+    GT_assert (curTrace, (queueId != MessageQ_INVALIDMESSAGEQ));
+    GT_assert (curTrace, (msgs != NULL));
+    GT_assert (curTrace, (numPut != NULL));
+
+    *numPut = 0u;
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (EXPECT_FALSE ((msgs == NULL) || (count == 0u))) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_putBatch",
+                             status,
+                             "msgs is null or count is zero!");
+    }
+    else if (EXPECT_FALSE (   (dstProcId != MultiProc_self ())
+                           && (dstProcId >= MultiProc_MAXPROCESSORS))) {
+        status = MessageQ_E_INVALIDPROCID;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_putBatch",
+                             status,
+                             "ProcId invalid!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        if (dstProcId != MultiProc_self ()) {
+            /* The whole batch goes over the transport of the first one. */
+            priority = (UInt)(msgs [0]->flags & MessageQ_TRANSPORTPRIORITYMASK);
+            transport = MessageQ_module->transports [dstProcId][priority];
+            if (transport == NULL) {
+                transport = MessageQ_module->transports [dstProcId][!priority];
+            }
+
+            if (EXPECT_TRUE (transport != NULL)) {
+                for (i = 0u; i < count; i++) {
+                    msgs [i]->dstId   = (UInt16)(queueId);
+                    msgs [i]->dstProc = (UInt16)(queueId >> 16);
+                }
+
+                batch.msgs  = (Ptr *) msgs;
+                batch.count = count;
+                status = IMessageQTransport_control (transport,
+                                                IMessageQTransport_Cmd_PUTBATCH,
+                                                (UArg) &batch);
+                /* Only a transport without batch support falls back. */
+                if (status >= 0) {
+                    oneByOne = FALSE;
+                    *numPut = count;
+                    key = Gate_enterSystem ();
+                    MessageQ_module->stats.msgsSent += count;
+                    Gate_leaveSystem (key);
+                }
+                else if (status != MessageQ_E_INVALIDARG) {
+                    oneByOne = FALSE;
+                    GT_setFailureReason (curTrace,
+                                         GT_4CLASS,
+                                         "MessageQ_putBatch",
+                                         status,
+                                         "Transport batch put failed!");
+                }
+            }
+        }
+
+        /* Local queue, or a transport with no batch support. */
+        if (oneByOne) {
+            status = MessageQ_S_SUCCESS;
+            for (i = 0u; (i < count) && (status >= 0); i++) {
+                status = MessageQ_put (queueId, msgs [i]);
+                if (status >= 0) {
+                    (*numPut)++;
+                }
+            }
+        }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQ_putBatch", status);
+
+    return (status);
+}
+
+
+/* Get up to max messages, waiting up to timeout for the first one only. */
+Int
+MessageQ_getBatch (MessageQ_Handle    handle,
+                   MessageQ_Msg     * msgs,
+                   UInt               max,
+                   UInt               timeout,
+                   UInt             * numGot)
+{
+    Int     status = MessageQ_S_SUCCESS;
+    UInt    n      = 0u;
+
+    GT_5trace (curTrace, GT_ENTER, "MessageQ_getBatch",
+               handle, msgs, max, timeout, numGot);
+
+    GT_assert (curTrace, (handle != NULL));
+    GT_assert (curTrace, (msgs != NULL));
+    GT_assert (curTrace, (numGot != NULL));
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (EXPECT_FALSE ((msgs == NULL) || (max == 0u))) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_getBatch",
+                             status,
+                             "msgs is null or max is zero!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        status = MessageQ_get (handle, &msgs [0], timeout);
+        if (status >= 0) {
+            /* Take whatever else arrived along with it. */
+            for (n = 1u; n < max; n++) {
+                if (MessageQ_get (handle, &msgs [n], 0u) < 0) {
+                    break;
+                }
+            }
+        }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    *numGot = (status >= 0) ? n : 0u;
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQ_getBatch", status);
+
+    return (status);
+}
+
+
+/* Returns the remote send counters. */
+Void
+MessageQ_getStats (MessageQ_Stats * stats)
+{
+    IArg key;
+
+    GT_1trace (curTrace, GT_ENTER, "MessageQ_getStats", stats);
+
+    GT_assert (curTrace, (stats != NULL));
+
+    key = Gate_enterSystem ();
+    *stats = MessageQ_module->stats;
+    Gate_leaveSystem (key);
+
+    GT_0trace (curTrace, GT_LEAVE, "MessageQ_getStats");
+}
+
+
+/* Counts a notification sent to a remote processor. */
+Void
+MessageQ_countDoorbell (Void)
+{
+    IArg key;
+
+    key = Gate_enterSystem ();
+    MessageQ_module->stats.doorbells++;
+    Gate_leaveSystem (key);
+}
+
+
 /* Register a heap with MessageQ. */
 Int
 MessageQ_registerHeap (Ptr heap, UInt16 heapId)
@@ -2324,3 +2580,123 @@ Void MessageQ_setState(MessageQ_Handle handle, Int state)
 
     obj->state = state;
 }
+
+/*
+ *  ======== _MessageQ_getNext ========
+ *  Messages come off the high priority list first, then off the receive
+ *  ring, which only ever holds messages older than those in the normal
+ *  list, and then off the normal list.  Called by the queue's reader.
+ */
+static inline MessageQ_Msg _MessageQ_getNext (MessageQ_Object * obj)
+{
+    MessageQ_RxRing * ring = obj->rxRing;
+    MessageQ_Msg      msg;
+    UInt32            head;
+
+    msg = (MessageQ_Msg) List_get ((List_Handle) &obj->highList);
+
+    if ((msg == NULL) && (ring != NULL)) {
+        head = ring->head;
+        if (_MessageQ_rxRingPending (obj, head) != 0u) {
+            MessageQ_rxRingBarrier ();
+            msg = (MessageQ_Msg) SharedRegion_getPtr (
+                                    ring->slot [head % MessageQ_RXRING_SLOTS]);
+            MessageQ_rxRingBarrier ();
+            ring->head = head + 1;
+            /* A slot overwritten from user-space is dropped. */
+            if (EXPECT_TRUE (msg != NULL)) {
+                return msg;
+            }
+        }
+    }
+
+    if (msg == NULL) {
+        msg = (MessageQ_Msg) List_get ((List_Handle) &obj->normalList);
+    }
+
+    if ((msg != NULL) && (ring != NULL)) {
+        ring->listGot++;
+    }
+
+    return msg;
+}
+
+/*
+ *  ======== _MessageQ_rxRingPending ========
+ *  The ring's head is written by user-space and is only trusted as far as
+ *  the kernel's own copy of the tail and the size of the ring allow.  A
+ *  head outside of that leaves the ring looking empty.
+ */
+static inline UInt32 _MessageQ_rxRingPending (MessageQ_Object * obj,
+                                              UInt32            head)
+{
+    UInt32 pending = obj->rxTail - head;
+
+    return (pending > MessageQ_RXRING_SLOTS) ? 0u : pending;
+}
+
+/*
+ *  ======== MessageQ_setRxRing ========
+ */
+Void MessageQ_setRxRing (MessageQ_Handle handle, MessageQ_RxRing * ring)
+{
+    MessageQ_Object * obj = (MessageQ_Object *) handle;
+    List_Elem *       elem;
+    UInt32            listed = 0u;
+    IArg              key;
+
+    GT_2trace (curTrace, GT_ENTER, "MessageQ_setRxRing", handle, ring);
+
+    GT_assert (curTrace, (handle != NULL));
+
+    /* hold off MessageQ_put while the lists are counted */
+    key = IGateProvider_enter (MessageQ_module->resGate);
+
+    if (ring != NULL) {
+        List_traverse (elem, (List_Handle) &obj->highList) {
+            listed++;
+        }
+        List_traverse (elem, (List_Handle) &obj->normalList) {
+            listed++;
+        }
+
+        ring->head    = 0u;
+        ring->tail    = 0u;
+        ring->listPut = listed;
+        ring->listGot = 0u;
+        MessageQ_rxRingBarrier ();
+    }
+    obj->rxTail = 0u;
+    obj->rxRing = ring;
+
+    IGateProvider_leave (MessageQ_module->resGate, key);
+
+    GT_0trace (curTrace, GT_LEAVE, "MessageQ_setRxRing");
+}
+
+/*
+ *  ======== MessageQ_getRxRing ========
+ */
+MessageQ_RxRing * MessageQ_getRxRing (UInt16 queueIndex)
+{
+    MessageQ_Object * obj  = NULL;
+    MessageQ_RxRing * ring = NULL;
+    IArg              key;
+
+    GT_1trace (curTrace, GT_ENTER, "MessageQ_getRxRing", queueIndex);
+
+    key = IGateProvider_enter (MessageQ_module->gate);
+
+    if (queueIndex < MessageQ_module->numQueues) {
+        obj = (MessageQ_Object *) MessageQ_module->queues [queueIndex];
+        if (obj != NULL) {
+            ring = obj->rxRing;
+        }
+    }
+
+    IGateProvider_leave (MessageQ_module->gate, key);
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQ_getRxRing", ring);
+
+    return ring;
+}
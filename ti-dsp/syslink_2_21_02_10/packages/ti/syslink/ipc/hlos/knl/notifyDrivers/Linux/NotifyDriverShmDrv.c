@@ -57,8 +57,20 @@
 /* Standard headers */
 #include <ti/syslink/Std.h>
 
+/* OSAL & Utils headers */
+#include <ti/ipc/MultiProc.h>
+#include <ti/ipc/Notify.h>
+
+/* Linux specific header files */
+#include <linux/moduleparam.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/fs.h>
+
 /* Module headers */
 #include <ti/syslink/inc/NotifyDriverShm.h>
+#include <ti/syslink/inc/knl/_NotifyDriverShm.h>
+#include <ti/syslink/inc/knl/Linux/NotifyDriverShmDrv.h>
 
 
 /** ============================================================================
@@ -74,3 +86,101 @@ EXPORT_SYMBOL(NotifyDriverShm_create);
 EXPORT_SYMBOL(NotifyDriverShm_delete);
 EXPORT_SYMBOL(NotifyDriverShm_sharedMemReq);
 
+
+/** ============================================================================
+ *  Globals
+ *  ============================================================================
+ */
+/* debugfs directory of the driver */
+static struct dentry * NotifyDriverShmDrv_debugDir = NULL;
+
+/* Hold back payloads of pending events instead of waiting, off by default */
+static int notifyShmHoldBack = 0;
+module_param (notifyShmHoldBack, bool, S_IRUGO);
+MODULE_PARM_DESC (notifyShmHoldBack,
+                  "Queue Notify payloads while their event is pending");
+
+
+/** ============================================================================
+ *  Functions
+ *  ============================================================================
+ */
+/*
+ *  ======== NotifyDriverShmDrv_statsShow ========
+ *  Prints the send counters of every driver instance.
+ */
+static int NotifyDriverShmDrv_statsShow (struct seq_file * s, void * unused)
+{
+    NotifyDriverShm_Stats stats;
+    UInt16                procId;
+    UInt16                lineId;
+
+    seq_printf (s, "proc line       sent     queued maxq      waits"
+                   "      spins     sleeps max_sleeps\n");
+
+    for (procId = 0u; procId < MultiProc_MAXPROCESSORS; procId++) {
+        for (lineId = 0u; lineId < Notify_MAX_INTLINES; lineId++) {
+            if (NotifyDriverShm_getStats (procId, lineId, &stats) < 0) {
+                continue;
+            }
+            seq_printf (s, "%4u %4u %10u %10u %4u %10u %10u %10u %10u\n",
+                        procId, lineId, stats.sent, stats.queued,
+                        stats.maxQueued, stats.waits, stats.spins,
+                        stats.sleeps, stats.maxSleeps);
+        }
+    }
+
+    return 0;
+}
+
+static int NotifyDriverShmDrv_statsOpen (struct inode * inode,
+                                         struct file  * file)
+{
+    return single_open (file, NotifyDriverShmDrv_statsShow, inode->i_private);
+}
+
+static const struct file_operations NotifyDriverShmDrv_statsFops = {
+    .open    = NotifyDriverShmDrv_statsOpen,
+    .read    = seq_read,
+    .llseek  = seq_lseek,
+    .release = single_release,
+};
+
+
+/*
+ *  ======== NotifyDriverShmDrv_setup ========
+ *  Creates <debugfs>/syslink/notify_shm.
+ */
+Void NotifyDriverShmDrv_setup (Void)
+{
+    NotifyDriverShmDrv_debugDir = debugfs_create_dir ("syslink", NULL);
+    if (IS_ERR_OR_NULL (NotifyDriverShmDrv_debugDir)) {
+        /* Only the counters are lost, the driver works without them. */
+        NotifyDriverShmDrv_debugDir = NULL;
+        return;
+    }
+
+    debugfs_create_file ("notify_shm", S_IRUGO, NotifyDriverShmDrv_debugDir,
+                         NULL, &NotifyDriverShmDrv_statsFops);
+}
+
+
+/*
+ *  ======== NotifyDriverShmDrv_holdBack ========
+ *  Returns the notifyShmHoldBack module parameter.
+ */
+Bool NotifyDriverShmDrv_holdBack (Void)
+{
+    return (notifyShmHoldBack ? TRUE : FALSE);
+}
+
+
+/*
+ *  ======== NotifyDriverShmDrv_destroy ========
+ *  Removes what NotifyDriverShmDrv_setup created.
+ */
+Void NotifyDriverShmDrv_destroy (Void)
+{
+    debugfs_remove_recursive (NotifyDriverShmDrv_debugDir);
+    NotifyDriverShmDrv_debugDir = NULL;
+}
@@ -59,6 +59,7 @@
 #include <ti/syslink/inc/Bitops.h>
 #include <ti/syslink/utils/String.h>
 #include <ti/syslink/utils/List.h>
+#include <ti/syslink/inc/knl/OsalThread.h>
 #include <ti/ipc/MultiProc.h>
 #include <ti/syslink/inc/_Ipc.h>
 
@@ -80,6 +81,10 @@
 #include <syslink/notify_shm_drv.h>
 #endif
 
+#if defined (SYSLINK_BUILDOS_LINUX)
+#include <ti/syslink/inc/knl/Linux/NotifyDriverShmDrv.h>
+#endif
+
 
 /* =============================================================================
  *  Macros and types
@@ -169,6 +174,22 @@ struct NotifyDriverShm_Object_tag {
     /* Spacing between event entries   */
     UInt32                           numEvents;
     /*!< Number of events configured */
+    UInt32                           pendEvent [NotifyDriverShm_PENDING_SLOTS];
+    /*!< Events of the payloads held back, in sending order */
+    UInt32                           pendPayload[NotifyDriverShm_PENDING_SLOTS];
+    /*!< Payloads held back until the remote processor takes their event */
+    UInt32                           pendHead;
+    /*!< Free running index of the oldest payload held back */
+    UInt32                           pendTail;
+    /*!< Free running index of the next free pending slot */
+    UInt16                           pendCount [Notify_MAXEVENTS];
+    /*!< Number of payloads held back for each event */
+    OsalThread_Handle                pendThread;
+    /*!< Thread sending the held back payloads when nothing else does */
+    Bool                             exiting;
+    /*!< Set when the instance is being deleted */
+    NotifyDriverShm_Stats            stats;
+    /*!< Counters reported by NotifyDriverShm_getStats */
 };
 
 
@@ -194,6 +215,7 @@ NotifyDriverShm_ModuleObject NotifyDriverShm_state =
     .defInstParams.lineId = 0x0,
     .defInstParams.localIntId = (UInt32) -1,
     .defInstParams.remoteIntId = (UInt32) -1,
+    .defInstParams.holdBack = FALSE,
 };
 
 /* Extern declaration to Notify state object variable */
@@ -217,6 +239,26 @@ extern UInt32 SysLogging_NotifyCallbackCount;
  */
 static Bool _NotifyDriverShm_ISR (Void * refData);
 
+/* Sends the held back payloads whose event has been taken by the remote
+ * processor, and returns the number still held back.
+ */
+static UInt32 _NotifyDriverShm_flush (NotifyDriverShm_Object * obj);
+
+/* Thread function sending held back payloads until none is left. */
+static Void _NotifyDriverShm_pendThread (Ptr arg);
+
+/* Waits a bounded time for the held back payloads to be sent. */
+static Int _NotifyDriverShm_drain (NotifyDriverShm_Object * obj);
+
+/* Sets an event and its payload in the remote event chart and interrupts the
+ * remote processor.
+ */
+static inline Void _NotifyDriverShm_raise (
+                            NotifyDriverShm_Object *              obj,
+                            volatile NotifyDriverShm_EventEntry * eventEntry,
+                            UInt32                                eventId,
+                            UInt32                                payload);
+
 
 /* =============================================================================
  * APIs called directly by applications
@@ -368,6 +410,11 @@ NotifyDriverShm_setup (NotifyDriverShm_Config * cfg)
             Memory_copy (&NotifyDriverShm_state.cfg,
                          cfg,
                          sizeof (NotifyDriverShm_Config));
+#if defined (SYSLINK_BUILDOS_LINUX)
+            NotifyDriverShmDrv_setup ();
+            NotifyDriverShm_state.defInstParams.holdBack =
+                                                NotifyDriverShmDrv_holdBack ();
+#endif
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
@@ -437,6 +484,10 @@ NotifyDriverShm_destroy (Void)
                 }
             }
 
+#if defined (SYSLINK_BUILDOS_LINUX)
+            NotifyDriverShmDrv_destroy ();
+#endif
+
             /* Reset the refCount */
             Atomic_set (&NotifyDriverShm_state.refCount,
                         NotifyDriverShm_MAKE_MAGICSTAMP(0));
@@ -821,6 +872,28 @@ NotifyDriverShm_create (const NotifyDriverShm_Params * params)
                                      status,
                                      "ArchIpcInt_interruptRegister failed");
             }
+            else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+                /* Only needed when payloads can be held back. */
+                if (obj->params.holdBack == TRUE) {
+                    obj->pendThread = OsalThread_create (
+                                                _NotifyDriverShm_pendThread,
+                                                (Ptr) obj,
+                                                NULL);
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+                    if (obj->pendThread == NULL) {
+                        /*! @retval NULL Failed to create the pending thread! */
+                        status = Notify_E_FAIL;
+                        GT_setFailureReason (curTrace,
+                                             GT_4CLASS,
+                                             "NotifyDriverShm_create",
+                                             status,
+                                             "OsalThread_create failed");
+                    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+                }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+            }
             /* Indicate that the driver is initialized for this processor
              * only when the corresponding Notify driver is also created,
              * i.e. in NotifyDriverShm_setNotifyHandle.
@@ -834,6 +907,10 @@ NotifyDriverShm_create (const NotifyDriverShm_Params * params)
                 ArchIpcInt_interruptUnregister(obj->remoteProcId,
                         obj->params.localIntId, (Ptr)obj);
 
+                if (obj->pendThread != NULL) {
+                    OsalThread_delete (&obj->pendThread);
+                }
+
                 if (obj->selfProcCtrl != NULL) {
                     /* Clear initialization status in shared memory. */
                     obj->selfProcCtrl->recvInitStatus = 0x0;
@@ -939,6 +1016,18 @@ NotifyDriverShm_delete (INotifyDriver_Handle * handlePtr)
         obj = (NotifyDriverShm_Object *) notifyDrvObj->obj;
 
         if (obj != NULL) {
+            /* Hand over what is held back before stopping the thread; if
+             * the remote processor does not take it, the instance is still
+             * deleted but Notify_E_TIMEOUT is returned.
+             */
+            if (obj->params.holdBack == TRUE) {
+                status = _NotifyDriverShm_drain (obj);
+            }
+            obj->exiting = TRUE;
+            if (obj->pendThread != NULL) {
+                OsalThread_delete (&obj->pendThread);
+            }
+
             tmpStatus = ArchIpcInt_interruptUnregister(obj->remoteProcId,
                     obj->params.localIntId, (Ptr)obj);
             if ((status >= 0) && (tmpStatus < 0)) {
@@ -1262,7 +1351,13 @@ NotifyDriverShm_unregisterEvent (NotifyDriverShm_Handle handle,
  *  @param      payload     Payload to be sent alongwith the event.
  *  @param      waitClear   Indicates whether Notify driver will wait for
  *                          previous event to be cleared. If payload needs to
- *                          be sent across, this must be TRUE.
+ *                          be sent across, this must be TRUE.  If the
+ *                          instance was created with holdBack, the payload
+ *                          is instead held back while the previous event is
+ *                          still set, and sent once the remote processor has
+ *                          taken it; the caller then only waits when
+ *                          NotifyDriverShm_PENDING_SLOTS payloads are held
+ *                          back already.
  *
  *  @sa
  */
@@ -1278,6 +1373,10 @@ NotifyDriverShm_sendEvent (NotifyDriverShm_Handle handle,
 volatile NotifyDriverShm_EventEntry *  eventEntry;
      UInt32                        maxPollCount;
      IArg                          sysKey;
+     UInt32                        sleeps  = 0;
+     Bool                          slept;
+     Bool                          held    = FALSE;
+     UInt32                        slot;
 
     GT_4trace (curTrace,
                GT_ENTER,
@@ -1341,22 +1440,41 @@ volatile NotifyDriverShm_EventEntry *  eventEntry;
              */
         }
         else {
+            /*
+             *  The system gate is needed to ensure that the check of
+             *  eventEntry->flag is atomic with the eventEntry modifications
+             *  (flag/payload) and with the payloads held back.
+             */
+            sysKey = Gate_enterSystem ();
+
             if (waitClear == TRUE) {
+                /* Hand over what the remote side has made room for. */
+                if (obj->pendHead != obj->pendTail) {
+                    _NotifyDriverShm_flush (obj);
+                }
+
                 if (obj->cacheEnabled) {
                     Cache_inv ((Ptr) eventEntry,
                                sizeof(NotifyDriverShm_EventEntry),
                                Cache_Type_ALL,
                                TRUE);
                 }
-                /*
-                 *  The system gate is needed to ensure that the check of
-                 *  eventEntry->flag  is atomic with the eventEntry modifications
-                 *  (flag/payload).
+
+                /* Only wait when the payload can neither be sent nor be held
+                 * back: spin first, then sleep between polls when allowed.
+                 * Without holdBack this is the plain wait for the previous
+                 * event to be cleared.
                  */
-                sysKey = Gate_enterSystem ();
+                while (   (   (obj->pendCount [eventId] != 0u)
+                           || (eventEntry->flag != NotifyDriverShm_DOWN))
+                       && (   (obj->params.holdBack == FALSE)
+                           || (   (obj->pendTail - obj->pendHead)
+                               >= NotifyDriverShm_PENDING_SLOTS))) {
+                    if (i == 0u) {
+                        obj->stats.waits++;
+                    }
+                    obj->stats.spins++;
 
-                /* Wait for completion of previous event from other side. */
-                while (eventEntry->flag != NotifyDriverShm_DOWN) {
                     /* Leave critical section protection. Create a window
                      * of opportunity for other interrupts to be handled.
                      */
@@ -1381,45 +1499,70 @@ volatile NotifyDriverShm_EventEntry *  eventEntry;
                         break;
                     }
 
+                    slept = FALSE;
+                    if (   (obj->params.holdBack == TRUE)
+                        && (i > NotifyDriverShm_SPIN_COUNT)
+                        && (OsalThread_inThread () == TRUE)) {
+                        OsalThread_sleep (1u);
+                        slept = TRUE;
+                        sleeps++;
+                    }
+
+                    /* Re-enter the system gate */
+                    sysKey = Gate_enterSystem ();
+
+                    if (slept == TRUE) {
+                        obj->stats.sleeps++;
+                        if (sleeps > obj->stats.maxSleeps) {
+                            obj->stats.maxSleeps = sleeps;
+                        }
+                    }
+
+                    _NotifyDriverShm_flush (obj);
+
                     if (obj->cacheEnabled) {
                         Cache_inv ((Ptr) eventEntry,
                                    sizeof(NotifyDriverShm_EventEntry),
                                    Cache_Type_ALL,
                                    TRUE);
                     }
+                }
 
-                    /* Re-enter the system gate */
-                    sysKey = Gate_enterSystem();
+                if (   (status >= 0)
+                    && (obj->params.holdBack == TRUE)
+                    && (   (obj->pendCount [eventId] != 0u)
+                        || (eventEntry->flag != NotifyDriverShm_DOWN))) {
+                    /* Hold the payload back behind the earlier ones. */
+                    slot = obj->pendTail % NotifyDriverShm_PENDING_SLOTS;
+                    obj->pendEvent [slot]   = eventId;
+                    obj->pendPayload [slot] = payload;
+                    obj->pendTail++;
+                    obj->pendCount [eventId]++;
+                    obj->stats.queued++;
+                    if (  (obj->pendTail - obj->pendHead)
+                        > obj->stats.maxQueued) {
+                        obj->stats.maxQueued = obj->pendTail - obj->pendHead;
+                    }
+                    held = TRUE;
                 }
             }
-            else {
-                /*
-                 *  The system gate is needed to ensure that checking eventEntry->flag
-                 *  is atomic with the eventEntry modifications (flag/payload).
-                 */
-                sysKey = Gate_enterSystem();
-            }
-            if (status >= 0) {
-                /* Set the event bit field and payload. */
-                eventEntry->payload = payload;
-                eventEntry->flag    = NotifyDriverShm_UP;
 
-                if (obj->cacheEnabled) {
-                    Cache_wbInv ((Ptr) eventEntry,
-                                 sizeof (NotifyDriverShm_EventEntry),
-                                 Cache_Type_ALL,
-                                 TRUE);
+            if (status >= 0) {
+                if (held == FALSE) {
+                    /* Set the event bit field and payload, and send an
+                     * interrupt with the event information to the remote
+                     * processor.
+                     */
+                    _NotifyDriverShm_raise (obj, eventEntry, eventId, payload);
+                }
+                else if ((obj->pendTail - obj->pendHead) == 1u) {
+                    /* Have the pending thread deliver it if no later send
+                     * or interrupt does so first.
+                     */
+                    OsalThread_activate (obj->pendThread);
                 }
 
-                /* Send an interrupt with the event information to the
-                   remote processor */
-                ArchIpcInt_sendInterrupt (obj->remoteProcId,
-                                          obj->params.remoteIntId,
-                                          eventId);
-                /* OK to leave system gate before sending the interrupt */
-                Gate_leaveSystem(sysKey);
-
-
+                Gate_leaveSystem (sysKey);
             }
         }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
@@ -1865,6 +2008,57 @@ NotifyDriverShm_setNotifyHandle (NotifyDriverShm_Handle handle,
 }
 
 
+/*!
+ *  @brief      Get the counters of the driver for a processor and line.
+ *
+ *  @param      procId  Remote processor of the driver.
+ *  @param      lineId  Interrupt line of the driver.
+ *  @param      stats   Location to receive the counters.
+ *
+ *  @sa         NotifyDriverShm_sendEvent
+ */
+Int
+NotifyDriverShm_getStats (UInt16                  procId,
+                          UInt16                  lineId,
+                          NotifyDriverShm_Stats * stats)
+{
+    Int                      status = Notify_S_SUCCESS;
+    INotifyDriver_Object *   notifyDrvObj;
+    IArg                     key;
+
+    GT_3trace (curTrace, GT_ENTER, "NotifyDriverShm_getStats",
+               procId, lineId, stats);
+
+    GT_assert (curTrace, (stats != NULL));
+
+    if (   (procId >= MultiProc_MAXPROCESSORS)
+        || (lineId >= Notify_MAX_INTLINES)) {
+        /*! @retval Notify_E_INVALIDARG Invalid procId or lineId */
+        status = Notify_E_INVALIDARG;
+    }
+    else {
+        key = IGateProvider_enter (NotifyDriverShm_state.gateHandle);
+        notifyDrvObj = (INotifyDriver_Object *)
+                        NotifyDriverShm_state.driverHandles [procId][lineId];
+        if ((notifyDrvObj == NULL) || (notifyDrvObj->obj == NULL)) {
+            /*! @retval Notify_E_DRIVERNOTREGISTERED No driver on this line */
+            status = Notify_E_DRIVERNOTREGISTERED;
+        }
+        else {
+            Memory_copy (stats,
+                         &((NotifyDriverShm_Object *) notifyDrvObj->obj)->stats,
+                         sizeof (NotifyDriverShm_Stats));
+        }
+        IGateProvider_leave (NotifyDriverShm_state.gateHandle, key);
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "NotifyDriverShm_getStats", status);
+
+    /*! @retval Notify_S_SUCCESS Operation successfully completed. */
+    return (status);
+}
+
+
 /* =============================================================================
  * Internal functions
  * =============================================================================
@@ -1886,6 +2080,7 @@ _NotifyDriverShm_ISR (Void * arg)
 volatile NotifyDriverShm_EventEntry * eventEntry;
     NotifyDriverShm_Object *        obj;
     UInt32                          eventId;
+    IArg                            sysKey;
 
     GT_1trace (curTrace, GT_ENTER, "_NotifyDriverShm_ISR", arg);
 
@@ -1946,8 +2141,200 @@ volatile NotifyDriverShm_EventEntry * eventEntry;
     }
     while ((eventId != (UInt32) -1) && (i < obj->numEvents));
 
+    /* The remote side is running, it may have taken held back events. */
+    if (obj->pendHead != obj->pendTail) {
+        sysKey = Gate_enterSystem ();
+        _NotifyDriverShm_flush (obj);
+        Gate_leaveSystem (sysKey);
+    }
+
     GT_1trace (curTrace, GT_LEAVE, "_NotifyDriverShm_ISR", TRUE);
 
     /*! @retval TRUE ISR has been handled. */
     return (TRUE); /* ISR is always handled. */
 }
+
+
+/*!
+ *  @brief      Sets an event and its payload in the remote event chart and
+ *              interrupts the remote processor.  Must be called with the
+ *              system gate entered.
+ *
+ *  @param      obj           Driver instance
+ *  @param      eventEntry    Remote event chart entry of the event
+ *  @param      eventId       Event to be raised
+ *  @param      payload       Payload of the event
+ */
+static inline
+Void
+_NotifyDriverShm_raise (NotifyDriverShm_Object *              obj,
+                        volatile NotifyDriverShm_EventEntry * eventEntry,
+                        UInt32                                eventId,
+                        UInt32                                payload)
+{
+    /* Set the event bit field and payload. */
+    eventEntry->payload = payload;
+    eventEntry->flag    = NotifyDriverShm_UP;
+
+    if (obj->cacheEnabled) {
+        Cache_wbInv ((Ptr) eventEntry,
+                     sizeof (NotifyDriverShm_EventEntry),
+                     Cache_Type_ALL,
+                     TRUE);
+    }
+
+    /* Send an interrupt with the event information to the remote
+     * processor.
+     */
+    ArchIpcInt_sendInterrupt (obj->remoteProcId,
+                              obj->params.remoteIntId,
+                              eventId);
+
+    obj->stats.sent++;
+}
+
+
+/*!
+ *  @brief      Sends the held back payloads whose event has been taken by
+ *              the remote processor.  Payloads of one event are sent in the
+ *              order they were given, those of other events may pass them.
+ *              Must be called with the system gate entered.
+ *
+ *  @param      obj           Driver instance
+ *
+ *  @retval     Number of payloads still held back
+ */
+static
+UInt32
+_NotifyDriverShm_flush (NotifyDriverShm_Object * obj)
+{
+volatile NotifyDriverShm_EventEntry * eventEntry;
+    UInt32                          busy = 0u;
+    UInt32                          out  = obj->pendHead;
+    UInt32                          in;
+    UInt32                          eventId;
+    UInt32                          payload;
+
+    for (in = obj->pendHead; in != obj->pendTail; in++) {
+        eventId = obj->pendEvent [in % NotifyDriverShm_PENDING_SLOTS];
+        payload = obj->pendPayload [in % NotifyDriverShm_PENDING_SLOTS];
+
+        if (!TEST_BIT (busy, eventId)) {
+            eventEntry = EVENTENTRY (obj->otherEventChart,
+                                     obj->eventEntrySize,
+                                     eventId);
+            if (obj->cacheEnabled) {
+                Cache_inv ((Ptr) eventEntry,
+                           sizeof (NotifyDriverShm_EventEntry),
+                           Cache_Type_ALL,
+                           TRUE);
+            }
+
+            if (eventEntry->flag == NotifyDriverShm_DOWN) {
+                _NotifyDriverShm_raise (obj, eventEntry, eventId, payload);
+                obj->pendCount [eventId]--;
+                continue;
+            }
+
+            /* Later payloads of this event must stay behind this one. */
+            SET_BIT (busy, eventId);
+        }
+
+        /* Keep it, packed towards the head. */
+        obj->pendEvent [out % NotifyDriverShm_PENDING_SLOTS]   = eventId;
+        obj->pendPayload [out % NotifyDriverShm_PENDING_SLOTS] = payload;
+        out++;
+    }
+    obj->pendTail = out;
+
+    return (out - obj->pendHead);
+}
+
+
+/*!
+ *  @brief      Thread function sending held back payloads until none is
+ *              left, polling the remote event chart once a millisecond.
+ *              It is activated when a payload is held back with none
+ *              before it.
+ *
+ *  @param      arg           Driver instance
+ */
+static
+Void
+_NotifyDriverShm_pendThread (Ptr arg)
+{
+    NotifyDriverShm_Object * obj = (NotifyDriverShm_Object *) arg;
+    UInt32                   left;
+    IArg                     sysKey;
+
+    GT_1trace (curTrace, GT_ENTER, "_NotifyDriverShm_pendThread", arg);
+
+    GT_assert (curTrace, (obj != NULL));
+
+    do {
+        sysKey = Gate_enterSystem ();
+        left = _NotifyDriverShm_flush (obj);
+        Gate_leaveSystem (sysKey);
+
+        if ((left != 0u) && (obj->exiting == FALSE)) {
+            OsalThread_sleep (1u);
+        }
+    } while ((left != 0u) && (obj->exiting == FALSE));
+
+    GT_0trace (curTrace, GT_LEAVE, "_NotifyDriverShm_pendThread");
+}
+
+
+/*!
+ *  @brief      Waits for the held back payloads to be sent, polling the
+ *              remote event chart once a millisecond for at most
+ *              NotifyDriverShm_DRAIN_POLLS polls.  Called when the instance
+ *              is deleted, so that payloads are not dropped silently.
+ *
+ *  @param      obj           Driver instance
+ *
+ *  @retval     Notify_S_SUCCESS   Nothing is held back any more
+ *  @retval     Notify_E_TIMEOUT   The remote processor did not take them all
+ */
+static
+Int
+_NotifyDriverShm_drain (NotifyDriverShm_Object * obj)
+{
+    Int                      status = Notify_S_SUCCESS;
+    UInt32                   left;
+    UInt32                   i      = 0u;
+    IArg                     sysKey;
+
+    GT_1trace (curTrace, GT_ENTER, "_NotifyDriverShm_drain", obj);
+
+    GT_assert (curTrace, (obj != NULL));
+
+    sysKey = Gate_enterSystem ();
+    left = _NotifyDriverShm_flush (obj);
+    Gate_leaveSystem (sysKey);
+
+    while ((left != 0u) && (i < NotifyDriverShm_DRAIN_POLLS)) {
+        if (OsalThread_inThread () == TRUE) {
+            OsalThread_sleep (1u);
+        }
+        i++;
+
+        sysKey = Gate_enterSystem ();
+        left = _NotifyDriverShm_flush (obj);
+        Gate_leaveSystem (sysKey);
+    }
+
+    if (left != 0u) {
+        /*! @retval Notify_E_TIMEOUT Held back payloads were not delivered */
+        status = Notify_E_TIMEOUT;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "_NotifyDriverShm_drain",
+                             status,
+                             "Held back payloads were not delivered");
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "_NotifyDriverShm_drain", status);
+
+    return (status);
+}
@@ -213,6 +213,9 @@ Void _TransportShm_notifyFxn (UInt16  procId,
                               UInt32  eventId,
                               Ptr     arg,
                               UInt32  payload);
+/* Put several messages to the remote list with one notification. */
+static Int _TransportShm_putBatch (TransportShm_Obj         * obj,
+                                   IMessageQTransport_Batch * batch);
 /* Function to create/open the handle. */
 Int
 _TransportShm_create (      TransportShm_Handle *     handlePtr,
@@ -1163,6 +1166,10 @@ TransportShm_put (TransportShm_Handle   handle,
 
             /* leave the gate */
             GateMP_leave (obj->gate, key);
+
+            if (status >= 0) {
+                MessageQ_countDoorbell ();
+            }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         }
     }
@@ -1189,15 +1196,25 @@ TransportShm_control (TransportShm_Handle   handle,
                       UInt                  cmd,
                       UArg                  cmdArg)
 {
+    Int                status = MessageQ_E_INVALIDARG;
+    TransportShm_Obj * obj;
+
     GT_3trace (curTrace, GT_ENTER, "TransportShm_control", handle, cmd, cmdArg);
 
     GT_assert (curTrace, (handle != NULL));
 
-    GT_1trace (curTrace, GT_LEAVE, "TransportShm_control",
-               MessageQ_E_INVALIDARG);
+    if (cmd == IMessageQTransport_Cmd_PUTBATCH) {
+        obj = (TransportShm_Obj *) ((TransportShm_Object *) handle)->obj;
+        GT_assert (curTrace, (obj != NULL));
+
+        status = _TransportShm_putBatch (obj,
+                                         (IMessageQTransport_Batch *) cmdArg);
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "TransportShm_control", status);
 
     /*! @retval MessageQ_E_INVALIDARG Specified operation is not supported. */
-    return (MessageQ_E_INVALIDARG);
+    return (status);
 }
 
 
@@ -1321,6 +1338,110 @@ TransportShm_setErrFxn (TransportShm_ErrFxn errFxn)
  * Internal functions
  * =============================================================================
  */
+/*!
+ *  @brief      Put several messages to the remote list with one notification.
+ *
+ *              The remote side empties the whole list each time it is
+ *              notified, so one interrupt is enough for the batch.
+ *
+ *  @param      obj        TransportShm instance
+ *  @param      batch      Messages to be delivered to the remote list
+ *
+ *  @sa         TransportShm_put
+ */
+static
+Int
+_TransportShm_putBatch (TransportShm_Obj         * obj,
+                        IMessageQTransport_Batch * batch)
+{
+    Int                status = MessageQ_S_SUCCESS;
+    IArg               key;
+    UInt16             id;
+    UInt               i;
+    UInt               n;
+
+    GT_2trace (curTrace, GT_ENTER, "_TransportShm_putBatch", obj, batch);
+
+    GT_assert (curTrace, (batch != NULL));
+
+    for (i = 0u; (i < batch->count) && (status >= 0); i++) {
+        id = SharedRegion_getId (batch->msgs [i]);
+        if (EXPECT_FALSE (id >= SharedRegion_getNumRegions ())) {
+            /*
+             *  Not MessageQ_E_INVALIDARG, which tells MessageQ that
+             *  batches are not supported.
+             */
+            /*! @retval MessageQ_E_INVALIDMSG Invalid message passed */
+            status = MessageQ_E_INVALIDMSG;
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_TransportShm_putBatch",
+                                 status,
+                                 "msg contains invalid sharedregion id");
+        }
+        else if (EXPECT_FALSE (SharedRegion_isCacheEnabled (id))) {
+            /* writeback invalidate the message */
+            Cache_wbInv (batch->msgs [i],
+                         ((MessageQ_Msg) (batch->msgs [i]))->msgSize,
+                         Cache_Type_ALL,
+                         FALSE);
+        }
+    }
+
+    if (status >= 0) {
+        /* complete the writebacks issued above */
+        Cache_wait ();
+
+        key = GateMP_enter (obj->gate);
+
+        for (n = 0u; (n < batch->count) && (status >= 0); n++) {
+            status = ListMP_putTail ((ListMP_Handle) obj->remoteList,
+                                     (ListMP_Elem *) batch->msgs [n]);
+        }
+
+        if (status >= 0) {
+            status = Notify_sendEvent (obj->remoteProcId,
+                                       0,
+                                       TransportShm_notifyEventId,
+                                       0,
+                                       FALSE);
+            if (status < 0) {
+                /*! @retval MessageQ_E_TIMEOUT Notification failed */
+                status = MessageQ_E_TIMEOUT;
+            }
+            else {
+                MessageQ_countDoorbell ();
+            }
+        }
+        else {
+            /*! @retval MessageQ_E_FAIL ListMP_putTail failed */
+            status = MessageQ_E_FAIL;
+            n--;
+        }
+
+        if (status < 0) {
+            /* Take back what was put, the caller still owns all of it. */
+            for (i = 0u; i < n; i++) {
+                ListMP_remove ((ListMP_Handle) obj->remoteList,
+                               (ListMP_Elem *) batch->msgs [i]);
+            }
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "_TransportShm_putBatch",
+                                 status,
+                                 "Failed to put the batch to remote processor");
+        }
+
+        GateMP_leave (obj->gate, key);
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "_TransportShm_putBatch", status);
+
+    /*! @retval MessageQ_S_SUCCESS Operation successful */
+    return (status);
+}
+
+
 /*!
  *  @brief      Callback function registered with the Notify module.
  *
@@ -1034,6 +1034,9 @@ TransportShmCirc_put (TransportShmCirc_Handle   handle,
                                            TransportShmCirc_notifyEventId,
                                            0,
                                            FALSE);
+                if (status >= 0) {
+                    MessageQ_countDoorbell ();
+                }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
                 if (status < 0) {
                     /* Override status with MessageQ status code. */
@@ -764,6 +764,9 @@ TransportShmNotify_put (TransportShmNotify_Handle   handle,
                                        TransportShmNotify_notifyEventId,
                                        (UInt32)msgSRPtr,
                                        TRUE);
+            if (status >= 0) {
+                MessageQ_countDoorbell ();
+            }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
             if (status < 0) {
                 /* Override status with MessageQ status code. */
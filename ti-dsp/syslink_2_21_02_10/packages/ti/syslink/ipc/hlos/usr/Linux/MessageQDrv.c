@@ -65,6 +65,7 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <errno.h>
+#include <sys/mman.h>
 
 
 /** ============================================================================
@@ -240,3 +241,58 @@ MessageQDrv_ioctl (UInt32 cmd, Ptr args)
     /*! @retval MessageQ_S_SUCCESS Operation successfully completed. */
     return status;
 }
+
+
+/*!
+ *  @brief  Function to map the receive ring of a local queue.
+ *
+ *  @param  queueIndex  Index of the queue, the low half of its queueId
+ *  @param  size        Size of the ring, one page
+ *
+ *  @sa     MessageQDrv_unmap
+ */
+Ptr
+MessageQDrv_map (UInt16 queueIndex, UInt32 size)
+{
+    Ptr addr;
+
+    GT_2trace (curTrace, GT_ENTER, "MessageQDrv_map", queueIndex, size);
+
+    GT_assert (curTrace, (MessageQDrv_refCount > 0));
+
+    addr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 MessageQDrv_handle, (off_t) queueIndex * getpagesize ());
+    if (addr == MAP_FAILED) {
+        /* Not fatal, the queue is then read through ioctl. */
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQDrv_map",
+                             MessageQ_E_OSFAILURE,
+                             "Failed to map receive ring!");
+        addr = NULL;
+    }
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQDrv_map", addr);
+
+    /*! @retval NULL Ring could not be mapped */
+    return addr;
+}
+
+
+/*!
+ *  @brief  Function to unmap a receive ring.
+ *
+ *  @param  addr    Address returned by MessageQDrv_map
+ *  @param  size    Size passed to MessageQDrv_map
+ *
+ *  @sa     MessageQDrv_map
+ */
+Void
+MessageQDrv_unmap (Ptr addr, UInt32 size)
+{
+    GT_2trace (curTrace, GT_ENTER, "MessageQDrv_unmap", addr, size);
+
+    munmap (addr, size);
+
+    GT_0trace (curTrace, GT_LEAVE, "MessageQDrv_unmap");
+}
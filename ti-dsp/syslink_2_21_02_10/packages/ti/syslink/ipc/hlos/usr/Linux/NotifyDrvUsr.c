@@ -46,6 +46,11 @@
  */
 
 
+/* Needed for mmap64 of the event ring, see NotifyDrv_EVENTRING_PGOFF. */
+#if !defined (_LARGEFILE64_SOURCE)
+#define _LARGEFILE64_SOURCE
+#endif
+
 /* Standard headers */
 #include <ti/syslink/Std.h>
 
@@ -65,6 +70,8 @@
 #include <signal.h>
 #include <string.h>
 #include <pthread.h>
+#include <poll.h>
+#include <sys/mman.h>
 
 
 /** ============================================================================
@@ -101,6 +108,22 @@ static UInt32 NotifyDrvUsr_setup = 0;
  */
 static pthread_t  NotifyDrv_workerThread;
 
+/*!
+ *  @brief  Process identifier the events are read for.
+ */
+static UInt32 NotifyDrvUsr_pid = 0;
+
+/*!
+ *  @brief  Mapped event ring of this process, NULL if there is none.
+ */
+static NotifyDrv_EventRing * NotifyDrvUsr_ring = NULL;
+
+/*!
+ *  @brief  Serializes event dispatch between the Notify thread and callers
+ *          of NotifyDrvUsr_dispatchEvents.
+ */
+static pthread_mutex_t NotifyDrvUsr_dispatchLock = PTHREAD_MUTEX_INITIALIZER;
+
 
 /** ============================================================================
  *  Forward declaration of internal functions
@@ -113,6 +136,13 @@ static pthread_t  NotifyDrv_workerThread;
  */
 Void _NotifyDrvUsr_eventWorker(Void *arg);
 
+/*!
+ *  @brief      Runs the callbacks of all pending events.
+ *
+ *  @param      isExit  Set when the termination packet has been read.
+ */
+static Int _NotifyDrvUsr_drain (Bool * isExit);
+
 
 /** ============================================================================
  *  Functions
@@ -191,6 +221,14 @@ Int NotifyDrvUsr_open(Bool createThread)
             if ((NotifyDrvUsr_refCount == 1) || (isForked == TRUE)) {
                 pid = getpid ();
                 cmdArgs.pid = pid;
+                NotifyDrvUsr_pid = pid;
+
+                /* The ring mapped by the parent is not this process's. */
+                if ((isForked == TRUE) && (NotifyDrvUsr_ring != NULL)) {
+                    munmap ((Ptr) NotifyDrvUsr_ring, getpagesize ());
+                    NotifyDrvUsr_ring = NULL;
+                }
+
                 status = NotifyDrvUsr_ioctl (CMD_NOTIFY_THREADATTACH, &cmdArgs);
                 if (status < 0) {
                     GT_setFailureReason (curTrace,
@@ -201,6 +239,24 @@ Int NotifyDrvUsr_open(Bool createThread)
                                          "side!");
                 }
                 else {
+                    /* Receive events through the ring when there is one.
+                     * It is looked up by the descriptor's owner, which a
+                     * forked process shares with its parent.
+                     */
+                    if (isForked == FALSE) {
+                        NotifyDrvUsr_ring = (NotifyDrv_EventRing *) mmap64 (
+                                NULL,
+                                getpagesize (),
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED,
+                                NotifyDrvUsr_handle,
+                                (off64_t) NotifyDrv_EVENTRING_PGOFF
+                                                        * getpagesize ());
+                        if (NotifyDrvUsr_ring == MAP_FAILED) {
+                            NotifyDrvUsr_ring = NULL;
+                        }
+                    }
+
                     /* Create the pthread */
 #ifdef LINUX_THREAD
                     pthread_create (&NotifyDrv_workerThread,
@@ -268,6 +324,11 @@ NotifyDrvUsr_close (Bool deleteThread)
 
 #ifndef LINUX_THREAD
             pthread_join (NotifyDrv_workerThread, NULL);
+
+            if (NotifyDrvUsr_ring != NULL) {
+                munmap ((Ptr) NotifyDrvUsr_ring, getpagesize ());
+                NotifyDrvUsr_ring = NULL;
+            }
 #endif
         }
         NotifyDrvUsr_refCount--;
@@ -337,6 +398,44 @@ NotifyDrvUsr_ioctl (UInt32 cmd, Ptr args)
 }
 
 
+/*!
+ *  @brief  Function to get the descriptor to poll for events of this process.
+ *
+ *          The descriptor becomes readable in poll(), select() or epoll
+ *          whenever events are pending, so that an application can wait for
+ *          them along with its other descriptors and then call
+ *          NotifyDrvUsr_dispatchEvents.  Callbacks are then run by whichever
+ *          of the application and the Notify thread gets to them first.
+ *
+ *  @sa     NotifyDrvUsr_dispatchEvents
+ */
+Int
+NotifyDrvUsr_getFd (Void)
+{
+    return NotifyDrvUsr_handle;
+}
+
+
+/*!
+ *  @brief  Function to run the callbacks of all pending events of this
+ *          process.
+ *
+ *          Must only be called once the descriptor returned by
+ *          NotifyDrvUsr_getFd has been reported readable, since it may
+ *          otherwise block until the next event.
+ *
+ *  @sa     NotifyDrvUsr_getFd
+ */
+Int
+NotifyDrvUsr_dispatchEvents (Void)
+{
+    Bool isExit = FALSE;
+
+    /*! @retval Number-of-events Number of callbacks run. */
+    return _NotifyDrvUsr_drain (&isExit);
+}
+
+
 /** ============================================================================
  *  Internal functions
  *  ============================================================================
@@ -353,7 +452,9 @@ _NotifyDrvUsr_eventWorker (Void * arg)
 {
     Int32                 status = Notify_S_SUCCESS;
     UInt32                nRead  = 0;
+    Bool                  isExit = FALSE;
     NotifyDrv_EventPacket packet;
+    struct pollfd         pfd;
     sigset_t              blockSet;
 #ifdef LINUX_THREAD
     UInt32 pid = (UInt32 )arg;
@@ -377,31 +478,146 @@ _NotifyDrvUsr_eventWorker (Void * arg)
     }
 #endif
 
-    while (status >= 0) {
-        memset (&packet, 0, sizeof (NotifyDrv_EventPacket));
+    if (NotifyDrvUsr_ring != NULL) {
+        /* Wake up once for any number of events and run them all. */
+        pfd.fd     = NotifyDrvUsr_handle;
+        pfd.events = POLLIN;
+        while (isExit == FALSE) {
+            pfd.revents = 0;
+            if (poll (&pfd, 1, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror ("Event worker thread error in poll");
+                break;
+            }
+
+            /* The process has been detached. */
+            if ((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+                break;
+            }
+
+            _NotifyDrvUsr_drain (&isExit);
+        }
+    }
+    else {
+        while (status >= 0) {
+            memset (&packet, 0, sizeof (NotifyDrv_EventPacket));
 #ifdef LINUX_THREAD
-        packet.pid = pid;
+            packet.pid = pid;
 #else
-        packet.pid = getpid ();
+            packet.pid = getpid ();
 #endif
-        nRead = read (NotifyDrvUsr_handle,
-                      &packet,
-                      sizeof (NotifyDrv_EventPacket));
-        if (nRead == sizeof (NotifyDrv_EventPacket)) {
-            /* check for termination packet */
-            if (packet.isExit  == TRUE) {
-                pthread_exit (NULL);
-            }
+            nRead = read (NotifyDrvUsr_handle,
+                          &packet,
+                          sizeof (NotifyDrv_EventPacket));
+            if (nRead == sizeof (NotifyDrv_EventPacket)) {
+                /* check for termination packet */
+                if (packet.isExit  == TRUE) {
+                    pthread_exit (NULL);
+                }
 
-            if (packet.func != NULL) {
-                packet.func (packet.procId,
-                             packet.lineId,
-                             packet.eventId,
-                             packet.param,
-                             packet.data);
+                if (packet.func != NULL) {
+                    packet.func (packet.procId,
+                                 packet.lineId,
+                                 packet.eventId,
+                                 packet.param,
+                                 packet.data);
+                }
             }
         }
     }
 
     GT_0trace (curTrace, GT_LEAVE, "_NotifyDrvUsr_eventWorker");
 }
+
+
+/*!
+ *  @brief      Runs the callbacks of all pending events.
+ *
+ *              Events on the ring are run in one pass with no system call.
+ *              Packets queued on the kernel list, which are newer than any
+ *              left on the ring, are then read one at a time.  Without a
+ *              ring a single packet is read.
+ *
+ *  @param      isExit  Set when the termination packet has been read.
+ *
+ *  @sa         NotifyDrvUsr_dispatchEvents
+ */
+static
+Int
+_NotifyDrvUsr_drain (Bool * isExit)
+{
+    NotifyDrv_EventRing *  ring  = NotifyDrvUsr_ring;
+    NotifyDrv_RingPacket * slot;
+    NotifyDrv_EventPacket  packet;
+    UInt32                 head;
+    UInt32                 tail;
+    Int                    count = 0;
+    Bool                   more  = TRUE;
+
+    GT_1trace (curTrace, GT_ENTER, "_NotifyDrvUsr_drain", isExit);
+
+    pthread_mutex_lock (&NotifyDrvUsr_dispatchLock);
+
+    while ((more == TRUE) && (*isExit == FALSE)) {
+        more = FALSE;
+
+        if (ring != NULL) {
+            tail = ring->tail;
+            NotifyDrv_ringBarrier ();
+            for (head = ring->head; head != tail; head++) {
+                slot = &ring->slot [head % NotifyDrv_EVENTRING_SLOTS];
+                if (slot->func != NULL) {
+                    slot->func (slot->procId,
+                                slot->lineId,
+                                slot->eventId,
+                                slot->param,
+                                slot->data);
+                }
+                count++;
+            }
+            NotifyDrv_ringBarrier ();
+            ring->head = head;
+
+            if (ring->listPut == ring->listGot) {
+                break;
+            }
+
+            /* Events put on the ring before the list was used come first. */
+            NotifyDrv_ringBarrier ();
+            if (ring->head != ring->tail) {
+                more = TRUE;
+                continue;
+            }
+        }
+
+        memset (&packet, 0, sizeof (NotifyDrv_EventPacket));
+        packet.pid = NotifyDrvUsr_pid;
+        if (   read (NotifyDrvUsr_handle,
+                     &packet,
+                     sizeof (NotifyDrv_EventPacket))
+            == sizeof (NotifyDrv_EventPacket)) {
+            if (packet.isExit == TRUE) {
+                *isExit = TRUE;
+            }
+            else {
+                if (packet.func != NULL) {
+                    packet.func (packet.procId,
+                                 packet.lineId,
+                                 packet.eventId,
+                                 packet.param,
+                                 packet.data);
+                }
+                count++;
+                more = (ring != NULL);
+            }
+        }
+    }
+
+    pthread_mutex_unlock (&NotifyDrvUsr_dispatchLock);
+
+    GT_1trace (curTrace, GT_LEAVE, "_NotifyDrvUsr_drain", count);
+
+    return count;
+}
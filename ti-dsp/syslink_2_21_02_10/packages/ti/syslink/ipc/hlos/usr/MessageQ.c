@@ -133,6 +133,8 @@
 #include <ti/syslink/utils/List.h>
 #include <ti/syslink/utils/Trace.h>
 #include <ti/syslink/utils/Memory.h>
+#include <ti/syslink/utils/GateMutex.h>
+#include <ti/syslink/utils/Gate.h>
 
 /* Module level headers */
 #include <ti/ipc/MultiProc.h>
@@ -144,6 +146,16 @@
 #include <ti/syslink/inc/_SharedRegion.h>
 
 
+/* =============================================================================
+ * Macros
+ * =============================================================================
+ */
+/*!
+ *  @brief  Number of freed messages kept by a process for reuse.
+ */
+#define MessageQ_FREECACHE_SIZE     16u
+
+
 /* =============================================================================
  * Structures & Enums
  * =============================================================================
@@ -155,6 +167,8 @@ typedef struct MessageQ_Object_tag {
     /*!< Pointer to the kernel-side MessageQ object. */
     MessageQ_QueueId queueId;
     /* Unique id */
+    MessageQ_RxRing * rxRing;
+    /*!< Mapped receive ring of the queue, NULL if there is none. */
 }MessageQ_Object;
 
 /*!
@@ -164,6 +178,13 @@ typedef struct MessageQ_ModuleObject_tag {
     UInt32          setupRefCount;
     /*!< Reference count for number of times setup/destroy were called in this
          process. */
+    IGateProvider_Handle cacheLock;
+    /*!< Protects the free message cache */
+    UInt32          numCached;
+    /*!< Number of messages in the free message cache */
+    MessageQ_Msg    cached [MessageQ_FREECACHE_SIZE];
+    /*!< Messages freed by this process, handed out again by MessageQ_alloc
+         without going through the kernel. */
 } MessageQ_ModuleObject;
 
 
@@ -181,7 +202,9 @@ static
 #endif /* if !defined(SYSLINK_BUILD_DEBUG) */
 MessageQ_ModuleObject MessageQ_state =
 {
-    .setupRefCount = 0
+    .setupRefCount = 0,
+    .cacheLock     = NULL,
+    .numCached     = 0
 };
 
 /*!
@@ -195,6 +218,17 @@ static
 MessageQ_ModuleObject * MessageQ_module = &MessageQ_state;
 
 
+/* =============================================================================
+ * Forward declarations of internal functions
+ * =============================================================================
+ */
+/* Returns a message of the free message cache to the kernel-side heaps. */
+static Void _MessageQ_flushCache (Void);
+
+/* Takes the next message off a queue's receive ring, if it may. */
+static inline MessageQ_Msg _MessageQ_ringGet (MessageQ_RxRing * ring);
+
+
 /* =============================================================================
  * APIS
  * =============================================================================
@@ -270,6 +304,7 @@ MessageQ_setup (const MessageQ_Config * config)
 {
     Int                 status = MessageQ_S_SUCCESS;
     MessageQDrv_CmdArgs cmdArgs;
+    Error_Block         eb;
 
     GT_1trace (curTrace, GT_ENTER, "MessageQ_setup", config);
 
@@ -309,6 +344,18 @@ MessageQ_setup (const MessageQ_Config * config)
             }
         }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+        /* Without the lock messages are simply not cached. */
+        if (status >= 0) {
+            MessageQ_module->numCached = 0;
+            MessageQ_module->cacheLock = (IGateProvider_Handle)
+                             GateMutex_create ((GateMutex_Params *) NULL, &eb);
+            if (MessageQ_module->cacheLock == NULL) {
+                GT_0trace (curTrace,
+                           GT_2CLASS,
+                           "MessageQ_setup: no free message cache");
+            }
+        }
     }
 
     GT_1trace (curTrace, GT_LEAVE, "MessageQ_setup", status);
@@ -330,6 +377,12 @@ MessageQ_destroy (Void)
     MessageQ_module->setupRefCount--;
     /* This is needed at runtime so should not be in SYSLINK_BUILD_OPTIMIZE. */
     if (MessageQ_module->setupRefCount == 0) {
+        if (MessageQ_module->cacheLock != NULL) {
+            _MessageQ_flushCache ();
+            GateMutex_delete ((GateMutex_Handle *)
+                              &MessageQ_module->cacheLock);
+        }
+
         status = MessageQDrv_ioctl (CMD_MESSAGEQ_DESTROY, &cmdArgs);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
         if (status < 0) {
@@ -436,6 +489,7 @@ MessageQ_create (      String            name,
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         cmdArgs.args.create.params = (MessageQ_Params *) params;
         cmdArgs.args.create.name = name;
+        cmdArgs.args.create.rxRing = 0;
         if (name != NULL) {
             cmdArgs.args.create.nameLen = (String_len (name) + 1);
         }
@@ -475,6 +529,13 @@ MessageQ_create (      String            name,
                 /* Set pointer to kernel object into the user handle. */
                 handle->knlObject = cmdArgs.args.create.handle;
                 handle->queueId = cmdArgs.args.create.queueId;
+
+                /* Without a ring every get goes through the kernel. */
+                if (cmdArgs.args.create.rxRing != 0) {
+                    handle->rxRing = (MessageQ_RxRing *) MessageQDrv_map (
+                                        (UInt16) handle->queueId,
+                                        sizeof (MessageQ_RxRing));
+                }
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
              }
          }
@@ -542,6 +603,10 @@ MessageQ_delete (MessageQ_Handle * handlePtr)
         }
         else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+            if (((MessageQ_Object *)(*handlePtr))->rxRing != NULL) {
+                MessageQDrv_unmap (((MessageQ_Object *)(*handlePtr))->rxRing,
+                                   sizeof (MessageQ_RxRing));
+            }
             Memory_free (NULL, *handlePtr, sizeof (MessageQ_Object));
             *handlePtr = NULL;
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
@@ -755,6 +820,7 @@ MessageQ_get (MessageQ_Handle handle, MessageQ_Msg * msg ,UInt timeout)
     Int                 status   = MessageQ_S_SUCCESS;
     SharedRegion_SRPtr  msgSrPtr = SharedRegion_INVALIDSRPTR;
     MessageQDrv_CmdArgs cmdArgs;
+    MessageQ_RxRing *   ring;
 
     GT_2trace (curTrace, GT_ENTER, "MessageQ_get", handle, timeout);
 
@@ -787,6 +853,17 @@ MessageQ_get (MessageQ_Handle handle, MessageQ_Msg * msg ,UInt timeout)
     }
     else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        /* Take the next message straight off the receive ring, unless
+         * the kernel holds messages that must be returned first.
+         */
+        ring = ((MessageQ_Object *)(handle))->rxRing;
+        if (   (ring != NULL)
+            && ((*msg = _MessageQ_ringGet (ring)) != NULL)) {
+            GT_1trace (curTrace, GT_LEAVE, "MessageQ_get", status);
+
+            return (status);
+        }
+
         cmdArgs.args.get.handle = ((MessageQ_Object *)(handle))->knlObject;
         GT_assert (curTrace,
                    (((MessageQ_Object *)(handle))->knlObject != NULL));
@@ -944,6 +1021,8 @@ MessageQ_alloc (UInt16 heapId, UInt32 size)
     SharedRegion_SRPtr  msgSrPtr = SharedRegion_INVALIDSRPTR;
     MessageQ_Msg        msg      = NULL;
     MessageQDrv_CmdArgs cmdArgs;
+    IArg                key;
+    UInt32              i;
 
     GT_2trace (curTrace, GT_ENTER, "MessageQ_alloc", heapId, size);
 
@@ -957,6 +1036,36 @@ MessageQ_alloc (UInt16 heapId, UInt32 size)
     }
     else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        /* Reuse a message this process freed earlier, if one fits. */
+        if (MessageQ_module->cacheLock != NULL) {
+            key = IGateProvider_enter (MessageQ_module->cacheLock);
+            for (i = MessageQ_module->numCached; i > 0; i--) {
+                if (   (MessageQ_module->cached [i - 1]->heapId  == heapId)
+                    && (MessageQ_module->cached [i - 1]->msgSize == size)) {
+                    msg = MessageQ_module->cached [i - 1];
+                    MessageQ_module->numCached--;
+                    MessageQ_module->cached [i - 1] =
+                      MessageQ_module->cached [MessageQ_module->numCached];
+                    break;
+                }
+            }
+            IGateProvider_leave (MessageQ_module->cacheLock, key);
+        }
+
+        if (msg != NULL) {
+            /* Same header as a fresh message, see MessageQ_staticMsgInit. */
+            msg->replyId = (UInt16) MessageQ_INVALIDMESSAGEQ;
+            msg->msgId   = MessageQ_INVALIDMSGID;
+            msg->dstId   = (UInt16) MessageQ_INVALIDMESSAGEQ;
+            msg->flags   =   MessageQ_HEADERVERSION
+                           | MessageQ_NORMALPRI;
+            msg->srcProc = MultiProc_self ();
+
+            GT_1trace (curTrace, GT_LEAVE, "MessageQ_alloc", msg);
+
+            return msg;
+        }
+
         cmdArgs.args.alloc.heapId = heapId;
         cmdArgs.args.alloc.size   = size;
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
@@ -994,6 +1103,8 @@ MessageQ_free (MessageQ_Msg msg)
     UInt32              status = MessageQ_S_SUCCESS;
     MessageQDrv_CmdArgs cmdArgs;
     UInt16              index;
+    IArg                key;
+    Bool                cached = FALSE;
 
     GT_1trace (curTrace, GT_ENTER, "MessageQ_free", msg);
 
@@ -1026,17 +1137,32 @@ MessageQ_free (MessageQ_Msg msg)
     }
     else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
-        index = SharedRegion_getId (msg);
-        cmdArgs.args.free.msgSrPtr = SharedRegion_getSRPtr (msg, index);
-        status = MessageQDrv_ioctl (CMD_MESSAGEQ_FREE, &cmdArgs);
+        /* Keep the message for the next MessageQ_alloc of this process. */
+        if (   (MessageQ_module->cacheLock != NULL)
+            && (msg->heapId != MessageQ_STATICMSG)) {
+            key = IGateProvider_enter (MessageQ_module->cacheLock);
+            if (MessageQ_module->numCached < MessageQ_FREECACHE_SIZE) {
+                MessageQ_module->cached [MessageQ_module->numCached++] = msg;
+                cached = TRUE;
+            }
+            IGateProvider_leave (MessageQ_module->cacheLock, key);
+        }
+
+        if (cached == FALSE) {
+            index = SharedRegion_getId (msg);
+            cmdArgs.args.free.msgSrPtr = SharedRegion_getSRPtr (msg, index);
+            status = MessageQDrv_ioctl (CMD_MESSAGEQ_FREE, &cmdArgs);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
-        if (status < 0) {
-            GT_setFailureReason (curTrace,
-                                 GT_4CLASS,
-                                 "MessageQ_free",
-                                 status,
-                                 "API (through IOCTL) failed on kernel-side!");
+            if (status < 0) {
+                GT_setFailureReason (curTrace,
+                                   GT_4CLASS,
+                                   "MessageQ_free",
+                                   status,
+                                   "API (through IOCTL) failed on kernel-side!");
+            }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
         }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
     }
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
 
@@ -1119,6 +1245,11 @@ MessageQ_unregisterHeap (UInt16 heapId)
     }
     else {
 #endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        /* Cached messages may come from the heap going away. */
+        if (MessageQ_module->cacheLock != NULL) {
+            _MessageQ_flushCache ();
+        }
+
         cmdArgs.args.unregisterHeap.heapId = heapId;
         status = MessageQDrv_ioctl (CMD_MESSAGEQ_UNREGISTERHEAP, &cmdArgs);
 #if !defined(SYSLINK_BUILD_OPTIMIZE)
@@ -1407,3 +1538,249 @@ MessageQ_detach (UInt16 remoteProcId)
 
     return (status);
 }
+
+
+/* Place messages onto a queue, raising one notification where possible. */
+Int
+MessageQ_putBatch (MessageQ_QueueId   queueId,
+                   MessageQ_Msg     * msgs,
+                   UInt               count,
+                   UInt             * numPut)
+{
+    Int                 status = MessageQ_S_SUCCESS;
+    SharedRegion_SRPtr  msgSrPtrs [MessageQ_BATCH_MAX];
+    MessageQDrv_CmdArgs cmdArgs;
+    UInt16              index;
+    UInt                n;
+    UInt                i;
+
+    GT_4trace (curTrace, GT_ENTER, "MessageQ_putBatch",
+               queueId, msgs, count, numPut);
+
+    GT_assert (curTrace, (queueId != MessageQ_INVALIDMESSAGEQ));
+    GT_assert (curTrace, (msgs != NULL));
+    GT_assert (curTrace, (numPut != NULL));
+
+    *numPut = 0u;
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (MessageQ_module->setupRefCount == 0) {
+        status = MessageQ_E_INVALIDSTATE;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_putBatch",
+                             status,
+                             "Module is not initialized!");
+    }
+    else if ((msgs == NULL) || (count == 0u)) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_putBatch",
+                             status,
+                             "msgs is null or count is zero!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        /* Larger batches go down in chunks the kernel accepts. */
+        while ((*numPut < count) && (status >= 0)) {
+            n = count - *numPut;
+            if (n > MessageQ_BATCH_MAX) {
+                n = MessageQ_BATCH_MAX;
+            }
+
+            for (i = 0u; i < n; i++) {
+                index = SharedRegion_getId (msgs [*numPut + i]);
+                msgSrPtrs [i] = SharedRegion_getSRPtr (msgs [*numPut + i],
+                                                       index);
+            }
+
+            cmdArgs.args.putBatch.queueId   = queueId;
+            cmdArgs.args.putBatch.msgSrPtrs = msgSrPtrs;
+            cmdArgs.args.putBatch.count     = n;
+            cmdArgs.args.putBatch.numPut    = 0u;
+
+            status = MessageQDrv_ioctl (CMD_MESSAGEQ_PUTBATCH, &cmdArgs);
+            *numPut += cmdArgs.args.putBatch.numPut;
+        }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+        if (status < 0) {
+            GT_setFailureReason (curTrace,
+                                 GT_4CLASS,
+                                 "MessageQ_putBatch",
+                                 status,
+                                 "API (through IOCTL) failed on kernel-side!");
+        }
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQ_putBatch", status);
+
+    return (status);
+}
+
+
+/* Get up to max messages, waiting up to timeout for the first one only. */
+Int
+MessageQ_getBatch (MessageQ_Handle    handle,
+                   MessageQ_Msg     * msgs,
+                   UInt               max,
+                   UInt               timeout,
+                   UInt             * numGot)
+{
+    Int                 status = MessageQ_S_SUCCESS;
+    SharedRegion_SRPtr  msgSrPtrs [MessageQ_BATCH_MAX];
+    MessageQDrv_CmdArgs cmdArgs;
+    MessageQ_RxRing *   ring;
+    UInt                i;
+
+    GT_5trace (curTrace, GT_ENTER, "MessageQ_getBatch",
+               handle, msgs, max, timeout, numGot);
+
+    GT_assert (curTrace, (handle != NULL));
+    GT_assert (curTrace, (msgs != NULL));
+    GT_assert (curTrace, (numGot != NULL));
+
+    *numGot = 0u;
+
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    if (MessageQ_module->setupRefCount == 0) {
+        status = MessageQ_E_INVALIDSTATE;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_getBatch",
+                             status,
+                             "Module is not initialized!");
+    }
+    else if ((handle == NULL) || (msgs == NULL) || (max == 0u)) {
+        status = MessageQ_E_INVALIDARG;
+        GT_setFailureReason (curTrace,
+                             GT_4CLASS,
+                             "MessageQ_getBatch",
+                             status,
+                             "handle or msgs is null, or max is zero!");
+    }
+    else {
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+        if (max > MessageQ_BATCH_MAX) {
+            max = MessageQ_BATCH_MAX;
+        }
+
+        /* Drain the receive ring first, it needs no system call. */
+        ring = ((MessageQ_Object *)(handle))->rxRing;
+        if (ring != NULL) {
+            while (   (*numGot < max)
+                   && ((msgs [*numGot] = _MessageQ_ringGet (ring)) != NULL)) {
+                (*numGot)++;
+            }
+        }
+
+        if (*numGot == 0u) {
+            cmdArgs.args.getBatch.handle =
+                                    ((MessageQ_Object *)(handle))->knlObject;
+            GT_assert (curTrace,
+                       (((MessageQ_Object *)(handle))->knlObject != NULL));
+            cmdArgs.args.getBatch.timeout   = timeout;
+            cmdArgs.args.getBatch.msgSrPtrs = msgSrPtrs;
+            cmdArgs.args.getBatch.max       = max;
+            cmdArgs.args.getBatch.numGot    = 0u;
+
+            status = MessageQDrv_ioctl (CMD_MESSAGEQ_GETBATCH, &cmdArgs);
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+            if (    (status < 0)
+                &&  (status != MessageQ_E_TIMEOUT)
+                &&  (status != MessageQ_E_UNBLOCKED)) {
+                /* Timeout and unblock are valid runtime errors. */
+                GT_setFailureReason (curTrace,
+                                     GT_4CLASS,
+                                     "MessageQ_getBatch",
+                                     status,
+                                    "API (through IOCTL) failed on kernel-side!");
+            }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+            for (i = 0u; i < cmdArgs.args.getBatch.numGot; i++) {
+                msgs [i] = (MessageQ_Msg) SharedRegion_getPtr (msgSrPtrs [i]);
+            }
+            *numGot = cmdArgs.args.getBatch.numGot;
+        }
+#if !defined(SYSLINK_BUILD_OPTIMIZE)
+    }
+#endif /* if !defined(SYSLINK_BUILD_OPTIMIZE) */
+
+    GT_1trace (curTrace, GT_LEAVE, "MessageQ_getBatch", status);
+
+    return (status);
+}
+
+
+/* Returns the remote send counters. */
+Void
+MessageQ_getStats (MessageQ_Stats * stats)
+{
+    MessageQDrv_CmdArgs cmdArgs;
+
+    GT_1trace (curTrace, GT_ENTER, "MessageQ_getStats", stats);
+
+    GT_assert (curTrace, (stats != NULL));
+
+    cmdArgs.args.getStats.stats = stats;
+    MessageQDrv_ioctl (CMD_MESSAGEQ_GETSTATS, &cmdArgs);
+
+    GT_0trace (curTrace, GT_LEAVE, "MessageQ_getStats");
+}
+
+
+/* =============================================================================
+ * Internal functions
+ * =============================================================================
+ */
+/*
+ *  ======== _MessageQ_ringGet ========
+ *  Returns the next message of the receive ring, or NULL when it is empty
+ *  or when the kernel holds messages that must be returned first.
+ */
+static inline MessageQ_Msg
+_MessageQ_ringGet (MessageQ_RxRing * ring)
+{
+    MessageQ_Msg    msg = NULL;
+    UInt32          head;
+
+    if ((ring->listPut == ring->listGot) && (ring->head != ring->tail)) {
+        MessageQ_rxRingBarrier ();
+        head = ring->head;
+        msg = (MessageQ_Msg) SharedRegion_getPtr (
+                                    ring->slot [head % MessageQ_RXRING_SLOTS]);
+        MessageQ_rxRingBarrier ();
+        ring->head = head + 1;
+    }
+
+    return (msg);
+}
+
+/*
+ *  ======== _MessageQ_flushCache ========
+ *  Frees the messages held in the free message cache, so that nothing this
+ *  process allocated is left out of the heaps when it leaves MessageQ.
+ */
+static Void
+_MessageQ_flushCache (Void)
+{
+    MessageQDrv_CmdArgs cmdArgs;
+    MessageQ_Msg        msg;
+    UInt16              index;
+    IArg                key;
+
+    GT_0trace (curTrace, GT_ENTER, "_MessageQ_flushCache");
+
+    key = IGateProvider_enter (MessageQ_module->cacheLock);
+    while (MessageQ_module->numCached > 0) {
+        msg = MessageQ_module->cached [--MessageQ_module->numCached];
+        index = SharedRegion_getId (msg);
+        cmdArgs.args.free.msgSrPtr = SharedRegion_getSRPtr (msg, index);
+        MessageQDrv_ioctl (CMD_MESSAGEQ_FREE, &cmdArgs);
+    }
+    IGateProvider_leave (MessageQ_module->cacheLock, key);
+
+    GT_0trace (curTrace, GT_LEAVE, "_MessageQ_flushCache");
+}
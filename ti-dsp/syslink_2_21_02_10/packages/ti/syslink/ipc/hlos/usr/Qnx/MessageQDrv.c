@@ -333,3 +333,35 @@ MessageQDrv_ioctl (UInt32 cmd, Ptr args)
 
     return status;
 }
+
+
+/*!
+ *  @brief  Function to map the receive ring of a local queue.
+ *
+ *          Receive rings are not provided on QNX, queues are always read
+ *          through devctl.
+ *
+ *  @param  queueIndex  Index of the queue, the low half of its queueId
+ *  @param  size        Size of the ring, one page
+ *
+ *  @sa     MessageQDrv_unmap
+ */
+Ptr
+MessageQDrv_map (UInt16 queueIndex, UInt32 size)
+{
+    return NULL;
+}
+
+
+/*!
+ *  @brief  Function to unmap a receive ring.
+ *
+ *  @param  addr    Address returned by MessageQDrv_map
+ *  @param  size    Size passed to MessageQDrv_map
+ *
+ *  @sa     MessageQDrv_map
+ */
+Void
+MessageQDrv_unmap (Ptr addr, UInt32 size)
+{
+}
@@ -406,6 +406,35 @@ NotifyDrvUsr_ioctl (UInt32 cmd, Ptr args)
 }
 
 
+/*!
+ *  @brief  Function to get the descriptor to poll for events of this process.
+ *
+ *          Not supported on QNX, events are delivered by the Notify thread.
+ *
+ *  @sa     NotifyDrvUsr_dispatchEvents
+ */
+Int
+NotifyDrvUsr_getFd (Void)
+{
+    return -1;
+}
+
+
+/*!
+ *  @brief  Function to run the callbacks of all pending events of this
+ *          process.
+ *
+ *          Not supported on QNX, events are delivered by the Notify thread.
+ *
+ *  @sa     NotifyDrvUsr_getFd
+ */
+Int
+NotifyDrvUsr_dispatchEvents (Void)
+{
+    return 0;
+}
+
+
 /** ============================================================================
  *  Internal functions
  *  ============================================================================
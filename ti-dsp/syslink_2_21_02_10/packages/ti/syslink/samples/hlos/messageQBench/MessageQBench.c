@@ -0,0 +1,308 @@
+/*
+ *  @file   MessageQBench.c
+ *
+ *  @brief      Measures MessageQ throughput to a remote echo queue, sending
+ *              one message per put and in batches.
+ *
+ *
+ *  ============================================================================
+ *
+ *  Copyright (c) 2008-2012, Texas Instruments Incorporated
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *  
+ *  *  Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  *  Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  *  Neither the name of Texas Instruments Incorporated nor the names of
+ *     its contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ *  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ *  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ *  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *  WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *  OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *  EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *  Contact information for paper mail:
+ *  Texas Instruments
+ *  Post Office Box 655303
+ *  Dallas, Texas 75265
+ *  Contact information: 
+ *  http://www-k.ext.ti.com/sc/technical-support/product-information-centers.htm?
+ *  DCMP=TIHomeTracking&HQS=Other+OT+home_d_contact
+ *  ============================================================================
+ *  
+ */
+
+
+/* OS-specific headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+/* Standard headers */
+#include <ti/syslink/Std.h>
+
+/* OSAL & Utils headers */
+#include <ti/syslink/utils/Trace.h>
+#include <ti/syslink/utils/OsalPrint.h>
+#include <ti/syslink/SysLink.h>
+#include <ti/ipc/MultiProc.h>
+#include <ti/ipc/HeapBufMP.h>
+#include <ti/ipc/MessageQ.h>
+#include <ti/syslink/inc/_MessageQ.h>
+
+/* Sample app headers */
+#include <ti/syslink/samples/hlos/common/SysLinkSamples.h>
+
+
+/** ============================================================================
+ *  Macros
+ *  ============================================================================
+ */
+/* Heap id the echo heap is registered with in this process */
+#define MessageQBench_HEAPID        0u
+
+/* Name of the queue the remote processor echoes the messages to */
+#define MessageQBench_LOCALQUEUE    "MessageQBench"
+
+
+/** ============================================================================
+ *  Function declarations
+ *  ============================================================================
+ */
+static Void MessageQBench_printUsageInfo (Void);
+static Int  MessageQBench_run (MessageQ_Handle  localQ,
+                               MessageQ_QueueId remoteQ,
+                               UInt32           msgSize,
+                               UInt             numMsgs,
+                               UInt             batch);
+
+
+/** ============================================================================
+ *  Functions
+ *  ============================================================================
+ */
+int
+main (int argc, char ** argv)
+{
+    Int              status = 0;
+    HeapBufMP_Handle heap   = NULL;
+    MessageQ_Handle  localQ = NULL;
+    MessageQ_QueueId remoteQ;
+    UInt32           msgSize;
+    UInt             numMsgs;
+    UInt             batch;
+
+    if (argc != 6) {
+        MessageQBench_printUsageInfo ();
+        return (-1);
+    }
+
+    msgSize = (UInt32) strtoul (argv [3], NULL, 0);
+    numMsgs = (UInt) strtoul (argv [4], NULL, 0);
+    batch   = (UInt) strtoul (argv [5], NULL, 0);
+    if ((numMsgs == 0u) || (batch == 0u) || (batch > MessageQ_BATCH_MAX)) {
+        MessageQBench_printUsageInfo ();
+        return (-1);
+    }
+
+    SysLink_setup ();
+
+    /* Execute common startup functionality for all sample applications */
+    SysLinkSamples_startup ();
+
+    status = HeapBufMP_open (argv [1], &heap);
+    if (status < 0) {
+        Osal_printf ("HeapBufMP_open (%s) failed: %d\n", argv [1], status);
+    }
+    else {
+        status = MessageQ_registerHeap ((Ptr) heap, MessageQBench_HEAPID);
+    }
+
+    if (status >= 0) {
+        localQ = MessageQ_create (MessageQBench_LOCALQUEUE, NULL);
+        if (localQ == NULL) {
+            Osal_printf ("MessageQ_create failed\n");
+            status = -1;
+        }
+    }
+
+    if (status >= 0) {
+        do {
+            status = MessageQ_open (argv [2], &remoteQ);
+        } while (status == MessageQ_E_NOTFOUND);
+
+        if (status < 0) {
+            Osal_printf ("MessageQ_open (%s) failed: %d\n", argv [2], status);
+        }
+    }
+
+    if (status >= 0) {
+        Osal_printf ("%u messages of %u bytes to %s\n",
+                     numMsgs, msgSize, argv [2]);
+        status = MessageQBench_run (localQ, remoteQ, msgSize, numMsgs, 1u);
+        if ((status >= 0) && (batch > 1u)) {
+            status = MessageQBench_run (localQ, remoteQ, msgSize, numMsgs,
+                                        batch);
+        }
+        MessageQ_close (&remoteQ);
+    }
+
+    if (localQ != NULL) {
+        MessageQ_delete (&localQ);
+    }
+
+    if (heap != NULL) {
+        MessageQ_unregisterHeap (MessageQBench_HEAPID);
+        HeapBufMP_close (&heap);
+    }
+
+    SysLinkSamples_shutdown ();
+
+    SysLink_destroy ();
+
+    return (status);
+}
+
+
+/*!
+ *  @brief  Sends numMsgs messages to remoteQ, batch at a time, and waits for
+ *          each batch to be echoed back before sending the next one.
+ */
+static
+Int
+MessageQBench_run (MessageQ_Handle  localQ,
+                   MessageQ_QueueId remoteQ,
+                   UInt32           msgSize,
+                   UInt             numMsgs,
+                   UInt             batch)
+{
+    Int             status = MessageQ_S_SUCCESS;
+    MessageQ_Msg    msgs [MessageQ_BATCH_MAX];
+    MessageQ_Stats  before;
+    MessageQ_Stats  after;
+    struct timeval  start;
+    struct timeval  end;
+    UInt            sent   = 0u;
+    UInt            n;
+    UInt            got;
+    UInt            num;
+    UInt            i;
+    UInt32          usecs;
+    UInt32          msgsSent;
+    UInt32          doorbells;
+
+    MessageQ_getStats (&before);
+    gettimeofday (&start, NULL);
+
+    while ((sent < numMsgs) && (status >= 0)) {
+        n = numMsgs - sent;
+        if (n > batch) {
+            n = batch;
+        }
+
+        for (i = 0u; i < n; i++) {
+            msgs [i] = MessageQ_alloc (MessageQBench_HEAPID, msgSize);
+            if (msgs [i] == NULL) {
+                Osal_printf ("MessageQ_alloc failed\n");
+                while (i > 0u) {
+                    MessageQ_free (msgs [--i]);
+                }
+                return (-1);
+            }
+            MessageQ_setReplyQueue (localQ, msgs [i]);
+        }
+
+        if (batch == 1u) {
+            status = MessageQ_put (remoteQ, msgs [0]);
+            num = (status >= 0) ? 1u : 0u;
+        }
+        else {
+            status = MessageQ_putBatch (remoteQ, msgs, n, &num);
+        }
+
+        /* Messages the transport did not take are still ours. */
+        for (i = num; i < n; i++) {
+            MessageQ_free (msgs [i]);
+        }
+
+        for (got = 0u; (got < num) && (status >= 0); got += i) {
+            if (batch == 1u) {
+                status = MessageQ_get (localQ, &msgs [0], MessageQ_FOREVER);
+                i = (status >= 0) ? 1u : 0u;
+            }
+            else {
+                status = MessageQ_getBatch (localQ, msgs, num - got,
+                                            MessageQ_FOREVER, &i);
+            }
+
+            for (n = 0u; n < i; n++) {
+                MessageQ_free (msgs [n]);
+            }
+        }
+
+        sent += num;
+    }
+
+    gettimeofday (&end, NULL);
+    MessageQ_getStats (&after);
+
+    if (status < 0) {
+        Osal_printf ("Batch of %u failed after %u messages: %d\n",
+                     batch, sent, status);
+    }
+    else {
+        usecs = (UInt32) (  ((end.tv_sec - start.tv_sec) * 1000000)
+                          + (end.tv_usec - start.tv_usec));
+        if (usecs == 0u) {
+            usecs = 1u;
+        }
+        /* The counters are system wide, other senders show up in them. */
+        msgsSent  = after.msgsSent - before.msgsSent;
+        doorbells = after.doorbells - before.doorbells;
+        if (msgsSent == 0u) {
+            msgsSent = 1u;
+        }
+        Osal_printf ("batch %2u: %u msgs/sec, %u.%02u doorbells/msg\n",
+                     batch,
+                     (UInt32) (((unsigned long long) sent * 1000000) / usecs),
+                     doorbells / msgsSent,
+                     ((doorbells * 100u) / msgsSent) % 100u);
+    }
+
+    return (status);
+}
+
+
+/*!
+ *  @brief  Prints the usage information of the benchmark.
+ */
+static
+Void
+MessageQBench_printUsageInfo (Void)
+{
+    Osal_printf ("\nUsage:\n");
+    Osal_printf ("    messageqbench.exe <Heap name> <Remote queue name> "
+                 "<Message size> <Number of messages> <Batch size>\n");
+    Osal_printf ("\nThe remote processor must already be running and echo\n");
+    Osal_printf ("every message it receives on <Remote queue name> to its\n");
+    Osal_printf ("reply queue.  Messages are allocated from the HeapBufMP\n");
+    Osal_printf ("<Heap name>.  The run is done once with one message per\n");
+    Osal_printf ("put and once with <Batch size> (at most %u) messages per\n",
+                 MessageQ_BATCH_MAX);
+    Osal_printf ("MessageQ_putBatch.\n\n");
+}
@@ -125,6 +125,24 @@ ResTrack_Handle ResTrack_create(ResTrack_Params *params);
  */
 Void ResTrack_delete(ResTrack_Handle *handlePtr);
 
+/*!
+ *  @brief      Look for a resource object without removing it
+ *
+ *  @param      handle  Resource tracker instance handle
+ *  @param      pid     Process id
+ *  @param      ref     Reference resource object
+ *  @param      cmpFxn  Compare function
+ *
+ *  @retval     ResTrack_S_SUCCESS      The process owns a matching resource
+ *  @retval     ResTrack_E_PID          No process object for given id
+ *  @retval     ResTrack_E_NOTFOUND     No resource found which matches
+ *                                      the reference resource
+ *
+ *  @sa         ResTrack_remove
+ */
+Int ResTrack_find(ResTrack_Handle handle, Osal_Pid pid, List_Elem *ref,
+        ResTrack_Fxn cmpFxn);
+
 /*!
  *  @brief      Get first element from the resource list.
  *
@@ -141,6 +141,58 @@ Void ResTrack_delete(ResTrack_Handle *handlePtr)
     }
 }
 
+/*
+ *  ======== ResTrack_find ========
+ */
+Int ResTrack_find(ResTrack_Handle handle, Osal_Pid pid, List_Elem *ref,
+        ResTrack_Fxn cmpFxn)
+{
+    Int status;
+    ResTrack_Object *obj;
+    List_Elem *elem;
+    ResTrack_Proc *proc;
+    IGateProvider_Handle gate;
+    IArg key;
+
+    /* setup local context */
+    obj = (ResTrack_Object *)handle;
+    gate = (IGateProvider_Handle)(obj->gate);
+
+    /* enter gate */
+    key = IGateProvider_enter(gate);
+
+    /* search process list for the given pid */
+    elem = NULL;
+    while ((elem = List_next(obj->procList, elem)) != NULL) {
+        proc = (ResTrack_Proc *)elem;
+        if (proc->pid == pid) {
+            break; /* found it */
+        }
+    }
+
+    /* leave if process object was not found */
+    if (elem == NULL) {
+        status = ResTrack_E_PID;
+        goto leave;
+    }
+
+    /* search resource list for given resource, leave it in place */
+    status = ResTrack_E_NOTFOUND;
+    elem = NULL;
+    while ((elem = List_next(proc->resList, elem)) != NULL) {
+        if ((*cmpFxn)((Void *)ref, (Void *)elem)) {
+            status = ResTrack_S_SUCCESS;
+            break;
+        }
+    }
+
+leave:
+    /* leave gate */
+    IGateProvider_leave(gate, key);
+
+    return(status);
+}
+
 /*
  *  ======== ResTrack_pop ========
  */